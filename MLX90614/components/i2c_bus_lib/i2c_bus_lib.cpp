@@ -0,0 +1,361 @@
+#include "i2c_bus_lib.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+static const char *TAG = "I2C_BUS";
+
+enum I2COp {
+    I2C_OP_WRITE,
+    I2C_OP_WRITE_REG,
+    I2C_OP_READ,
+    I2C_OP_WRITE_READ,
+};
+
+struct I2CBusEntry;
+
+// One transaction. It lives on the submitting task's stack until done is given.
+struct I2CTransaction {
+    i2c_master_dev_handle_t handle;
+    I2CBusEntry *bus;
+    I2COp op;
+    const uint8_t *out;
+    size_t out_len;
+    uint8_t reg;
+    uint8_t *in;
+    size_t in_len;
+    int timeout_ms;
+    esp_err_t result;
+    bool recovered;             // the bus was reset after this transaction timed out
+    int64_t queued_us;
+    int64_t start_us;
+    int64_t end_us;
+    SemaphoreHandle_t done;
+};
+
+// Owner task of a bus and its per-priority transaction queues.
+struct I2CArbiter {
+    I2CArbiterQueue<I2CTransaction *, I2C_ARBITER_QUEUE_LEN> queue;
+    portMUX_TYPE lock;                      // guards queue
+    SemaphoreHandle_t space[I2C_PRIO_COUNT]; // free slots per level; submitters wait on it
+    SemaphoreHandle_t pending;  // one count per queued transaction, plus one to stop
+    SemaphoreHandle_t stopped;
+    TaskHandle_t task;
+};
+
+// Buses created by I2CBus::acquire(), per I2C port.
+struct I2CBusEntry {
+    int users;
+    i2c_master_bus_handle_t handle;
+    int sda_io;
+    int scl_io;
+    I2CArbiter *volatile arbiter;
+    uint32_t recoveries;
+};
+
+static I2CBusEntry buses[I2C_NUM_MAX];
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static esp_err_t recover_bus(i2c_port_t port, I2CBusEntry &bus) {
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = i2c_master_bus_reset(bus.handle);
+    bus.recoveries++;
+    ESP_LOGW(TAG, "Port %d recovered in %lld us: %s", (int)port, esp_timer_get_time() - start, esp_err_to_name(err));
+    return err;
+}
+
+static esp_err_t transfer(I2CTransaction &t) {
+    switch (t.op) {
+    case I2C_OP_WRITE:
+        return i2c_master_transmit(t.handle, t.out, t.out_len, t.timeout_ms);
+    case I2C_OP_WRITE_REG: {
+        i2c_master_transmit_multi_buffer_info_t parts[2] = {
+            { &t.reg, 1 },
+            { const_cast<uint8_t *>(t.out), t.out_len },
+        };
+        return i2c_master_multi_buffer_transmit(t.handle, parts, t.out_len > 0 ? 2 : 1, t.timeout_ms);
+    }
+    case I2C_OP_READ:
+        return i2c_master_receive(t.handle, t.in, t.in_len, t.timeout_ms);
+    case I2C_OP_WRITE_READ:
+        return i2c_master_transmit_receive(t.handle, t.out, t.out_len, t.in, t.in_len, t.timeout_ms);
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+// A timed-out transaction can leave a slave driving SDA and the controller
+// mid-frame; reset both so the next device's transaction starts clean.
+static esp_err_t run_transaction(I2CTransaction &t) {
+    esp_err_t err = transfer(t);
+    if (err == ESP_ERR_TIMEOUT) {
+        recover_bus((i2c_port_t)(t.bus - buses), *t.bus);
+        t.recovered = true;
+    }
+    return err;
+}
+
+// Takes the highest-priority queued transaction, runs it and wakes its submitter.
+static void arbiter_task(void *arg) {
+    I2CArbiter &arbiter = *static_cast<I2CArbiter *>(arg);
+    for (;;) {
+        xSemaphoreTake(arbiter.pending, portMAX_DELAY);
+        I2CTransaction *t = nullptr;
+        I2CPriority prio = I2C_PRIO_NORMAL;
+        taskENTER_CRITICAL(&arbiter.lock);
+        bool queued = arbiter.queue.pop(t, &prio);
+        taskEXIT_CRITICAL(&arbiter.lock);
+        if (!queued) break; // the stop count, given after the last transaction
+        xSemaphoreGive(arbiter.space[prio]);
+        t->start_us = esp_timer_get_time();
+        t->result = run_transaction(*t);
+        t->end_us = esp_timer_get_time();
+        xSemaphoreGive(t->done);
+    }
+    xSemaphoreGive(arbiter.stopped);
+    vTaskDelete(NULL);
+}
+
+static void delete_arbiter(I2CArbiter *arbiter) {
+    for (int prio = 0; prio < I2C_PRIO_COUNT; prio++) {
+        if (arbiter->space[prio]) vSemaphoreDelete(arbiter->space[prio]);
+    }
+    if (arbiter->pending) vSemaphoreDelete(arbiter->pending);
+    if (arbiter->stopped) vSemaphoreDelete(arbiter->stopped);
+    delete arbiter;
+}
+
+esp_err_t I2CBus::acquire(const I2CBusConfig &config, i2c_master_bus_handle_t *out_handle) {
+    if (config.port < 0 || config.port >= I2C_NUM_MAX || out_handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    I2CBusEntry &bus = buses[config.port];
+    if (bus.users > 0) {
+        if (bus.sda_io != config.sda_io || bus.scl_io != config.scl_io) {
+            ESP_LOGW(TAG, "Port %d already runs on SDA %d / SCL %d; ignoring SDA %d / SCL %d", (int)config.port,
+                     bus.sda_io, bus.scl_io, config.sda_io, config.scl_io);
+        }
+        bus.users++;
+        *out_handle = bus.handle;
+        return ESP_OK;
+    }
+
+    i2c_master_bus_config_t bus_conf = {};
+    bus_conf.i2c_port = config.port;
+    bus_conf.sda_io_num = (gpio_num_t)config.sda_io;
+    bus_conf.scl_io_num = (gpio_num_t)config.scl_io;
+    bus_conf.clk_source = I2C_CLK_SRC_DEFAULT;
+    bus_conf.glitch_ignore_cnt = 7;
+    bus_conf.flags.enable_internal_pullup = config.internal_pullup;
+    esp_err_t err = i2c_new_master_bus(&bus_conf, &bus.handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "i2c_new_master_bus on port %d failed: %s", (int)config.port, esp_err_to_name(err));
+        bus.handle = nullptr;
+        return err;
+    }
+    bus.sda_io = config.sda_io;
+    bus.scl_io = config.scl_io;
+    bus.users = 1;
+    bus.recoveries = 0;
+    *out_handle = bus.handle;
+    return ESP_OK;
+}
+
+void I2CBus::release(i2c_port_t port) {
+    if (port < 0 || port >= I2C_NUM_MAX) return;
+    I2CBusEntry &bus = buses[port];
+    if (bus.users == 0 || --bus.users > 0) return;
+    stop_arbiter(port);
+    i2c_del_master_bus(bus.handle);
+    bus.handle = nullptr;
+}
+
+esp_err_t I2CBus::start_arbiter(i2c_port_t port, UBaseType_t task_priority) {
+    if (port < 0 || port >= I2C_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    I2CBusEntry &bus = buses[port];
+    if (bus.users == 0) return ESP_ERR_INVALID_STATE;
+    if (bus.arbiter != nullptr) return ESP_OK;
+
+    I2CArbiter *arbiter = new I2CArbiter();
+    portMUX_INITIALIZE(&arbiter->lock);
+    bool ok = true;
+    for (int prio = 0; prio < I2C_PRIO_COUNT; prio++) {
+        arbiter->space[prio] = xSemaphoreCreateCounting(I2C_ARBITER_QUEUE_LEN, I2C_ARBITER_QUEUE_LEN);
+        ok = ok && arbiter->space[prio] != nullptr;
+    }
+    arbiter->pending = xSemaphoreCreateCounting(I2C_PRIO_COUNT * I2C_ARBITER_QUEUE_LEN + 1, 0);
+    arbiter->stopped = xSemaphoreCreateBinary();
+    ok = ok && arbiter->pending != nullptr && arbiter->stopped != nullptr;
+    if (ok && xTaskCreate(arbiter_task, "i2c_arbiter", 3072, arbiter, task_priority, &arbiter->task) != pdPASS) {
+        ok = false;
+    }
+    if (!ok) {
+        ESP_LOGE(TAG, "Failed to start the arbiter on port %d", (int)port);
+        delete_arbiter(arbiter);
+        return ESP_ERR_NO_MEM;
+    }
+    bus.arbiter = arbiter;
+    return ESP_OK;
+}
+
+esp_err_t I2CBus::recover(i2c_port_t port) {
+    if (port < 0 || port >= I2C_NUM_MAX || buses[port].users == 0) return ESP_ERR_INVALID_STATE;
+    return recover_bus(port, buses[port]);
+}
+
+uint32_t I2CBus::recoveries(i2c_port_t port) {
+    if (port < 0 || port >= I2C_NUM_MAX) return 0;
+    return buses[port].recoveries;
+}
+
+void I2CBus::stop_arbiter(i2c_port_t port) {
+    if (port < 0 || port >= I2C_NUM_MAX) return;
+    I2CArbiter *arbiter = buses[port].arbiter;
+    if (arbiter == nullptr) return;
+    // New transactions go straight to the driver; queued ones finish first.
+    buses[port].arbiter = nullptr;
+    xSemaphoreGive(arbiter->pending);
+    xSemaphoreTake(arbiter->stopped, portMAX_DELAY);
+    delete_arbiter(arbiter);
+}
+
+I2CDevice::~I2CDevice() {
+    close();
+}
+
+esp_err_t I2CDevice::open(const I2CBusConfig &bus, uint8_t addr, uint32_t speed_hz) {
+    close();
+    i2c_master_bus_handle_t bus_handle;
+    esp_err_t err = I2CBus::acquire(bus, &bus_handle);
+    if (err != ESP_OK) return err;
+
+    i2c_device_config_t dev_conf = {};
+    dev_conf.dev_addr_length = I2C_ADDR_BIT_LEN_7;
+    dev_conf.device_address = addr;
+    dev_conf.scl_speed_hz = speed_hz;
+    err = i2c_master_bus_add_device(bus_handle, &dev_conf, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Adding device 0x%02x on port %d failed: %s", addr, (int)bus.port, esp_err_to_name(err));
+        handle = nullptr;
+        I2CBus::release(bus.port);
+        return err;
+    }
+    bus_port = bus.port;
+    dev_addr = addr;
+    scl_hz = speed_hz;
+    backoff = I2CBackoff();
+    return ESP_OK;
+}
+
+void I2CDevice::close() {
+    if (handle == nullptr) return;
+    i2c_master_bus_rm_device(handle);
+    handle = nullptr;
+    I2CBus::release(bus_port);
+}
+
+// Runs a transaction through the port's arbiter, or directly without one, and counts it.
+esp_err_t I2CDevice::execute(I2CTransaction &t) {
+    if (handle == nullptr) return ESP_ERR_INVALID_STATE;
+    t.handle = handle;
+    t.bus = &buses[bus_port];
+    if (t.timeout_ms == I2C_BUS_DEVICE_DEADLINE) {
+        t.timeout_ms = deadline_ms;
+    }
+    t.queued_us = esp_timer_get_time();
+    if (backoff.active(t.queued_us)) {
+        portENTER_CRITICAL(&stats_lock);
+        counters.skipped++;
+        portEXIT_CRITICAL(&stats_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    I2CArbiter *arbiter = buses[bus_port].arbiter;
+    if (arbiter == nullptr) {
+        t.start_us = t.queued_us;
+        t.result = run_transaction(t);
+        t.end_us = esp_timer_get_time();
+    } else {
+        StaticSemaphore_t done_buf;
+        t.done = xSemaphoreCreateBinaryStatic(&done_buf);
+        xSemaphoreTake(arbiter->space[priority], portMAX_DELAY);
+        taskENTER_CRITICAL(&arbiter->lock);
+        arbiter->queue.push(priority, &t);
+        taskEXIT_CRITICAL(&arbiter->lock);
+        xSemaphoreGive(arbiter->pending);
+        xSemaphoreTake(t.done, portMAX_DELAY);
+        vSemaphoreDelete(t.done);
+    }
+
+    if (t.result == ESP_ERR_TIMEOUT) {
+        backoff.timed_out(t.end_us, deadline_ms);
+    } else if (t.result == ESP_OK) {
+        backoff.succeeded();
+    }
+
+    uint32_t wait_us = (uint32_t)(t.start_us - t.queued_us);
+    uint32_t bus_us = (uint32_t)(t.end_us - t.start_us);
+    portENTER_CRITICAL(&stats_lock);
+    counters.transactions++;
+    counters.errors += t.result != ESP_OK;
+    counters.timeouts += t.result == ESP_ERR_TIMEOUT;
+    counters.recoveries += t.recovered;
+    counters.wait_us += wait_us;
+    counters.bus_us += bus_us;
+    if (wait_us > counters.max_wait_us) counters.max_wait_us = wait_us;
+    if (bus_us > counters.max_bus_us) counters.max_bus_us = bus_us;
+    portEXIT_CRITICAL(&stats_lock);
+    return t.result;
+}
+
+I2CDeviceStats I2CDevice::stats() const {
+    portENTER_CRITICAL(&stats_lock);
+    I2CDeviceStats copy = counters;
+    portEXIT_CRITICAL(&stats_lock);
+    return copy;
+}
+
+void I2CDevice::reset_stats() {
+    portENTER_CRITICAL(&stats_lock);
+    counters = {};
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+esp_err_t I2CDevice::write(const uint8_t *data, size_t len, int timeout_ms) {
+    I2CTransaction t = {};
+    t.op = I2C_OP_WRITE;
+    t.out = data;
+    t.out_len = len;
+    t.timeout_ms = timeout_ms;
+    return execute(t);
+}
+
+esp_err_t I2CDevice::write_reg(uint8_t reg, const uint8_t *data, size_t len, int timeout_ms) {
+    I2CTransaction t = {};
+    t.op = I2C_OP_WRITE_REG;
+    t.reg = reg;
+    t.out = data;
+    t.out_len = len;
+    t.timeout_ms = timeout_ms;
+    return execute(t);
+}
+
+esp_err_t I2CDevice::read(uint8_t *data, size_t len, int timeout_ms) {
+    I2CTransaction t = {};
+    t.op = I2C_OP_READ;
+    t.in = data;
+    t.in_len = len;
+    t.timeout_ms = timeout_ms;
+    return execute(t);
+}
+
+esp_err_t I2CDevice::write_read(const uint8_t *out, size_t out_len, uint8_t *in, size_t in_len, int timeout_ms) {
+    I2CTransaction t = {};
+    t.op = I2C_OP_WRITE_READ;
+    t.out = out;
+    t.out_len = out_len;
+    t.in = in;
+    t.in_len = in_len;
+    t.timeout_ms = timeout_ms;
+    return execute(t);
+}
@@ -2,8 +2,10 @@
 #define MLX90614_LIB_H
 
 #include <iostream>
-#include "driver/i2c.h"
+#include "i2c_bus_lib.h"
 #define MLX90614_I2C_ADDRESS 0x5A
+#define MLX90614_I2C_FREQ_HZ 100000 // SMBus maximum
+#define MLX90614_I2C_DEADLINE_MS 10 // a read word is 0.6 ms; SMBus slaves give up after 35 ms
 #define MLX90614_REG_TA 0x06
 #define MLX90614_REG_TOBJ1 0x07
 #define MLX90614_REG_TOBJ2 0x08
@@ -11,12 +13,16 @@
 class MLX90614 {
 public:
     MLX90614();
+    explicit MLX90614(const I2CBusConfig &bus);
     ~MLX90614();
     bool init();
     float readAmbientTempC();
     float readObjectTempC();
+    // Queue wait, bus time and errors of the sensor's I2C transactions
+    I2CDeviceStats busStats() const { return i2c.stats(); }
 private:
-    i2c_port_t i2c_master_port;
+    I2CBusConfig bus_config;
+    I2CDevice i2c;
     bool readRegister(uint8_t reg, uint16_t &value);
     float rawToCelsius(uint16_t raw);
 };
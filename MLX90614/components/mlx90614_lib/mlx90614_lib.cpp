@@ -1,47 +1,33 @@
 #include "mlx90614_lib.h"
-#include "driver/i2c.h"
 #include "esp_log.h"
 #include <cstring>
 
 static const char *TAG = "MLX90614";
 
 
-MLX90614::MLX90614() : i2c_master_port(I2C_NUM_0) {
+MLX90614::MLX90614() : MLX90614(I2CBusConfig()) {
+}
+
+MLX90614::MLX90614(const I2CBusConfig &bus) : bus_config(bus) {
     // Constructor implementation
-    // Do not install driver here; let init() handle it
+    // Do not touch the bus here; let init() handle it
 }
 
 
 MLX90614::~MLX90614() {
-    // Destructor implementation
-    i2c_driver_delete(i2c_master_port);
+    // Destructor implementation; the bus is deleted with its last device
+    i2c.close();
 }
 
 
 bool MLX90614::init() {
-    // Initialization code (minimal, assumes config done elsewhere)
-    i2c_config_t conf = {};
-    conf.mode = I2C_MODE_MASTER;
-    conf.sda_io_num = GPIO_NUM_21; // Set your SDA pin
-    conf.scl_io_num = GPIO_NUM_22; // Set your SCL pin
-    conf.sda_pullup_en = GPIO_PULLUP_ENABLE;
-    conf.scl_pullup_en = GPIO_PULLUP_ENABLE;
-    conf.master.clk_speed = 100000;
-    esp_err_t err = i2c_param_config(i2c_master_port, &conf);
+    // Join the shared bus at the SMBus clock; faster devices on it keep theirs
+    esp_err_t err = i2c.open(bus_config, MLX90614_I2C_ADDRESS, MLX90614_I2C_FREQ_HZ);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "i2c_param_config failed: %d", err);
+        ESP_LOGE(TAG, "I2C device open failed: %d", err);
         return false;
     }
-    // Only install if not already installed
-    static bool installed = false;
-    if (!installed) {
-        err = i2c_driver_install(i2c_master_port, I2C_MODE_MASTER, 0, 0, 0);
-        if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
-            ESP_LOGE(TAG, "i2c_driver_install failed: %d", err);
-            return false;
-        }
-        installed = true;
-    }
+    i2c.set_deadline_ms(MLX90614_I2C_DEADLINE_MS);
     return true;
 }
 
@@ -67,18 +53,9 @@ float MLX90614::readObjectTempC() {
 
 bool MLX90614::readRegister(uint8_t reg, uint16_t &value) {
     // Read a register from the sensor using repeated start
+    // LSB, MSB and PEC, after a repeated start
     uint8_t data[3] = {0};
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (MLX90614_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd, reg, true);
-    // Do NOT stop here, do repeated start
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (MLX90614_I2C_ADDRESS << 1) | I2C_MASTER_READ, true);
-    i2c_master_read(cmd, data, 3, I2C_MASTER_LAST_NACK);
-    i2c_master_stop(cmd);
-    esp_err_t ret = i2c_master_cmd_begin(i2c_master_port, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
+    esp_err_t ret = i2c.read_reg(reg, data, sizeof(data));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "I2C reg read failed: %d", ret);
         return false;
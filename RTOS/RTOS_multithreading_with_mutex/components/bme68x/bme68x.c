@@ -42,6 +42,12 @@
 /* This internal API is used to read the calibration coefficients */
 static int8_t get_calib_data(struct bme68x_dev *dev);
 
+/* This internal API is used to read the calibration coefficient registers */
+static int8_t read_calib_regs(uint8_t *coeff_array, struct bme68x_dev *dev);
+
+/* This internal API is used to parse the calibration coefficient registers */
+static void parse_calib_data(const uint8_t *coeff_array, struct bme68x_calib_data *calib);
+
 /* This internal API is used to read variant ID information register status */
 static int8_t read_variant_id(struct bme68x_dev *dev);
 
@@ -50,40 +56,50 @@ static uint8_t calc_gas_wait(uint16_t dur);
 
 #ifndef BME68X_USE_FPU
 
+/* This internal API is used to calculate the fine resolution temperature in integer */
+static int32_t calc_t_fine(uint32_t temp_adc, const struct bme68x_calib_data *calib);
+
 /* This internal API is used to calculate the temperature in integer */
-static int16_t calc_temperature(uint32_t temp_adc, struct bme68x_dev *dev);
+static int16_t calc_temperature(int32_t t_fine);
 
 /* This internal API is used to calculate the pressure in integer */
-static uint32_t calc_pressure(uint32_t pres_adc, const struct bme68x_dev *dev);
+static uint32_t calc_pressure(uint32_t pres_adc, int32_t t_fine, const struct bme68x_calib_data *calib);
 
 /* This internal API is used to calculate the humidity in integer */
-static uint32_t calc_humidity(uint16_t hum_adc, const struct bme68x_dev *dev);
+static uint32_t calc_humidity(uint16_t hum_adc, int32_t t_fine, const struct bme68x_calib_data *calib);
 
 /* This internal API is used to calculate the gas resistance high */
 static uint32_t calc_gas_resistance_high(uint16_t gas_res_adc, uint8_t gas_range);
 
 /* This internal API is used to calculate the gas resistance low */
-static uint32_t calc_gas_resistance_low(uint16_t gas_res_adc, uint8_t gas_range, const struct bme68x_dev *dev);
+static uint32_t calc_gas_resistance_low(uint16_t gas_res_adc,
+                                       uint8_t gas_range,
+                                       const struct bme68x_calib_data *calib);
 
 /* This internal API is used to calculate the heater resistance using integer */
 static uint8_t calc_res_heat(uint16_t temp, const struct bme68x_dev *dev);
 
 #else
 
+/* This internal API is used to calculate the fine resolution temperature value in float */
+static float calc_t_fine(uint32_t temp_adc, const struct bme68x_calib_data *calib);
+
 /* This internal API is used to calculate the temperature value in float */
-static float calc_temperature(uint32_t temp_adc, struct bme68x_dev *dev);
+static float calc_temperature(float t_fine);
 
 /* This internal API is used to calculate the pressure value in float */
-static float calc_pressure(uint32_t pres_adc, const struct bme68x_dev *dev);
+static float calc_pressure(uint32_t pres_adc, float t_fine, const struct bme68x_calib_data *calib);
 
 /* This internal API is used to calculate the humidity value in float */
-static float calc_humidity(uint16_t hum_adc, const struct bme68x_dev *dev);
+static float calc_humidity(uint16_t hum_adc, float t_fine, const struct bme68x_calib_data *calib);
 
 /* This internal API is used to calculate the gas resistance high value in float */
 static float calc_gas_resistance_high(uint16_t gas_res_adc, uint8_t gas_range);
 
 /* This internal API is used to calculate the gas resistance low value in float */
-static float calc_gas_resistance_low(uint16_t gas_res_adc, uint8_t gas_range, const struct bme68x_dev *dev);
+static float calc_gas_resistance_low(uint16_t gas_res_adc,
+                                       uint8_t gas_range,
+                                       const struct bme68x_calib_data *calib);
 
 /* This internal API is used to calculate the heater resistance value using float */
 static uint8_t calc_res_heat(uint16_t temp, const struct bme68x_dev *dev);
@@ -91,10 +107,16 @@ static uint8_t calc_res_heat(uint16_t temp, const struct bme68x_dev *dev);
 #endif
 
 /* This internal API is used to read a single data of the sensor */
-static int8_t read_field_data(uint8_t index, struct bme68x_data *data, struct bme68x_dev *dev);
+static int8_t read_field_data(uint8_t index, struct bme68x_raw_data *data, struct bme68x_dev *dev);
 
 /* This internal API is used to read all data fields of the sensor */
-static int8_t read_all_field_data(struct bme68x_data * const data[], struct bme68x_dev *dev);
+static int8_t read_all_field_data(struct bme68x_raw_data * const data[], struct bme68x_dev *dev);
+
+/* This internal API is used to extract the raw values of one field */
+static void parse_field_data(const uint8_t *buff, struct bme68x_raw_data *data, uint32_t variant_id);
+
+/* This internal API is used to compensate the raw values of one field */
+static void compensate_field_data(const struct bme68x_raw_data *raw, struct bme68x_data *data, struct bme68x_dev *dev);
 
 /* This internal API is used to switch between SPI memory pages */
 static int8_t set_mem_page(uint8_t reg_addr, struct bme68x_dev *dev);
@@ -105,6 +127,24 @@ static int8_t get_mem_page(struct bme68x_dev *dev);
 /* This internal API is used to check the bme68x_dev for null pointers */
 static int8_t null_ptr_check(const struct bme68x_dev *dev);
 
+/* This internal API is used to account a transaction in the interface counters */
+static void count_transaction(uint32_t n_bytes, struct bme68x_dev *dev);
+
+/* This internal API is used to refresh the cached heater registers */
+static int8_t read_heatr_cache(struct bme68x_dev *dev);
+
+/* This internal API is used to check whether the control register shadow can be used */
+static uint8_t shadow_valid(const struct bme68x_dev *dev);
+
+/* This internal API is used to fill a stale control register shadow in one burst */
+static int8_t load_shadow(struct bme68x_dev *dev);
+
+/* This internal API is used to mirror control register values into the shadow */
+static void update_shadow(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, struct bme68x_dev *dev);
+
+/* This internal API is used to write the control registers that differ from the shadow */
+static int8_t write_changed_regs(const uint8_t *reg_addr, const uint8_t *reg_data, uint8_t len, struct bme68x_dev *dev);
+
 /* This internal API is used to set heater configurations */
 static int8_t set_conf(const struct bme68x_heatr_conf *conf, uint8_t op_mode, uint8_t *nb_conv, struct bme68x_dev *dev);
 
@@ -116,10 +156,10 @@ static int8_t boundary_check(uint8_t *value, uint8_t max, struct bme68x_dev *dev
 static uint8_t calc_heatr_dur_shared(uint16_t dur);
 
 /* This internal API is used to swap two fields */
-static void swap_fields(uint8_t index1, uint8_t index2, struct bme68x_data *field[]);
+static void swap_fields(uint8_t index1, uint8_t index2, struct bme68x_raw_data *field[]);
 
 /* This internal API is used sort the sensor data */
-static void sort_sensor_data(uint8_t low_index, uint8_t high_index, struct bme68x_data *field[]);
+static void sort_sensor_data(uint8_t low_index, uint8_t high_index, struct bme68x_raw_data *field[]);
 
 /*
  * @brief       Function to analyze the sensor data
@@ -171,6 +211,40 @@ int8_t bme68x_init(struct bme68x_dev *dev)
     return rslt;
 }
 
+/* @brief This API is the warm start counterpart of bme68x_init. It checks the
+* chip-id and takes the calibration coefficients from a copy saved earlier
+* instead of resetting the sensor and reading them again.
+*/
+int8_t bme68x_init_with_calib(const uint8_t *coeff, uint32_t variant_id, struct bme68x_dev *dev)
+{
+    int8_t rslt;
+
+    rslt = null_ptr_check(dev);
+    if ((rslt == BME68X_OK) && (coeff == NULL))
+    {
+        rslt = BME68X_E_NULL_PTR;
+    }
+
+    if (rslt == BME68X_OK)
+    {
+        rslt = bme68x_get_regs(BME68X_REG_CHIP_ID, &dev->chip_id, 1, dev);
+    }
+
+    if (rslt == BME68X_OK)
+    {
+        if (dev->chip_id == BME68X_CHIP_ID)
+        {
+            rslt = bme68x_set_calib_regs(coeff, variant_id, dev);
+        }
+        else
+        {
+            rslt = BME68X_E_DEV_NOT_FOUND;
+        }
+    }
+
+    return rslt;
+}
+
 /*
  * @brief This API writes the given data to the register address of the sensor
  */
@@ -203,16 +277,32 @@ int8_t bme68x_set_regs(const uint8_t *reg_addr, const uint8_t *reg_data, uint32_
                 }
 
                 tmp_buff[(2 * index) + 1] = reg_data[index];
+
+                /* Writing a heater register makes the cached copy stale */
+                if ((reg_addr[index] >= BME68X_REG_IDAC_HEAT0) &&
+                    (reg_addr[index] < (BME68X_REG_IDAC_HEAT0 + BME68X_LEN_HEATR_SET)))
+                {
+                    dev->heatr_cache.valid = 0;
+                }
             }
 
             /* Write the interleaved array */
             if (rslt == BME68X_OK)
             {
                 dev->intf_rslt = dev->write(tmp_buff[0], &tmp_buff[1], (2 * len) - 1, dev->intf_ptr);
+                count_transaction(2 * len, dev);
                 if (dev->intf_rslt != 0)
                 {
+                    dev->shadow.valid = 0;
                     rslt = BME68X_E_COM_FAIL;
                 }
+                else
+                {
+                    for (index = 0; index < len; index++)
+                    {
+                        update_shadow(reg_addr[index], &reg_data[index], 1, dev);
+                    }
+                }
             }
         }
         else
@@ -234,6 +324,7 @@ int8_t bme68x_set_regs(const uint8_t *reg_addr, const uint8_t *reg_data, uint32_
 int8_t bme68x_get_regs(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, struct bme68x_dev *dev)
 {
     int8_t rslt;
+    uint8_t first_reg = reg_addr;
 
     /* Check for null pointer in the device structure*/
     rslt = null_ptr_check(dev);
@@ -250,10 +341,15 @@ int8_t bme68x_get_regs(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, struct
         }
 
         dev->intf_rslt = dev->read(reg_addr, reg_data, len, dev->intf_ptr);
+        count_transaction(len + 1, dev);
         if (dev->intf_rslt != 0)
         {
             rslt = BME68X_E_COM_FAIL;
         }
+        else
+        {
+            update_shadow(first_reg, reg_data, len, dev);
+        }
     }
     else
     {
@@ -287,6 +383,8 @@ int8_t bme68x_soft_reset(struct bme68x_dev *dev)
         if (rslt == BME68X_OK)
         {
             rslt = bme68x_set_regs(&reg_addr, &soft_rst_cmd, 1, dev);
+            dev->heatr_cache.valid = 0;
+            dev->shadow.valid = 0;
 
             if (rslt == BME68X_OK)
             {
@@ -313,12 +411,18 @@ int8_t bme68x_set_conf(struct bme68x_conf *conf, struct bme68x_dev *dev)
     int8_t rslt;
     uint8_t odr20 = 0, odr3 = 1;
     uint8_t current_op_mode;
+    uint8_t i;
 
     /* Register data starting from BME68X_REG_CTRL_GAS_1(0x71) up to BME68X_REG_CONFIG(0x75) */
     uint8_t reg_array[BME68X_LEN_CONFIG] = { 0x71, 0x72, 0x73, 0x74, 0x75 };
     uint8_t data_array[BME68X_LEN_CONFIG] = { 0 };
 
-    rslt = bme68x_get_op_mode(&current_op_mode, dev);
+    rslt = load_shadow(dev);
+    if (rslt == BME68X_OK)
+    {
+        rslt = bme68x_get_op_mode(&current_op_mode, dev);
+    }
+
     if (rslt == BME68X_OK)
     {
         /* Configure only in the sleep mode */
@@ -332,7 +436,18 @@ int8_t bme68x_set_conf(struct bme68x_conf *conf, struct bme68x_dev *dev)
     else if (rslt == BME68X_OK)
     {
         /* Read the whole configuration and write it back once later */
-        rslt = bme68x_get_regs(reg_array[0], data_array, BME68X_LEN_CONFIG, dev);
+        if (shadow_valid(dev))
+        {
+            for (i = 0; i < BME68X_LEN_CONFIG; i++)
+            {
+                data_array[i] = dev->shadow.reg[reg_array[i] - BME68X_REG_CTRL_GAS_0];
+            }
+        }
+        else
+        {
+            rslt = bme68x_get_regs(reg_array[0], data_array, BME68X_LEN_CONFIG, dev);
+        }
+
         dev->info_msg = BME68X_OK;
         if (rslt == BME68X_OK)
         {
@@ -378,7 +493,7 @@ int8_t bme68x_set_conf(struct bme68x_conf *conf, struct bme68x_dev *dev)
 
     if (rslt == BME68X_OK)
     {
-        rslt = bme68x_set_regs(reg_array, data_array, BME68X_LEN_CONFIG, dev);
+        rslt = write_changed_regs(reg_array, data_array, BME68X_LEN_CONFIG, dev);
     }
 
     if ((current_op_mode != BME68X_SLEEP_MODE) && (rslt == BME68X_OK))
@@ -434,22 +549,32 @@ int8_t bme68x_set_op_mode(const uint8_t op_mode, struct bme68x_dev *dev)
     uint8_t pow_mode = 0;
     uint8_t reg_addr = BME68X_REG_CTRL_MEAS;
 
-    /* Call until in sleep */
-    do
+    if (shadow_valid(dev) &&
+        ((dev->shadow.reg[BME68X_REG_CTRL_MEAS - BME68X_REG_CTRL_GAS_0] & BME68X_MODE_MSK) == BME68X_SLEEP_MODE))
     {
-        rslt = bme68x_get_regs(BME68X_REG_CTRL_MEAS, &tmp_pow_mode, 1, dev);
-        if (rslt == BME68X_OK)
+        /* The shadow copy knows the sensor is asleep, no polling needed */
+        tmp_pow_mode = dev->shadow.reg[BME68X_REG_CTRL_MEAS - BME68X_REG_CTRL_GAS_0];
+        rslt = BME68X_OK;
+    }
+    else
+    {
+        /* Call until in sleep */
+        do
         {
-            /* Put to sleep before changing mode */
-            pow_mode = (tmp_pow_mode & BME68X_MODE_MSK);
-            if (pow_mode != BME68X_SLEEP_MODE)
+            rslt = bme68x_get_regs(BME68X_REG_CTRL_MEAS, &tmp_pow_mode, 1, dev);
+            if (rslt == BME68X_OK)
             {
-                tmp_pow_mode &= ~BME68X_MODE_MSK; /* Set to sleep */
-                rslt = bme68x_set_regs(&reg_addr, &tmp_pow_mode, 1, dev);
-                dev->delay_us(BME68X_PERIOD_POLL, dev->intf_ptr);
+                /* Put to sleep before changing mode */
+                pow_mode = (tmp_pow_mode & BME68X_MODE_MSK);
+                if (pow_mode != BME68X_SLEEP_MODE)
+                {
+                    tmp_pow_mode &= ~BME68X_MODE_MSK; /* Set to sleep */
+                    rslt = bme68x_set_regs(&reg_addr, &tmp_pow_mode, 1, dev);
+                    dev->delay_us(BME68X_PERIOD_POLL, dev->intf_ptr);
+                }
             }
-        }
-    } while ((pow_mode != BME68X_SLEEP_MODE) && (rslt == BME68X_OK));
+        } while ((pow_mode != BME68X_SLEEP_MODE) && (rslt == BME68X_OK));
+    }
 
     /* Already in sleep */
     if ((op_mode != BME68X_SLEEP_MODE) && (rslt == BME68X_OK))
@@ -471,7 +596,16 @@ int8_t bme68x_get_op_mode(uint8_t *op_mode, struct bme68x_dev *dev)
 
     if (op_mode)
     {
-        rslt = bme68x_get_regs(BME68X_REG_CTRL_MEAS, &mode, 1, dev);
+        /* Only forced mode ends without a write, so the other modes can come from the shadow */
+        mode = dev ? dev->shadow.reg[BME68X_REG_CTRL_MEAS - BME68X_REG_CTRL_GAS_0] : 0;
+        if (shadow_valid(dev) && ((mode & BME68X_MODE_MSK) != BME68X_FORCED_MODE))
+        {
+            rslt = BME68X_OK;
+        }
+        else
+        {
+            rslt = bme68x_get_regs(BME68X_REG_CTRL_MEAS, &mode, 1, dev);
+        }
 
         /* Masking the other register bit info*/
         *op_mode = mode & BME68X_MODE_MSK;
@@ -533,16 +667,16 @@ uint32_t bme68x_get_meas_dur(const uint8_t op_mode, struct bme68x_conf *conf, st
 }
 
 /*
- * @brief This API reads the pressure, temperature and humidity and gas data
- * from the sensor, compensates the data and store it in the bme68x_data
- * structure instance passed by the user.
+ * @brief This API reads the uncompensated pressure, temperature, humidity and
+ * gas data from the sensor and stores it in the bme68x_raw_data structure
+ * instance passed by the user.
  */
-int8_t bme68x_get_data(uint8_t op_mode, struct bme68x_data *data, uint8_t *n_data, struct bme68x_dev *dev)
+int8_t bme68x_get_raw_data(uint8_t op_mode, struct bme68x_raw_data *data, uint8_t *n_data, struct bme68x_dev *dev)
 {
     int8_t rslt;
     uint8_t i = 0, j = 0, new_fields = 0;
-    struct bme68x_data *field_ptr[3] = { 0 };
-    struct bme68x_data field_data[3] = { { 0 } };
+    struct bme68x_raw_data *field_ptr[3] = { 0 };
+    struct bme68x_raw_data field_data[3] = { { 0 } };
 
     field_ptr[0] = &field_data[0];
     field_ptr[1] = &field_data[1];
@@ -560,6 +694,14 @@ int8_t bme68x_get_data(uint8_t op_mode, struct bme68x_data *data, uint8_t *n_dat
                 if (data->status & BME68X_NEW_DATA_MSK)
                 {
                     new_fields = 1;
+
+                    /* The sensor went back to sleep when it finished the field */
+                    if (shadow_valid(dev) &&
+                        ((dev->shadow.reg[BME68X_REG_CTRL_MEAS - BME68X_REG_CTRL_GAS_0] & BME68X_MODE_MSK) ==
+                         BME68X_FORCED_MODE))
+                    {
+                        dev->shadow.reg[BME68X_REG_CTRL_MEAS - BME68X_REG_CTRL_GAS_0] &= ~BME68X_MODE_MSK;
+                    }
                 }
                 else
                 {
@@ -624,6 +766,112 @@ int8_t bme68x_get_data(uint8_t op_mode, struct bme68x_data *data, uint8_t *n_dat
     return rslt;
 }
 
+/*
+ * @brief This API reads the pressure, temperature and humidity and gas data
+ * from the sensor, compensates the data and store it in the bme68x_data
+ * structure instance passed by the user.
+ */
+int8_t bme68x_get_data(uint8_t op_mode, struct bme68x_data *data, uint8_t *n_data, struct bme68x_dev *dev)
+{
+    int8_t rslt, cache_rslt;
+    uint8_t i, n_fields;
+    struct bme68x_raw_data raw[3] = { { 0 } };
+
+    if (data == NULL)
+    {
+        return BME68X_E_NULL_PTR;
+    }
+
+    rslt = bme68x_get_raw_data(op_mode, raw, n_data, dev);
+    if ((rslt == BME68X_OK) || (rslt == BME68X_W_NO_NEW_DATA))
+    {
+        n_fields = (op_mode == BME68X_FORCED_MODE) ? 1 : 3;
+        for (i = 0; i < n_fields; i++)
+        {
+            data[i].status = raw[i].status;
+            data[i].gas_index = raw[i].gas_index;
+            data[i].meas_index = raw[i].meas_index;
+
+            /* A forced mode field without new data is returned uncompensated */
+            if ((op_mode == BME68X_FORCED_MODE) && !(raw[i].status & BME68X_NEW_DATA_MSK))
+            {
+                continue;
+            }
+
+            /* The heater settings come from the cache, one burst read if it is stale */
+            if (!dev->heatr_cache.valid)
+            {
+                cache_rslt = read_heatr_cache(dev);
+                if (cache_rslt != BME68X_OK)
+                {
+                    rslt = cache_rslt;
+                    break;
+                }
+            }
+
+            compensate_field_data(&raw[i], &data[i], dev);
+        }
+    }
+
+    return rslt;
+}
+
+/*
+ * @brief This API compensates one field read by bme68x_get_raw_data.
+ */
+int8_t bme68x_compensate_raw_data(const struct bme68x_raw_data *raw, struct bme68x_data *data, struct bme68x_dev *dev)
+{
+    if ((raw == NULL) || (data == NULL) || (dev == NULL))
+    {
+        return BME68X_E_NULL_PTR;
+    }
+
+    data->status = raw->status;
+    data->gas_index = raw->gas_index;
+    data->meas_index = raw->meas_index;
+    compensate_field_data(raw, data, dev);
+
+    return BME68X_OK;
+}
+
+/*
+ * @brief This API reads the calibration coefficient registers of the sensor.
+ */
+int8_t bme68x_get_calib_regs(uint8_t *coeff, struct bme68x_dev *dev)
+{
+    int8_t rslt;
+
+    rslt = null_ptr_check(dev);
+    if ((rslt == BME68X_OK) && (coeff == NULL))
+    {
+        rslt = BME68X_E_NULL_PTR;
+    }
+
+    if (rslt == BME68X_OK)
+    {
+        rslt = read_calib_regs(coeff, dev);
+    }
+
+    return rslt;
+}
+
+/*
+ * @brief This API loads calibration coefficient registers read earlier with
+ * bme68x_get_calib_regs.
+ */
+int8_t bme68x_set_calib_regs(const uint8_t *coeff, uint32_t variant_id, struct bme68x_dev *dev)
+{
+    if ((coeff == NULL) || (dev == NULL))
+    {
+        return BME68X_E_NULL_PTR;
+    }
+
+    parse_calib_data(coeff, &dev->calib);
+    dev->variant_id = variant_id;
+
+    return BME68X_OK;
+}
+
 /*
  * @brief This API is used to set the gas configuration of the sensor.
  */
@@ -643,34 +891,46 @@ int8_t bme68x_set_heatr_conf(uint8_t op_mode, const struct bme68x_heatr_conf *co
             rslt = set_conf(conf, op_mode, &nb_conv, dev);
         }
 
-        if (rslt == BME68X_OK)
+        if ((rslt == BME68X_OK) && shadow_valid(dev))
+        {
+            ctrl_gas_data[0] = dev->shadow.reg[0];
+            ctrl_gas_data[1] = dev->shadow.reg[1];
+        }
+        else if (rslt == BME68X_OK)
         {
             rslt = bme68x_get_regs(BME68X_REG_CTRL_GAS_0, ctrl_gas_data, 2, dev);
-            if (rslt == BME68X_OK)
+        }
+
+        if (rslt == BME68X_OK)
+        {
+            if (conf->enable == BME68X_ENABLE)
             {
-                if (conf->enable == BME68X_ENABLE)
+                hctrl = BME68X_ENABLE_HEATER;
+                if (dev->variant_id == BME68X_VARIANT_GAS_HIGH)
                 {
-                    hctrl = BME68X_ENABLE_HEATER;
-                    if (dev->variant_id == BME68X_VARIANT_GAS_HIGH)
-                    {
-                        run_gas = BME68X_ENABLE_GAS_MEAS_H;
-                    }
-                    else
-                    {
-                        run_gas = BME68X_ENABLE_GAS_MEAS_L;
-                    }
+                    run_gas = BME68X_ENABLE_GAS_MEAS_H;
                 }
                 else
                 {
-                    hctrl = BME68X_DISABLE_HEATER;
-                    run_gas = BME68X_DISABLE_GAS_MEAS;
+                    run_gas = BME68X_ENABLE_GAS_MEAS_L;
                 }
-
-                ctrl_gas_data[0] = BME68X_SET_BITS(ctrl_gas_data[0], BME68X_HCTRL, hctrl);
-                ctrl_gas_data[1] = BME68X_SET_BITS_POS_0(ctrl_gas_data[1], BME68X_NBCONV, nb_conv);
-                ctrl_gas_data[1] = BME68X_SET_BITS(ctrl_gas_data[1], BME68X_RUN_GAS, run_gas);
-                rslt = bme68x_set_regs(ctrl_gas_addr, ctrl_gas_data, 2, dev);
             }
+            else
+            {
+                hctrl = BME68X_DISABLE_HEATER;
+                run_gas = BME68X_DISABLE_GAS_MEAS;
+            }
+
+            ctrl_gas_data[0] = BME68X_SET_BITS(ctrl_gas_data[0], BME68X_HCTRL, hctrl);
+            ctrl_gas_data[1] = BME68X_SET_BITS_POS_0(ctrl_gas_data[1], BME68X_NBCONV, nb_conv);
+            ctrl_gas_data[1] = BME68X_SET_BITS(ctrl_gas_data[1], BME68X_RUN_GAS, run_gas);
+            rslt = write_changed_regs(ctrl_gas_addr, ctrl_gas_data, 2, dev);
+        }
+
+        /* Cache the heater registers so that data read out needs no extra access */
+        if (rslt == BME68X_OK)
+        {
+            rslt = read_heatr_cache(dev);
         }
     }
     else
@@ -730,7 +990,7 @@ int8_t bme68x_selftest_check(const struct bme68x_dev *dev)
     uint8_t n_fields;
     uint8_t i = 0;
     struct bme68x_data data[BME68X_N_MEAS] = { { 0 } };
-    struct bme68x_dev t_dev;
+    struct bme68x_dev t_dev = { 0 };
     struct bme68x_conf conf;
     struct bme68x_heatr_conf heatr_conf;
 
@@ -828,31 +1088,186 @@ int8_t bme68x_selftest_check(const struct bme68x_dev *dev)
     return rslt;
 }
 
+/*
+ * @brief This API compensates a batch of raw ADC samples
+ */
+int8_t bme68x_compensate_batch(const struct bme68x_raw_batch *raw,
+                               struct bme68x_comp_batch *comp,
+                               const struct bme68x_calib_data *calib,
+                               uint32_t variant_id)
+{
+    uint32_t base;
+    uint32_t i;
+    uint32_t n;
+    uint8_t with_gas;
+
+#ifndef BME68X_USE_FPU
+    int32_t t_fine[BME68X_BATCH_CHUNK];
+#else
+    float t_fine[BME68X_BATCH_CHUNK];
+#endif
+
+    if ((raw == NULL) || (comp == NULL) || (calib == NULL) || (raw->temp_adc == NULL) || (raw->pres_adc == NULL) ||
+        (raw->hum_adc == NULL) || (comp->temperature == NULL) || (comp->pressure == NULL) || (comp->humidity == NULL))
+    {
+        return BME68X_E_NULL_PTR;
+    }
+
+    with_gas = (raw->gas_adc != NULL);
+    if (with_gas && ((raw->gas_range == NULL) || (comp->gas_resistance == NULL)))
+    {
+        return BME68X_E_NULL_PTR;
+    }
+
+    /* Each pass walks one quantity over the whole chunk, keeping the loops
+     * free of cross-quantity dependencies other than t_fine */
+    for (base = 0; base < raw->len; base += n)
+    {
+        n = raw->len - base;
+        if (n > BME68X_BATCH_CHUNK)
+        {
+            n = BME68X_BATCH_CHUNK;
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            t_fine[i] = calc_t_fine(raw->temp_adc[base + i], calib);
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            comp->temperature[base + i] = calc_temperature(t_fine[i]);
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            comp->pressure[base + i] = calc_pressure(raw->pres_adc[base + i], t_fine[i], calib);
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            comp->humidity[base + i] = calc_humidity(raw->hum_adc[base + i], t_fine[i], calib);
+        }
+    }
+
+    if (with_gas)
+    {
+        if (variant_id == BME68X_VARIANT_GAS_HIGH)
+        {
+            for (i = 0; i < raw->len; i++)
+            {
+                comp->gas_resistance[i] = calc_gas_resistance_high(raw->gas_adc[i], raw->gas_range[i]);
+            }
+        }
+        else
+        {
+            for (i = 0; i < raw->len; i++)
+            {
+                comp->gas_resistance[i] = calc_gas_resistance_low(raw->gas_adc[i], raw->gas_range[i], calib);
+            }
+        }
+    }
+
+    return BME68X_OK;
+}
+
+/*
+ * @brief This API derives the compensation coefficients from the calibration coefficients
+ */
+int8_t bme68x_precompute_calib(struct bme68x_calib_data *calib)
+{
+    struct bme68x_comp_coeffs *comp;
+
+    if (calib == NULL)
+    {
+        return BME68X_E_NULL_PTR;
+    }
+
+    comp = &calib->comp;
+#ifndef BME68X_USE_FPU
+
+    /*lint -save -e701 */
+    comp->t_off = (int32_t)calib->par_t1 << 1;
+    comp->t_quad = (int32_t)calib->par_t3 << 4;
+    comp->p_sens2 = (int32_t)calib->par_p3 << 5;
+    comp->p_off0 = (int32_t)calib->par_p4 << 16;
+    comp->p_off = (int32_t)calib->par_p7 << 7;
+    comp->h_off = (int32_t)calib->par_h1 * 16;
+    comp->h_quad0 = (int32_t)calib->par_h6 << 7;
+
+    /*lint -restore */
+#else
+
+    /* t_fine = d * par_t2 / 2^14 + d^2 * par_t3 / 2^30 with d = temp_adc - 16 * par_t1.
+     * Only the scaling by powers of two moved, so t_fine is unchanged */
+    comp->t_off = (float)calib->par_t1 * 16.0f;
+    comp->t_lin = (float)calib->par_t2 / 16384.0f;
+    comp->t_quad = (float)calib->par_t3 / 1073741824.0f;
+
+    /* With v = t_fine / 2 - 64000, the offset var2 / 4096 of the datasheet is
+     * par_p4 * 16 + v * par_p5 / 2^13 + v^2 * par_p6 / 2^31 and the sensitivity
+     * var1 is par_p1 * (1 + v * par_p2 / 2^34 + v^2 * par_p3 / 2^48) */
+    comp->p_off0 = (float)calib->par_p4 * 16.0f;
+    comp->p_off1 = (float)calib->par_p5 / 8192.0f;
+    comp->p_off2 = (float)calib->par_p6 / 2147483648.0f;
+    comp->p_sens0 = (float)calib->par_p1;
+    comp->p_sens1 = (float)((int32_t)calib->par_p1 * calib->par_p2) / 17179869184.0f;
+    comp->p_sens2 = (float)((int32_t)calib->par_p1 * calib->par_p3) / 281474976710656.0f;
+
+    /* The final correction in the uncorrected pressure p is
+     * p * (1 + par_p8 / 2^19) + p^2 * par_p9 / 2^35 + p^3 * par_p10 / 2^45 + par_p7 * 8 */
+    comp->p_off = (float)calib->par_p7 * 8.0f;
+    comp->p_lin = 1.0f + ((float)calib->par_p8 / 524288.0f);
+    comp->p_quad = (float)calib->par_p9 / 34359738368.0f;
+    comp->p_cub = (float)calib->par_p10 / 35184372088832.0f;
+
+    /* The humidity gain is par_h2 / 2^18 * (1 + T * par_h4 / 2^14 + T^2 * par_h5 / 2^20) */
+    comp->h_off = (float)calib->par_h1 * 16.0f;
+    comp->h_temp = (float)calib->par_h3 / 2.0f;
+    comp->h_gain0 = (float)calib->par_h2 / 262144.0f;
+    comp->h_gain1 = (float)((int32_t)calib->par_h2 * calib->par_h4) / 4294967296.0f;
+    comp->h_gain2 = (float)((int32_t)calib->par_h2 * calib->par_h5) / 274877906944.0f;
+    comp->h_quad0 = (float)calib->par_h6 / 16384.0f;
+    comp->h_quad1 = (float)calib->par_h7 / 2097152.0f;
+#endif
+
+    return BME68X_OK;
+}
+
 /*****************************INTERNAL APIs***********************************************/
 #ifndef BME68X_USE_FPU
 
-/* @brief This internal API is used to calculate the temperature value. */
-static int16_t calc_temperature(uint32_t temp_adc, struct bme68x_dev *dev)
+/* @brief This internal API is used to calculate the fine resolution temperature value. */
+static int32_t calc_t_fine(uint32_t temp_adc, const struct bme68x_calib_data *calib)
 {
     int64_t var1;
     int64_t var2;
     int64_t var3;
-    int16_t calc_temp;
 
     /*lint -save -e701 -e702 -e704 */
-    var1 = ((int32_t)temp_adc >> 3) - ((int32_t)dev->calib.par_t1 << 1);
-    var2 = (var1 * (int32_t)dev->calib.par_t2) >> 11;
+    var1 = ((int32_t)temp_adc >> 3) - calib->comp.t_off;
+    var2 = (var1 * (int32_t)calib->par_t2) >> 11;
     var3 = ((var1 >> 1) * (var1 >> 1)) >> 12;
-    var3 = ((var3) * ((int32_t)dev->calib.par_t3 << 4)) >> 14;
-    dev->calib.t_fine = (int32_t)(var2 + var3);
-    calc_temp = (int16_t)(((dev->calib.t_fine * 5) + 128) >> 8);
+    var3 = ((var3) * calib->comp.t_quad) >> 14;
+
+    /*lint -restore */
+    return (int32_t)(var2 + var3);
+}
+
+/* @brief This internal API is used to calculate the temperature value. */
+static int16_t calc_temperature(int32_t t_fine)
+{
+    int16_t calc_temp;
+
+    /*lint -save -e702 -e704 */
+    calc_temp = (int16_t)(((t_fine * 5) + 128) >> 8);
 
     /*lint -restore */
     return calc_temp;
 }
 
 /* @brief This internal API is used to calculate the pressure value. */
-static uint32_t calc_pressure(uint32_t pres_adc, const struct bme68x_dev *dev)
+static uint32_t calc_pressure(uint32_t pres_adc, int32_t t_fine, const struct bme68x_calib_data *calib)
 {
     int32_t var1;
     int32_t var2;
@@ -867,14 +1282,14 @@ static uint32_t calc_pressure(uint32_t pres_adc, const struct bme68x_dev *dev)
     const int32_t pres_ovf_check = INT32_C(0x40000000);
 
     /*lint -save -e701 -e702 -e713 */
-    var1 = (((int32_t)dev->calib.t_fine) >> 1) - 64000;
-    var2 = ((((var1 >> 2) * (var1 >> 2)) >> 11) * (int32_t)dev->calib.par_p6) >> 2;
-    var2 = var2 + ((var1 * (int32_t)dev->calib.par_p5) << 1);
-    var2 = (var2 >> 2) + ((int32_t)dev->calib.par_p4 << 16);
-    var1 = (((((var1 >> 2) * (var1 >> 2)) >> 13) * ((int32_t)dev->calib.par_p3 << 5)) >> 3) +
-           (((int32_t)dev->calib.par_p2 * var1) >> 1);
+    var1 = ((t_fine) >> 1) - 64000;
+    var2 = ((((var1 >> 2) * (var1 >> 2)) >> 11) * (int32_t)calib->par_p6) >> 2;
+    var2 = var2 + ((var1 * (int32_t)calib->par_p5) << 1);
+    var2 = (var2 >> 2) + calib->comp.p_off0;
+    var1 = (((((var1 >> 2) * (var1 >> 2)) >> 13) * calib->comp.p_sens2) >> 3) +
+           (((int32_t)calib->par_p2 * var1) >> 1);
     var1 = var1 >> 18;
-    var1 = ((32768 + var1) * (int32_t)dev->calib.par_p1) >> 15;
+    var1 = ((32768 + var1) * (int32_t)calib->par_p1) >> 15;
     pressure_comp = 1048576 - pres_adc;
     pressure_comp = (int32_t)((pressure_comp - (var2 >> 12)) * ((uint32_t)3125));
     if (pressure_comp >= pres_ovf_check)
@@ -886,19 +1301,19 @@ static uint32_t calc_pressure(uint32_t pres_adc, const struct bme68x_dev *dev)
         pressure_comp = ((pressure_comp << 1) / var1);
     }
 
-    var1 = ((int32_t)dev->calib.par_p9 * (int32_t)(((pressure_comp >> 3) * (pressure_comp >> 3)) >> 13)) >> 12;
-    var2 = ((int32_t)(pressure_comp >> 2) * (int32_t)dev->calib.par_p8) >> 13;
+    var1 = ((int32_t)calib->par_p9 * (int32_t)(((pressure_comp >> 3) * (pressure_comp >> 3)) >> 13)) >> 12;
+    var2 = ((int32_t)(pressure_comp >> 2) * (int32_t)calib->par_p8) >> 13;
     var3 =
         ((int32_t)(pressure_comp >> 8) * (int32_t)(pressure_comp >> 8) * (int32_t)(pressure_comp >> 8) *
-         (int32_t)dev->calib.par_p10) >> 17;
-    pressure_comp = (int32_t)(pressure_comp) + ((var1 + var2 + var3 + ((int32_t)dev->calib.par_p7 << 7)) >> 4);
+         (int32_t)calib->par_p10) >> 17;
+    pressure_comp = (int32_t)(pressure_comp) + ((var1 + var2 + var3 + calib->comp.p_off) >> 4);
 
     /*lint -restore */
     return (uint32_t)pressure_comp;
 }
 
 /* This internal API is used to calculate the humidity in integer */
-static uint32_t calc_humidity(uint16_t hum_adc, const struct bme68x_dev *dev)
+static uint32_t calc_humidity(uint16_t hum_adc, int32_t t_fine, const struct bme68x_calib_data *calib)
 {
     int32_t var1;
     int32_t var2;
@@ -910,17 +1325,17 @@ static uint32_t calc_humidity(uint16_t hum_adc, const struct bme68x_dev *dev)
     int32_t calc_hum;
 
     /*lint -save -e702 -e704 */
-    temp_scaled = (((int32_t)dev->calib.t_fine * 5) + 128) >> 8;
-    var1 = (int32_t)(hum_adc - ((int32_t)((int32_t)dev->calib.par_h1 * 16))) -
-           (((temp_scaled * (int32_t)dev->calib.par_h3) / ((int32_t)100)) >> 1);
+    temp_scaled = ((t_fine * 5) + 128) >> 8;
+    var1 = (int32_t)(hum_adc - calib->comp.h_off) -
+           (((temp_scaled * (int32_t)calib->par_h3) / ((int32_t)100)) >> 1);
     var2 =
-        ((int32_t)dev->calib.par_h2 *
-         (((temp_scaled * (int32_t)dev->calib.par_h4) / ((int32_t)100)) +
-          (((temp_scaled * ((temp_scaled * (int32_t)dev->calib.par_h5) / ((int32_t)100))) >> 6) / ((int32_t)100)) +
+        ((int32_t)calib->par_h2 *
+         (((temp_scaled * (int32_t)calib->par_h4) / ((int32_t)100)) +
+          (((temp_scaled * ((temp_scaled * (int32_t)calib->par_h5) / ((int32_t)100))) >> 6) / ((int32_t)100)) +
           (int32_t)(1 << 14))) >> 10;
     var3 = var1 * var2;
-    var4 = (int32_t)dev->calib.par_h6 << 7;
-    var4 = ((var4) + ((temp_scaled * (int32_t)dev->calib.par_h7) / ((int32_t)100))) >> 4;
+    var4 = calib->comp.h_quad0;
+    var4 = ((var4) + ((temp_scaled * (int32_t)calib->par_h7) / ((int32_t)100))) >> 4;
     var5 = ((var3 >> 14) * (var3 >> 14)) >> 10;
     var6 = (var4 * var5) >> 1;
     calc_hum = (((var3 + var6) >> 10) * ((int32_t)1000)) >> 12;
@@ -938,7 +1353,9 @@ static uint32_t calc_humidity(uint16_t hum_adc, const struct bme68x_dev *dev)
 }
 
 /* This internal API is used to calculate the gas resistance low */
-static uint32_t calc_gas_resistance_low(uint16_t gas_res_adc, uint8_t gas_range, const struct bme68x_dev *dev)
+static uint32_t calc_gas_resistance_low(uint16_t gas_res_adc,
+                                       uint8_t gas_range,
+                                       const struct bme68x_calib_data *calib)
 {
     int64_t var1;
     uint64_t var2;
@@ -957,7 +1374,7 @@ static uint32_t calc_gas_resistance_low(uint16_t gas_res_adc, uint8_t gas_range,
     };
 
     /*lint -save -e704 */
-    var1 = (int64_t)((1340 + (5 * (int64_t)dev->calib.range_sw_err)) * ((int64_t)lookup_table1[gas_range])) >> 16;
+    var1 = (int64_t)((1340 + (5 * (int64_t)calib->range_sw_err)) * ((int64_t)lookup_table1[gas_range])) >> 16;
     var2 = (((int64_t)((int64_t)gas_res_adc << 15) - (int64_t)(16777216)) + var1);
     var3 = (((int64_t)lookup_table2[gas_range] * (int64_t)var1) >> 9);
     calc_gas_res = (uint32_t)((var3 + ((int64_t)var2 >> 1)) / (int64_t)var2);
@@ -1012,54 +1429,48 @@ static uint8_t calc_res_heat(uint16_t temp, const struct bme68x_dev *dev)
 
 #else
 
-/* @brief This internal API is used to calculate the temperature value. */
-static float calc_temperature(uint32_t temp_adc, struct bme68x_dev *dev)
+/* @brief This internal API is used to calculate the fine resolution temperature value. */
+static float calc_t_fine(uint32_t temp_adc, const struct bme68x_calib_data *calib)
 {
     float var1;
-    float var2;
-    float calc_temp;
 
-    /* calculate var1 data */
-    var1 = ((((float)temp_adc / 16384.0f) - ((float)dev->calib.par_t1 / 1024.0f)) * ((float)dev->calib.par_t2));
-
-    /* calculate var2 data */
-    var2 =
-        (((((float)temp_adc / 131072.0f) - ((float)dev->calib.par_t1 / 8192.0f)) *
-          (((float)temp_adc / 131072.0f) - ((float)dev->calib.par_t1 / 8192.0f))) * ((float)dev->calib.par_t3 * 16.0f));
+    /* Distance from the calibration point, exact for any 20 bit ADC value */
+    var1 = (float)temp_adc - calib->comp.t_off;
 
     /* t_fine value*/
-    dev->calib.t_fine = (var1 + var2);
+    return (var1 * calib->comp.t_lin) + (var1 * var1 * calib->comp.t_quad);
+}
+
+/* @brief This internal API is used to calculate the temperature value. */
+static float calc_temperature(float t_fine)
+{
+    float calc_temp;
 
     /* compensated temperature data*/
-    calc_temp = ((dev->calib.t_fine) / 5120.0f);
+    calc_temp = t_fine * (1.0f / 5120.0f);
 
     return calc_temp;
 }
 
 /* @brief This internal API is used to calculate the pressure value. */
-static float calc_pressure(uint32_t pres_adc, const struct bme68x_dev *dev)
+static float calc_pressure(uint32_t pres_adc, float t_fine, const struct bme68x_calib_data *calib)
 {
+    const struct bme68x_comp_coeffs *comp = &calib->comp;
     float var1;
     float var2;
     float var3;
     float calc_pres;
 
-    var1 = (((float)dev->calib.t_fine / 2.0f) - 64000.0f);
-    var2 = var1 * var1 * (((float)dev->calib.par_p6) / (131072.0f));
-    var2 = var2 + (var1 * ((float)dev->calib.par_p5) * 2.0f);
-    var2 = (var2 / 4.0f) + (((float)dev->calib.par_p4) * 65536.0f);
-    var1 = (((((float)dev->calib.par_p3 * var1 * var1) / 16384.0f) + ((float)dev->calib.par_p2 * var1)) / 524288.0f);
-    var1 = ((1.0f + (var1 / 32768.0f)) * ((float)dev->calib.par_p1));
-    calc_pres = (1048576.0f - ((float)pres_adc));
+    var1 = (t_fine * 0.5f) - 64000.0f;
+    var2 = (var1 * ((var1 * comp->p_off2) + comp->p_off1)) + comp->p_off0;
+    var3 = (var1 * ((var1 * comp->p_sens2) + comp->p_sens1)) + comp->p_sens0;
 
     /* Avoid exception caused by division by zero */
-    if ((int)var1 != 0)
+    if ((int)var3 != 0)
     {
-        calc_pres = (((calc_pres - (var2 / 4096.0f)) * 6250.0f) / var1);
-        var1 = (((float)dev->calib.par_p9) * calc_pres * calc_pres) / 2147483648.0f;
-        var2 = calc_pres * (((float)dev->calib.par_p8) / 32768.0f);
-        var3 = ((calc_pres / 256.0f) * (calc_pres / 256.0f) * (calc_pres / 256.0f) * (dev->calib.par_p10 / 131072.0f));
-        calc_pres = (calc_pres + (var1 + var2 + var3 + ((float)dev->calib.par_p7 * 128.0f)) / 16.0f);
+        calc_pres = (((1048576.0f - (float)pres_adc) - var2) * 6250.0f) / var3;
+        calc_pres = (calc_pres * (comp->p_lin + (calc_pres * (comp->p_quad + (calc_pres * comp->p_cub))))) +
+                    comp->p_off;
     }
     else
     {
@@ -1070,26 +1481,19 @@ static float calc_pressure(uint32_t pres_adc, const struct bme68x_dev *dev)
 }
 
 /* This internal API is used to calculate the humidity in integer */
-static float calc_humidity(uint16_t hum_adc, const struct bme68x_dev *dev)
+static float calc_humidity(uint16_t hum_adc, float t_fine, const struct bme68x_calib_data *calib)
 {
+    const struct bme68x_comp_coeffs *comp = &calib->comp;
     float calc_hum;
     float var1;
     float var2;
-    float var3;
-    float var4;
     float temp_comp;
 
     /* compensated temperature data*/
-    temp_comp = ((dev->calib.t_fine) / 5120.0f);
-    var1 = (float)((float)hum_adc) -
-           (((float)dev->calib.par_h1 * 16.0f) + (((float)dev->calib.par_h3 / 2.0f) * temp_comp));
-    var2 = var1 *
-           ((float)(((float)dev->calib.par_h2 / 262144.0f) *
-                    (1.0f + (((float)dev->calib.par_h4 / 16384.0f) * temp_comp) +
-                     (((float)dev->calib.par_h5 / 1048576.0f) * temp_comp * temp_comp))));
-    var3 = (float)dev->calib.par_h6 / 16384.0f;
-    var4 = (float)dev->calib.par_h7 / 2097152.0f;
-    calc_hum = var2 + ((var3 + (var4 * temp_comp)) * var2 * var2);
+    temp_comp = t_fine * (1.0f / 5120.0f);
+    var1 = (float)hum_adc - (comp->h_off + (comp->h_temp * temp_comp));
+    var2 = var1 * (comp->h_gain0 + (temp_comp * (comp->h_gain1 + (temp_comp * comp->h_gain2))));
+    calc_hum = var2 + ((comp->h_quad0 + (comp->h_quad1 * temp_comp)) * var2 * var2);
     if (calc_hum > 100.0f)
     {
         calc_hum = 100.0f;
@@ -1103,7 +1507,9 @@ static float calc_humidity(uint16_t hum_adc, const struct bme68x_dev *dev)
 }
 
 /* This internal API is used to calculate the gas resistance low value in float */
-static float calc_gas_resistance_low(uint16_t gas_res_adc, uint8_t gas_range, const struct bme68x_dev *dev)
+static float calc_gas_resistance_low(uint16_t gas_res_adc,
+                                       uint8_t gas_range,
+                                       const struct bme68x_calib_data *calib)
 {
     float calc_gas_res;
     float var1;
@@ -1118,7 +1524,7 @@ static float calc_gas_resistance_low(uint16_t gas_res_adc, uint8_t gas_range, co
         0.0f, 0.0f, 0.0f, 0.0f, 0.1f, 0.7f, 0.0f, -0.8f, -0.1f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f
     };
 
-    var1 = (1340.0f + (5.0f * dev->calib.range_sw_err));
+    var1 = (1340.0f + (5.0f * calib->range_sw_err));
     var2 = (var1) * (1.0f + lookup_k1_range[gas_range] / 100.0f);
     var3 = 1.0f + (lookup_k2_range[gas_range] / 100.0f);
     calc_gas_res = 1.0f / (float)(var3 * (0.000000125f) * gas_range_f * (((gas_res_f - 512.0f) / var2) + 1.0f));
@@ -1197,16 +1603,12 @@ static uint8_t calc_gas_wait(uint16_t dur)
 }
 
 /* This internal API is used to read a single data of the sensor */
-static int8_t read_field_data(uint8_t index, struct bme68x_data *data, struct bme68x_dev *dev)
+static int8_t read_field_data(uint8_t index, struct bme68x_raw_data *data, struct bme68x_dev *dev)
 {
     int8_t rslt = BME68X_OK;
     uint8_t buff[BME68X_LEN_FIELD] = { 0 };
-    uint8_t gas_range_l, gas_range_h;
-    uint32_t adc_temp;
-    uint32_t adc_pres;
-    uint16_t adc_hum;
-    uint16_t adc_gas_res_low, adc_gas_res_high;
-    uint8_t tries = 5;
+    uint8_t tries = dev->poll_tries ? dev->poll_tries : BME68X_POLL_TRIES;
+    uint32_t poll_period = dev->poll_period_us ? dev->poll_period_us : BME68X_PERIOD_POLL;
 
     while ((tries) && (rslt == BME68X_OK))
     {
@@ -1220,63 +1622,21 @@ static int8_t read_field_data(uint8_t index, struct bme68x_data *data, struct bm
             break;
         }
 
-        data->status = buff[0] & BME68X_NEW_DATA_MSK;
-        data->gas_index = buff[0] & BME68X_GAS_INDEX_MSK;
-        data->meas_index = buff[1];
-
-        /* read the raw data from the sensor */
-        adc_pres = (uint32_t)(((uint32_t)buff[2] * 4096) | ((uint32_t)buff[3] * 16) | ((uint32_t)buff[4] / 16));
-        adc_temp = (uint32_t)(((uint32_t)buff[5] * 4096) | ((uint32_t)buff[6] * 16) | ((uint32_t)buff[7] / 16));
-        adc_hum = (uint16_t)(((uint32_t)buff[8] * 256) | (uint32_t)buff[9]);
-        adc_gas_res_low = (uint16_t)((uint32_t)buff[13] * 4 | (((uint32_t)buff[14]) / 64));
-        adc_gas_res_high = (uint16_t)((uint32_t)buff[15] * 4 | (((uint32_t)buff[16]) / 64));
-        gas_range_l = buff[14] & BME68X_GAS_RANGE_MSK;
-        gas_range_h = buff[16] & BME68X_GAS_RANGE_MSK;
-        if (dev->variant_id == BME68X_VARIANT_GAS_HIGH)
-        {
-            data->status |= buff[16] & BME68X_GASM_VALID_MSK;
-            data->status |= buff[16] & BME68X_HEAT_STAB_MSK;
-        }
-        else
+        parse_field_data(buff, data, dev->variant_id);
+        if ((data->status & BME68X_NEW_DATA_MSK) && (rslt == BME68X_OK))
         {
-            data->status |= buff[14] & BME68X_GASM_VALID_MSK;
-            data->status |= buff[14] & BME68X_HEAT_STAB_MSK;
+            break;
         }
 
-        if ((data->status & BME68X_NEW_DATA_MSK) && (rslt == BME68X_OK))
+        if (rslt == BME68X_OK)
         {
-            rslt = bme68x_get_regs(BME68X_REG_RES_HEAT0 + data->gas_index, &data->res_heat, 1, dev);
-            if (rslt == BME68X_OK)
-            {
-                rslt = bme68x_get_regs(BME68X_REG_IDAC_HEAT0 + data->gas_index, &data->idac, 1, dev);
-            }
+            dev->intf_stats.data_polls++;
 
-            if (rslt == BME68X_OK)
+            /* No wait after the last try, the caller gets BME68X_W_NO_NEW_DATA right away */
+            if (tries > 1)
             {
-                rslt = bme68x_get_regs(BME68X_REG_GAS_WAIT0 + data->gas_index, &data->gas_wait, 1, dev);
+                dev->delay_us(poll_period, dev->intf_ptr);
             }
-
-            if (rslt == BME68X_OK)
-            {
-                data->temperature = calc_temperature(adc_temp, dev);
-                data->pressure = calc_pressure(adc_pres, dev);
-                data->humidity = calc_humidity(adc_hum, dev);
-                if (dev->variant_id == BME68X_VARIANT_GAS_HIGH)
-                {
-                    data->gas_resistance = calc_gas_resistance_high(adc_gas_res_high, gas_range_h);
-                }
-                else
-                {
-                    data->gas_resistance = calc_gas_resistance_low(adc_gas_res_low, gas_range_l, dev);
-                }
-
-                break;
-            }
-        }
-
-        if (rslt == BME68X_OK)
-        {
-            dev->delay_us(BME68X_PERIOD_POLL, dev->intf_ptr);
         }
 
         tries--;
@@ -1286,17 +1646,10 @@ static int8_t read_field_data(uint8_t index, struct bme68x_data *data, struct bm
 }
 
 /* This internal API is used to read all data fields of the sensor */
-static int8_t read_all_field_data(struct bme68x_data * const data[], struct bme68x_dev *dev)
+static int8_t read_all_field_data(struct bme68x_raw_data * const data[], struct bme68x_dev *dev)
 {
     int8_t rslt = BME68X_OK;
     uint8_t buff[BME68X_LEN_FIELD * 3] = { 0 };
-    uint8_t gas_range_l, gas_range_h;
-    uint32_t adc_temp;
-    uint32_t adc_pres;
-    uint16_t adc_hum;
-    uint16_t adc_gas_res_low, adc_gas_res_high;
-    uint8_t off;
-    uint8_t set_val[30] = { 0 }; /* idac, res_heat, gas_wait */
     uint8_t i;
 
     if (!data[0] && !data[1] && !data[2])
@@ -1309,61 +1662,76 @@ static int8_t read_all_field_data(struct bme68x_data * const data[], struct bme6
         rslt = bme68x_get_regs(BME68X_REG_FIELD0, buff, (uint32_t) BME68X_LEN_FIELD * 3, dev);
     }
 
-    if (rslt == BME68X_OK)
+    for (i = 0; ((i < 3) && (rslt == BME68X_OK)); i++)
     {
-        rslt = bme68x_get_regs(BME68X_REG_IDAC_HEAT0, set_val, 30, dev);
+        parse_field_data(&buff[i * BME68X_LEN_FIELD], data[i], dev->variant_id);
     }
 
-    for (i = 0; ((i < 3) && (rslt == BME68X_OK)); i++)
+    return rslt;
+}
+
+/* This internal API is used to extract the raw values of one field */
+static void parse_field_data(const uint8_t *buff, struct bme68x_raw_data *data, uint32_t variant_id)
+{
+    data->status = buff[0] & BME68X_NEW_DATA_MSK;
+    data->gas_index = buff[0] & BME68X_GAS_INDEX_MSK;
+    data->meas_index = buff[1];
+
+    /* read the raw data from the sensor */
+    data->pres_adc = (uint32_t)(((uint32_t)buff[2] * 4096) | ((uint32_t)buff[3] * 16) | ((uint32_t)buff[4] / 16));
+    data->temp_adc = (uint32_t)(((uint32_t)buff[5] * 4096) | ((uint32_t)buff[6] * 16) | ((uint32_t)buff[7] / 16));
+    data->hum_adc = (uint16_t)(((uint32_t)buff[8] * 256) | (uint32_t)buff[9]);
+    if (variant_id == BME68X_VARIANT_GAS_HIGH)
     {
-        off = (uint8_t)(i * BME68X_LEN_FIELD);
-        data[i]->status = buff[off] & BME68X_NEW_DATA_MSK;
-        data[i]->gas_index = buff[off] & BME68X_GAS_INDEX_MSK;
-        data[i]->meas_index = buff[off + 1];
-
-        /* read the raw data from the sensor */
-        adc_pres =
-            (uint32_t) (((uint32_t) buff[off + 2] * 4096) | ((uint32_t) buff[off + 3] * 16) |
-                        ((uint32_t) buff[off + 4] / 16));
-        adc_temp =
-            (uint32_t) (((uint32_t) buff[off + 5] * 4096) | ((uint32_t) buff[off + 6] * 16) |
-                        ((uint32_t) buff[off + 7] / 16));
-        adc_hum = (uint16_t) (((uint32_t) buff[off + 8] * 256) | (uint32_t) buff[off + 9]);
-        adc_gas_res_low = (uint16_t) ((uint32_t) buff[off + 13] * 4 | (((uint32_t) buff[off + 14]) / 64));
-        adc_gas_res_high = (uint16_t) ((uint32_t) buff[off + 15] * 4 | (((uint32_t) buff[off + 16]) / 64));
-        gas_range_l = buff[off + 14] & BME68X_GAS_RANGE_MSK;
-        gas_range_h = buff[off + 16] & BME68X_GAS_RANGE_MSK;
-        if (dev->variant_id == BME68X_VARIANT_GAS_HIGH)
-        {
-            data[i]->status |= buff[off + 16] & BME68X_GASM_VALID_MSK;
-            data[i]->status |= buff[off + 16] & BME68X_HEAT_STAB_MSK;
-        }
-        else
-        {
-            data[i]->status |= buff[off + 14] & BME68X_GASM_VALID_MSK;
-            data[i]->status |= buff[off + 14] & BME68X_HEAT_STAB_MSK;
-        }
+        data->gas_adc = (uint16_t)((uint32_t)buff[15] * 4 | (((uint32_t)buff[16]) / 64));
+        data->gas_range = buff[16] & BME68X_GAS_RANGE_MSK;
+        data->status |= buff[16] & BME68X_GASM_VALID_MSK;
+        data->status |= buff[16] & BME68X_HEAT_STAB_MSK;
+    }
+    else
+    {
+        data->gas_adc = (uint16_t)((uint32_t)buff[13] * 4 | (((uint32_t)buff[14]) / 64));
+        data->gas_range = buff[14] & BME68X_GAS_RANGE_MSK;
+        data->status |= buff[14] & BME68X_GASM_VALID_MSK;
+        data->status |= buff[14] & BME68X_HEAT_STAB_MSK;
+    }
+}
 
-        data[i]->idac = set_val[data[i]->gas_index];
-        data[i]->res_heat = set_val[10 + data[i]->gas_index];
-        data[i]->gas_wait = set_val[20 + data[i]->gas_index];
-        data[i]->temperature = calc_temperature(adc_temp, dev);
-        data[i]->pressure = calc_pressure(adc_pres, dev);
-        data[i]->humidity = calc_humidity(adc_hum, dev);
-        if (dev->variant_id == BME68X_VARIANT_GAS_HIGH)
-        {
-            data[i]->gas_resistance = calc_gas_resistance_high(adc_gas_res_high, gas_range_h);
-        }
-        else
-        {
-            data[i]->gas_resistance = calc_gas_resistance_low(adc_gas_res_low, gas_range_l, dev);
-        }
+/* This internal API is used to compensate the raw values of one field */
+static void compensate_field_data(const struct bme68x_raw_data *raw, struct bme68x_data *data, struct bme68x_dev *dev)
+{
+    const uint8_t *set_val = dev->heatr_cache.set_val; /* idac, res_heat, gas_wait */
+
+    if (dev->heatr_cache.valid)
+    {
+        data->idac = set_val[raw->gas_index];
+        data->res_heat = set_val[10 + raw->gas_index];
+        data->gas_wait = set_val[20 + raw->gas_index];
+    }
+    else
+    {
+        data->idac = 0;
+        data->res_heat = 0;
+        data->gas_wait = 0;
     }
 
-    return rslt;
+    dev->calib.t_fine = calc_t_fine(raw->temp_adc, &dev->calib);
+    data->temperature = calc_temperature(dev->calib.t_fine);
+    data->pressure = calc_pressure(raw->pres_adc, dev->calib.t_fine, &dev->calib);
+    data->humidity = calc_humidity(raw->hum_adc, dev->calib.t_fine, &dev->calib);
+    if (dev->variant_id == BME68X_VARIANT_GAS_HIGH)
+    {
+        data->gas_resistance = calc_gas_resistance_high(raw->gas_adc, raw->gas_range);
+    }
+    else
+    {
+        data->gas_resistance = calc_gas_resistance_low(raw->gas_adc, raw->gas_range, &dev->calib);
+    }
 }
 
-/* This internal API is used to switch between SPI memory pages */
+/* This internal API is used to switch between SPI memory pages. The page
+ * register is read once and then tracked in dev->mem_page_reg, so a switch
+ * is a single write instead of a read-modify-write. */
 static int8_t set_mem_page(uint8_t reg_addr, struct bme68x_dev *dev)
 {
     int8_t rslt;
@@ -1383,24 +1751,28 @@ static int8_t set_mem_page(uint8_t reg_addr, struct bme68x_dev *dev)
             mem_page = BME68X_MEM_PAGE0;
         }
 
-        if (mem_page != dev->mem_page)
+        /* The page is unknown after a warm start or a failed switch */
+        if (!dev->mem_page_known)
+        {
+            rslt = get_mem_page(dev);
+        }
+
+        if ((rslt == BME68X_OK) && (mem_page != dev->mem_page))
         {
-            dev->mem_page = mem_page;
-            dev->intf_rslt = dev->read(BME68X_REG_MEM_PAGE | BME68X_SPI_RD_MSK, &reg, 1, dev->intf_ptr);
+            reg = dev->mem_page_reg & (~BME68X_MEM_PAGE_MSK);
+            reg = reg | (mem_page & BME68X_MEM_PAGE_MSK);
+            dev->intf_rslt = dev->write(BME68X_REG_MEM_PAGE & BME68X_SPI_WR_MSK, &reg, 1, dev->intf_ptr);
+            count_transaction(2, dev);
+            dev->intf_stats.page_switches++;
             if (dev->intf_rslt != 0)
             {
+                dev->mem_page_known = 0;
                 rslt = BME68X_E_COM_FAIL;
             }
-
-            if (rslt == BME68X_OK)
+            else
             {
-                reg = reg & (~BME68X_MEM_PAGE_MSK);
-                reg = reg | (dev->mem_page & BME68X_MEM_PAGE_MSK);
-                dev->intf_rslt = dev->write(BME68X_REG_MEM_PAGE & BME68X_SPI_WR_MSK, &reg, 1, dev->intf_ptr);
-                if (dev->intf_rslt != 0)
-                {
-                    rslt = BME68X_E_COM_FAIL;
-                }
+                dev->mem_page = mem_page;
+                dev->mem_page_reg = reg;
             }
         }
     }
@@ -1419,13 +1791,17 @@ static int8_t get_mem_page(struct bme68x_dev *dev)
     if (rslt == BME68X_OK)
     {
         dev->intf_rslt = dev->read(BME68X_REG_MEM_PAGE | BME68X_SPI_RD_MSK, &reg, 1, dev->intf_ptr);
+        count_transaction(2, dev);
         if (dev->intf_rslt != 0)
         {
+            dev->mem_page_known = 0;
             rslt = BME68X_E_COM_FAIL;
         }
         else
         {
             dev->mem_page = reg & BME68X_MEM_PAGE_MSK;
+            dev->mem_page_reg = reg;
+            dev->mem_page_known = 1;
         }
     }
 
@@ -1470,6 +1846,103 @@ static int8_t null_ptr_check(const struct bme68x_dev *dev)
     return rslt;
 }
 
+/* This internal API is used to account a transaction in the interface counters */
+static void count_transaction(uint32_t n_bytes, struct bme68x_dev *dev)
+{
+    dev->intf_stats.transactions++;
+    dev->intf_stats.bytes += n_bytes;
+}
+
+/* This internal API is used to refresh the cached heater registers */
+static int8_t read_heatr_cache(struct bme68x_dev *dev)
+{
+    int8_t rslt;
+
+    /* idac, res_heat and gas_wait of all 10 steps are contiguous, fetch them in one burst */
+    rslt = bme68x_get_regs(BME68X_REG_IDAC_HEAT0, dev->heatr_cache.set_val, BME68X_LEN_HEATR_SET, dev);
+    dev->heatr_cache.valid = (rslt == BME68X_OK) ? 1 : 0;
+
+    return rslt;
+}
+
+/* This internal API is used to check whether the control register shadow can be used */
+static uint8_t shadow_valid(const struct bme68x_dev *dev)
+{
+    return (dev != NULL) && dev->shadow.enable && dev->shadow.valid;
+}
+
+/* This internal API is used to fill a stale control register shadow in one burst */
+static int8_t load_shadow(struct bme68x_dev *dev)
+{
+    int8_t rslt = BME68X_OK;
+    uint8_t buff[BME68X_LEN_SHADOW];
+
+    if ((dev != NULL) && dev->shadow.enable && !dev->shadow.valid)
+    {
+        /* bme68x_get_regs mirrors the block into the shadow and marks it valid */
+        rslt = bme68x_get_regs(BME68X_REG_CTRL_GAS_0, buff, BME68X_LEN_SHADOW, dev);
+    }
+
+    return rslt;
+}
+
+/* This internal API is used to mirror control register values into the shadow */
+static void update_shadow(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, struct bme68x_dev *dev)
+{
+    uint32_t i;
+    uint32_t addr;
+
+    for (i = 0; i < len; i++)
+    {
+        addr = (uint32_t)reg_addr + i;
+        if ((addr >= BME68X_REG_CTRL_GAS_0) && (addr < (uint32_t)(BME68X_REG_CTRL_GAS_0 + BME68X_LEN_SHADOW)))
+        {
+            dev->shadow.reg[addr - BME68X_REG_CTRL_GAS_0] = reg_data[i];
+        }
+    }
+
+    /* Only a read of the whole block makes a stale shadow valid */
+    if ((reg_addr <= BME68X_REG_CTRL_GAS_0) &&
+        (((uint32_t)reg_addr + len) >= (uint32_t)(BME68X_REG_CTRL_GAS_0 + BME68X_LEN_SHADOW)))
+    {
+        dev->shadow.valid = 1;
+    }
+}
+
+/* This internal API is used to write the control registers that differ from the shadow.
+ * 0x73 is skipped: bme68x_set_conf only writes it back unchanged. */
+static int8_t write_changed_regs(const uint8_t *reg_addr, const uint8_t *reg_data, uint8_t len, struct bme68x_dev *dev)
+{
+    int8_t rslt = BME68X_OK;
+    uint8_t i;
+    uint8_t n_changed = 0;
+    uint8_t changed_addr[BME68X_LEN_SHADOW];
+    uint8_t changed_data[BME68X_LEN_SHADOW];
+
+    if (!shadow_valid(dev) || (len > BME68X_LEN_SHADOW))
+    {
+        return bme68x_set_regs(reg_addr, reg_data, len, dev);
+    }
+
+    for (i = 0; i < len; i++)
+    {
+        if ((reg_addr[i] != (BME68X_REG_CTRL_GAS_0 + 3)) &&
+            (dev->shadow.reg[reg_addr[i] - BME68X_REG_CTRL_GAS_0] != reg_data[i]))
+        {
+            changed_addr[n_changed] = reg_addr[i];
+            changed_data[n_changed] = reg_data[i];
+            n_changed++;
+        }
+    }
+
+    if (n_changed > 0)
+    {
+        rslt = bme68x_set_regs(changed_addr, changed_data, n_changed, dev);
+    }
+
+    return rslt;
+}
+
 /* This internal API is used to set heater configurations */
 static int8_t set_conf(const struct bme68x_heatr_conf *conf, uint8_t op_mode, uint8_t *nb_conv, struct bme68x_dev *dev)
 {
@@ -1585,7 +2058,7 @@ static uint8_t calc_heatr_dur_shared(uint16_t dur)
 }
 
 /* This internal API is used sort the sensor data */
-static void sort_sensor_data(uint8_t low_index, uint8_t high_index, struct bme68x_data *field[])
+static void sort_sensor_data(uint8_t low_index, uint8_t high_index, struct bme68x_raw_data *field[])
 {
     int16_t meas_index1;
     int16_t meas_index2;
@@ -1708,9 +2181,9 @@ static void sort_sensor_data(uint8_t low_index, uint8_t high_index, struct bme68
 }
 
 /* This internal API is used sort the sensor data */
-static void swap_fields(uint8_t index1, uint8_t index2, struct bme68x_data *field[])
+static void swap_fields(uint8_t index1, uint8_t index2, struct bme68x_raw_data *field[])
 {
-    struct bme68x_data *temp;
+    struct bme68x_raw_data *temp;
 
     temp = field[index1];
     field[index1] = field[index2];
@@ -1771,6 +2244,20 @@ static int8_t get_calib_data(struct bme68x_dev *dev)
     int8_t rslt;
     uint8_t coeff_array[BME68X_LEN_COEFF_ALL];
 
+    rslt = read_calib_regs(coeff_array, dev);
+    if (rslt == BME68X_OK)
+    {
+        parse_calib_data(coeff_array, &dev->calib);
+    }
+
+    return rslt;
+}
+
+/* This internal API is used to read the calibration coefficient registers */
+static int8_t read_calib_regs(uint8_t *coeff_array, struct bme68x_dev *dev)
+{
+    int8_t rslt;
+
     rslt = bme68x_get_regs(BME68X_REG_COEFF1, coeff_array, BME68X_LEN_COEFF1, dev);
     if (rslt == BME68X_OK)
     {
@@ -1785,60 +2272,63 @@ static int8_t get_calib_data(struct bme68x_dev *dev)
                                dev);
     }
 
-    if (rslt == BME68X_OK)
-    {
-        /* Temperature related coefficients */
-        dev->calib.par_t1 =
-            (uint16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_T1_MSB], coeff_array[BME68X_IDX_T1_LSB]));
-        dev->calib.par_t2 =
-            (int16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_T2_MSB], coeff_array[BME68X_IDX_T2_LSB]));
-        dev->calib.par_t3 = (int8_t)(coeff_array[BME68X_IDX_T3]);
-
-        /* Pressure related coefficients */
-        dev->calib.par_p1 =
-            (uint16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_P1_MSB], coeff_array[BME68X_IDX_P1_LSB]));
-        dev->calib.par_p2 =
-            (int16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_P2_MSB], coeff_array[BME68X_IDX_P2_LSB]));
-        dev->calib.par_p3 = (int8_t)coeff_array[BME68X_IDX_P3];
-        dev->calib.par_p4 =
-            (int16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_P4_MSB], coeff_array[BME68X_IDX_P4_LSB]));
-        dev->calib.par_p5 =
-            (int16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_P5_MSB], coeff_array[BME68X_IDX_P5_LSB]));
-        dev->calib.par_p6 = (int8_t)(coeff_array[BME68X_IDX_P6]);
-        dev->calib.par_p7 = (int8_t)(coeff_array[BME68X_IDX_P7]);
-        dev->calib.par_p8 =
-            (int16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_P8_MSB], coeff_array[BME68X_IDX_P8_LSB]));
-        dev->calib.par_p9 =
-            (int16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_P9_MSB], coeff_array[BME68X_IDX_P9_LSB]));
-        dev->calib.par_p10 = (uint8_t)(coeff_array[BME68X_IDX_P10]);
-
-        /* Humidity related coefficients */
-        dev->calib.par_h1 =
-            (uint16_t)(((uint16_t)coeff_array[BME68X_IDX_H1_MSB] << 4) |
-                       (coeff_array[BME68X_IDX_H1_LSB] & BME68X_BIT_H1_DATA_MSK));
-        dev->calib.par_h2 =
-            (uint16_t)(((uint16_t)coeff_array[BME68X_IDX_H2_MSB] << 4) | ((coeff_array[BME68X_IDX_H2_LSB]) >> 4));
-        dev->calib.par_h3 = (int8_t)coeff_array[BME68X_IDX_H3];
-        dev->calib.par_h4 = (int8_t)coeff_array[BME68X_IDX_H4];
-        dev->calib.par_h5 = (int8_t)coeff_array[BME68X_IDX_H5];
-        dev->calib.par_h6 = (uint8_t)coeff_array[BME68X_IDX_H6];
-        dev->calib.par_h7 = (int8_t)coeff_array[BME68X_IDX_H7];
-
-        /* Gas heater related coefficients */
-        dev->calib.par_gh1 = (int8_t)coeff_array[BME68X_IDX_GH1];
-        dev->calib.par_gh2 =
-            (int16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_GH2_MSB], coeff_array[BME68X_IDX_GH2_LSB]));
-        dev->calib.par_gh3 = (int8_t)coeff_array[BME68X_IDX_GH3];
-
-        /* Other coefficients */
-        dev->calib.res_heat_range = ((coeff_array[BME68X_IDX_RES_HEAT_RANGE] & BME68X_RHRANGE_MSK) / 16);
-        dev->calib.res_heat_val = (int8_t)coeff_array[BME68X_IDX_RES_HEAT_VAL];
-        dev->calib.range_sw_err = ((int8_t)(coeff_array[BME68X_IDX_RANGE_SW_ERR] & BME68X_RSERROR_MSK)) / 16;
-    }
-
     return rslt;
 }
 
+/* This internal API is used to parse the calibration coefficient registers */
+static void parse_calib_data(const uint8_t *coeff_array, struct bme68x_calib_data *calib)
+{
+    /* Temperature related coefficients */
+    calib->par_t1 =
+        (uint16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_T1_MSB], coeff_array[BME68X_IDX_T1_LSB]));
+    calib->par_t2 =
+        (int16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_T2_MSB], coeff_array[BME68X_IDX_T2_LSB]));
+    calib->par_t3 = (int8_t)(coeff_array[BME68X_IDX_T3]);
+
+    /* Pressure related coefficients */
+    calib->par_p1 =
+        (uint16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_P1_MSB], coeff_array[BME68X_IDX_P1_LSB]));
+    calib->par_p2 =
+        (int16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_P2_MSB], coeff_array[BME68X_IDX_P2_LSB]));
+    calib->par_p3 = (int8_t)coeff_array[BME68X_IDX_P3];
+    calib->par_p4 =
+        (int16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_P4_MSB], coeff_array[BME68X_IDX_P4_LSB]));
+    calib->par_p5 =
+        (int16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_P5_MSB], coeff_array[BME68X_IDX_P5_LSB]));
+    calib->par_p6 = (int8_t)(coeff_array[BME68X_IDX_P6]);
+    calib->par_p7 = (int8_t)(coeff_array[BME68X_IDX_P7]);
+    calib->par_p8 =
+        (int16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_P8_MSB], coeff_array[BME68X_IDX_P8_LSB]));
+    calib->par_p9 =
+        (int16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_P9_MSB], coeff_array[BME68X_IDX_P9_LSB]));
+    calib->par_p10 = (uint8_t)(coeff_array[BME68X_IDX_P10]);
+
+    /* Humidity related coefficients */
+    calib->par_h1 =
+        (uint16_t)(((uint16_t)coeff_array[BME68X_IDX_H1_MSB] << 4) |
+                   (coeff_array[BME68X_IDX_H1_LSB] & BME68X_BIT_H1_DATA_MSK));
+    calib->par_h2 =
+        (uint16_t)(((uint16_t)coeff_array[BME68X_IDX_H2_MSB] << 4) | ((coeff_array[BME68X_IDX_H2_LSB]) >> 4));
+    calib->par_h3 = (int8_t)coeff_array[BME68X_IDX_H3];
+    calib->par_h4 = (int8_t)coeff_array[BME68X_IDX_H4];
+    calib->par_h5 = (int8_t)coeff_array[BME68X_IDX_H5];
+    calib->par_h6 = (uint8_t)coeff_array[BME68X_IDX_H6];
+    calib->par_h7 = (int8_t)coeff_array[BME68X_IDX_H7];
+
+    /* Gas heater related coefficients */
+    calib->par_gh1 = (int8_t)coeff_array[BME68X_IDX_GH1];
+    calib->par_gh2 =
+        (int16_t)(BME68X_CONCAT_BYTES(coeff_array[BME68X_IDX_GH2_MSB], coeff_array[BME68X_IDX_GH2_LSB]));
+    calib->par_gh3 = (int8_t)coeff_array[BME68X_IDX_GH3];
+
+    /* Other coefficients */
+    calib->res_heat_range = ((coeff_array[BME68X_IDX_RES_HEAT_RANGE] & BME68X_RHRANGE_MSK) / 16);
+    calib->res_heat_val = (int8_t)coeff_array[BME68X_IDX_RES_HEAT_VAL];
+    calib->range_sw_err = ((int8_t)(coeff_array[BME68X_IDX_RANGE_SW_ERR] & BME68X_RSERROR_MSK)) / 16;
+
+    (void)bme68x_precompute_calib(calib);
+}
+
 /* This internal API is used to read variant ID information from the register */
 static int8_t read_variant_id(struct bme68x_dev *dev)
 {
@@ -97,6 +97,16 @@
 #define BME68X_PERIOD_POLL                        UINT32_C(10000)
 #endif
 
+/* Number of new data polls of a forced read (value can be given by user) */
+#ifndef BME68X_POLL_TRIES
+#define BME68X_POLL_TRIES                         UINT8_C(5)
+#endif
+
+/* Samples compensated per pass of bme68x_compensate_batch (value can be given by user) */
+#ifndef BME68X_BATCH_CHUNK
+#define BME68X_BATCH_CHUNK                        UINT32_C(32)
+#endif
+
 /* BME68X unique chip identifier */
 #define BME68X_CHIP_ID                            UINT8_C(0x61)
 
@@ -339,6 +349,12 @@
 /* Length of the interleaved buffer */
 #define BME68X_LEN_INTERLEAVE_BUFF                UINT8_C(20)
 
+/* Length of the idac, res_heat and gas_wait register block */
+#define BME68X_LEN_HEATR_SET                      UINT8_C(30)
+
+/* Length of the control register block ctrl_gas_0 (0x70) to config (0x75) */
+#define BME68X_LEN_SHADOW                         UINT8_C(6)
+
 /* Coefficient index macros */
 
 /* Coefficient T2 LSB position */
@@ -765,6 +781,189 @@ struct bme68x_data
 
 };
 
+/*
+ * @brief Uncompensated data of one sensor field
+ */
+struct bme68x_raw_data
+{
+    /*! Contains new_data, gasm_valid & heat_stab */
+    uint8_t status;
+
+    /*! The index of the heater profile used */
+    uint8_t gas_index;
+
+    /*! Measurement index to track order */
+    uint8_t meas_index;
+
+    /*! Gas range of the gas ADC value, for the variant of the sensor */
+    uint8_t gas_range;
+
+    /*! 20-bit temperature ADC value */
+    uint32_t temp_adc;
+
+    /*! 20-bit pressure ADC value */
+    uint32_t pres_adc;
+
+    /*! 16-bit humidity ADC value */
+    uint16_t hum_adc;
+
+    /*! 10-bit gas resistance ADC value, for the variant of the sensor */
+    uint16_t gas_adc;
+};
+
+/*
+ * @brief Raw ADC samples laid out as one array per quantity
+ */
+struct bme68x_raw_batch
+{
+    /*! Number of samples held by each array */
+    uint32_t len;
+
+    /*! 20-bit temperature ADC values */
+    const uint32_t *temp_adc;
+
+    /*! 20-bit pressure ADC values */
+    const uint32_t *pres_adc;
+
+    /*! 16-bit humidity ADC values */
+    const uint16_t *hum_adc;
+
+    /*! 10-bit gas resistance ADC values, NULL to skip gas compensation */
+    const uint16_t *gas_adc;
+
+    /*! 4-bit gas range values, required when gas_adc is set */
+    const uint8_t *gas_range;
+};
+
+/*
+ * @brief Compensated samples laid out as one array per quantity
+ *
+ * Units match the corresponding members of struct bme68x_data.
+ */
+struct bme68x_comp_batch
+{
+#ifndef BME68X_USE_FPU
+
+    /*! Temperature in degree celsius x100 */
+    int16_t *temperature;
+
+    /*! Pressure in Pascal */
+    uint32_t *pressure;
+
+    /*! Humidity in % relative humidity x1000 */
+    uint32_t *humidity;
+
+    /*! Gas resistance in Ohms, may be NULL when no gas data is given */
+    uint32_t *gas_resistance;
+#else
+
+    /*! Temperature in degree celsius */
+    float *temperature;
+
+    /*! Pressure in Pascal */
+    float *pressure;
+
+    /*! Humidity in % relative humidity */
+    float *humidity;
+
+    /*! Gas resistance in Ohms, may be NULL when no gas data is given */
+    float *gas_resistance;
+#endif
+};
+
+/*
+ * @brief Compensation coefficients derived from the calibration coefficients
+ * once by bme68x_precompute_calib, so that the compensation of a sample does
+ * not convert and scale the par_* values again
+ */
+struct bme68x_comp_coeffs
+{
+#ifndef BME68X_USE_FPU
+
+    /*! par_t1 << 1 */
+    int32_t t_off;
+
+    /*! par_t3 << 4 */
+    int32_t t_quad;
+
+    /*! par_p3 << 5 */
+    int32_t p_sens2;
+
+    /*! par_p4 << 16 */
+    int32_t p_off0;
+
+    /*! par_p7 << 7 */
+    int32_t p_off;
+
+    /*! par_h1 * 16 */
+    int32_t h_off;
+
+    /*! par_h6 << 7 */
+    int32_t h_quad0;
+#else
+
+    /*! par_t1 * 16, subtracted from the temperature ADC value */
+    float t_off;
+
+    /*! Linear temperature term, par_t2 / 2^14 */
+    float t_lin;
+
+    /*! Quadratic temperature term, par_t3 / 2^30 */
+    float t_quad;
+
+    /*! Pressure offset in t_fine / 2 - 64000, constant term */
+    float p_off0;
+
+    /*! Pressure offset, linear term */
+    float p_off1;
+
+    /*! Pressure offset, quadratic term */
+    float p_off2;
+
+    /*! Pressure sensitivity in t_fine / 2 - 64000, constant term */
+    float p_sens0;
+
+    /*! Pressure sensitivity, linear term */
+    float p_sens1;
+
+    /*! Pressure sensitivity, quadratic term */
+    float p_sens2;
+
+    /*! Pressure linearization in the uncorrected pressure, constant term */
+    float p_off;
+
+    /*! Pressure linearization, linear term */
+    float p_lin;
+
+    /*! Pressure linearization, quadratic term */
+    float p_quad;
+
+    /*! Pressure linearization, cubic term */
+    float p_cub;
+
+    /*! par_h1 * 16, subtracted from the humidity ADC value */
+    float h_off;
+
+    /*! Temperature dependence of the humidity offset, par_h3 / 2 */
+    float h_temp;
+
+    /*! Humidity gain in the temperature, constant term */
+    float h_gain0;
+
+    /*! Humidity gain, linear term */
+    float h_gain1;
+
+    /*! Humidity gain, quadratic term */
+    float h_gain2;
+
+    /*! Humidity linearization in the temperature, constant term */
+    float h_quad0;
+
+    /*! Humidity linearization, linear term */
+    float h_quad1;
+#endif
+};
+
 /*
  * @brief Structure to hold the calibration coefficients
  */
@@ -856,6 +1055,9 @@ struct bme68x_calib_data
 
     /*! Gas resistance range switching error coefficient */
     int8_t range_sw_err;
+
+    /*! Coefficients of the compensation routines, see bme68x_precompute_calib */
+    struct bme68x_comp_coeffs comp;
 };
 
 /*
@@ -913,6 +1115,51 @@ struct bme68x_heatr_conf
     uint16_t shared_heatr_dur;
 };
 
+/*
+ * @brief BME68X interface traffic counters
+ */
+struct bme68x_intf_stats
+{
+    /*! Number of read and write transactions issued to the sensor */
+    uint32_t transactions;
+
+    /*! Number of bytes transferred, register address bytes included */
+    uint32_t bytes;
+
+    /*! Number of SPI memory page register writes, included in transactions */
+    uint32_t page_switches;
+
+    /*! Number of forced field reads that found no new data yet */
+    uint32_t data_polls;
+};
+
+/*
+ * @brief Copy of the idac, res_heat and gas_wait registers of all heater steps
+ */
+struct bme68x_heatr_cache
+{
+    /*! Non-zero while set_val mirrors the sensor registers */
+    uint8_t valid;
+
+    /*! idac (0..9), res_heat (10..19) and gas_wait (20..29) register values */
+    uint8_t set_val[BME68X_LEN_HEATR_SET];
+};
+
+/*
+ * @brief Shadow copy of the control registers ctrl_gas_0 (0x70) to config (0x75)
+ */
+struct bme68x_shadow
+{
+    /*! Set by the user before bme68x_init to let the driver use the copy */
+    uint8_t enable;
+
+    /*! Non-zero while reg mirrors the sensor registers */
+    uint8_t valid;
+
+    /*! ctrl_gas_0, ctrl_gas_1, ctrl_hum, (0x73), ctrl_meas and config values */
+    uint8_t reg[BME68X_LEN_SHADOW];
+};
+
 /*
  * @brief BME68X device structure
  */
@@ -946,6 +1193,12 @@ struct bme68x_dev
     /*! Memory page used */
     uint8_t mem_page;
 
+    /*! Last value of the SPI memory page register, read or written */
+    uint8_t mem_page_reg;
+
+    /*! Non-zero while mem_page and mem_page_reg match the sensor */
+    uint8_t mem_page_known;
+
     /*! Ambient temperature in Degree C*/
     int8_t amb_temp;
 
@@ -961,11 +1214,26 @@ struct bme68x_dev
     /*! Delay function pointer */
     bme68x_delay_us_fptr_t delay_us;
 
+    /*! Delay between new data polls of a forced read in microseconds, 0 for BME68X_PERIOD_POLL */
+    uint32_t poll_period_us;
+
+    /*! Number of new data polls of a forced read, 0 for BME68X_POLL_TRIES */
+    uint8_t poll_tries;
+
     /*! To store interface pointer error */
     BME68X_INTF_RET_TYPE intf_rslt;
 
     /*! Store the info messages */
     uint8_t info_msg;
+
+    /*! Heater registers cached for the data read out */
+    struct bme68x_heatr_cache heatr_cache;
+
+    /*! Last known control register values, if enabled */
+    struct bme68x_shadow shadow;
+
+    /*! Interface traffic counters */
+    struct bme68x_intf_stats intf_stats;
 };
 
 #endif /* BME68X_DEFS_H_ */
@@ -16,14 +16,30 @@ extern "C" void button_task(void* pvParameters) {
 extern "C" void bme688_task(void* pvParameters) {
     BME688 sensor;
     while (true) {
-        float temp = sensor.read_temperature();
-        float hum = sensor.read_humidity();
-        float pres = sensor.read_pressure();
-        float gas_res = sensor.read_gas_resistance();
-        printf("[BME688] Temperature: %.2f°C\n", temp);
-        printf("[BME688] Humidity: %.2f %%\n", hum);
-        printf("[BME688] Pressure: %.2f hPa\n", pres / 100.0f);
-        printf("[BME688] Gas Resistance: %.2f Ohms\n", gas_res);
+        uint32_t i2c_before = sensor.i2c_transactions();
+        BME688Reading r = sensor.read_all();
+        if (r.valid) {
+            printf("[BME688] Temperature: %.2f°C\n", r.temperature);
+            printf("[BME688] Humidity: %.2f %%\n", r.humidity);
+            printf("[BME688] Pressure: %.2f hPa\n", r.pressure / 100.0f);
+            printf("[BME688] Gas Resistance: %.2f Ohms\n", r.gas_resistance);
+        } else {
+            printf("[BME688] Measurement failed\n");
+        }
+        printf("[BME688] I2C transactions for this sample: %lu\n",
+               (unsigned long)(sensor.i2c_transactions() - i2c_before));
+
+        // The same four values through the getters, each measuring on its own
+        // as they did before the shared snapshot.
+        sensor.set_max_age_ms(0);
+        i2c_before = sensor.i2c_transactions();
+        sensor.read_temperature();
+        sensor.read_humidity();
+        sensor.read_pressure();
+        sensor.read_gas_resistance();
+        sensor.set_max_age_ms(1000);
+        printf("[BME688] I2C transactions through the four getters: %lu\n",
+               (unsigned long)(sensor.i2c_transactions() - i2c_before));
         vTaskDelay(2000 / portTICK_PERIOD_MS);
     }
 }
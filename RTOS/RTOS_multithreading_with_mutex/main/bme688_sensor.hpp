@@ -3,20 +3,42 @@
 #include "bme68x_defs.h"
 #include "driver/i2c.h"
 #include "esp_rom_sys.h"
+#include "esp_timer.h"
+
+// One forced measurement; all four values come from the same heater cycle.
+struct BME688Reading {
+    float temperature;      // degC
+    float humidity;         // %
+    float pressure;         // Pa
+    float gas_resistance;   // Ohms
+    int64_t timestamp_us;   // esp_timer time of the measurement
+    bool valid;
+};
 
 class BME688 {
 public:
     BME688();
+    // Triggers one measurement and returns every value from it.
+    BME688Reading read_all();
+    // Returns the cached reading, measuring again only once it is older than the max age
+    // (0 measures on every call). Invalid if that measurement fails.
+    const BME688Reading& snapshot();
+    void set_max_age_ms(uint32_t ms) { max_age_ms = ms; }
     float read_gas_resistance();
     float read_temperature();
     float read_humidity();
     float read_pressure();
+    // Number of I2C transactions issued since construction.
+    uint32_t i2c_transactions() const { return i2c_count; }
 private:
     struct bme68x_dev dev;
     struct bme68x_conf conf;
     struct bme68x_heatr_conf heatr_conf;
     uint8_t dev_addr;
     bool ok = false;
+    BME688Reading cached = {};
+    uint32_t max_age_ms = 1000;
+    uint32_t i2c_count = 0;
     static int8_t bme68x_i2c_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr);
     static int8_t bme68x_i2c_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr);
     static void bme68x_delay_us(uint32_t period, void *intf_ptr);
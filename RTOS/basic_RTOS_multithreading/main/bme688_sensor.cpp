@@ -1,4 +1,5 @@
 #include "bme688_sensor.hpp"
+#include "bme688_static_conf.h"
 
 #define I2C_MASTER_NUM I2C_NUM_0
 #define I2C_MASTER_SCL_IO 22
@@ -6,6 +7,9 @@
 #define I2C_MASTER_FREQ_HZ 100000
 #define BME68X_ADDR 0x77
 
+// Compile-time sensor settings; pick another BME688StaticConf<> to change them.
+typedef BME688DefaultConf SensorConf;
+
 BME688::BME688() {
     i2c_config_t i2c_conf;
     i2c_conf.mode = I2C_MODE_MASTER;
@@ -24,7 +28,11 @@ BME688::BME688() {
     dev.read = bme68x_i2c_read;
     dev.write = bme68x_i2c_write;
     dev.delay_us = bme68x_delay_us;
-    dev.intf_ptr = &dev_addr;
+    dev.intf_ptr = this;
+    // The tick-based wait below can end just before the data is ready;
+    // poll it again 1 ms later instead of 10 ms (same 50 ms budget).
+    dev.poll_period_us = 1000;
+    dev.poll_tries = 50;
 
     int8_t rslt = bme68x_init(&dev);
     if (rslt != BME68X_OK) {
@@ -32,20 +40,14 @@ BME688::BME688() {
         return;
     }
 
-    conf.os_hum = BME68X_OS_2X;
-    conf.os_pres = BME68X_OS_4X;
-    conf.os_temp = BME68X_OS_8X;
-    conf.filter = BME68X_FILTER_OFF;
-    conf.odr = BME68X_ODR_NONE;
+    conf = SensorConf::conf();
     rslt = bme68x_set_conf(&conf, &dev);
     if (rslt != BME68X_OK) {
         ok = false;
         return;
     }
 
-    heatr_conf.enable = BME68X_ENABLE;
-    heatr_conf.heatr_temp = 300;
-    heatr_conf.heatr_dur = 100;
+    heatr_conf = SensorConf::heatr_conf();
     rslt = bme68x_set_heatr_conf(BME68X_FORCED_MODE, &heatr_conf, &dev);
     if (rslt != BME68X_OK) {
         ok = false;
@@ -55,68 +57,63 @@ BME688::BME688() {
 }
 
 
-float BME688::read_gas_resistance() {
-    if (!ok) return -1.0f;
-    int8_t rslt = bme68x_set_op_mode(BME68X_FORCED_MODE, &dev);
-    if (rslt != BME68X_OK) return -1.0f;
-    uint32_t del_period = bme68x_get_meas_dur(BME68X_FORCED_MODE, &conf, &dev) / 1000 + heatr_conf.heatr_dur;
+BME688Reading BME688::read_all() {
+    BME688Reading reading = {};
+    if (!ok) return reading;
+    int8_t rslt = SensorConf::trigger_forced(&dev);
+    if (rslt != BME68X_OK) return reading;
+    uint32_t del_period = SensorConf::forced_period_us / 1000;
     vTaskDelay(del_period / portTICK_PERIOD_MS + 1);
     struct bme68x_data data;
     uint8_t n_fields;
     rslt = bme68x_get_data(BME68X_FORCED_MODE, &data, &n_fields, &dev);
     if (rslt == BME68X_OK && n_fields > 0) {
-        return data.gas_resistance;
+        reading.temperature = data.temperature;
+        reading.humidity = data.humidity;
+        reading.pressure = data.pressure;
+        reading.gas_resistance = data.gas_resistance;
+        reading.timestamp_us = esp_timer_get_time();
+        reading.valid = true;
+        cached = reading;
     }
-    return -1.0f;
+    return reading;
 }
 
-float BME688::read_temperature() {
-    if (!ok) return -1.0f;
-    int8_t rslt = bme68x_set_op_mode(BME68X_FORCED_MODE, &dev);
-    if (rslt != BME68X_OK) return -1.0f;
-    uint32_t del_period = bme68x_get_meas_dur(BME68X_FORCED_MODE, &conf, &dev) / 1000 + heatr_conf.heatr_dur;
-    vTaskDelay(del_period / portTICK_PERIOD_MS + 1);
-    struct bme68x_data data;
-    uint8_t n_fields;
-    rslt = bme68x_get_data(BME68X_FORCED_MODE, &data, &n_fields, &dev);
-    if (rslt == BME68X_OK && n_fields > 0) {
-        return data.temperature;
+const BME688Reading& BME688::snapshot() {
+    int64_t age_us = esp_timer_get_time() - cached.timestamp_us;
+    if (max_age_ms == 0 || !cached.valid || age_us > (int64_t)max_age_ms * 1000) {
+        // A failed read must not leave the stale reading looking fresh
+        if (!read_all().valid) {
+            cached.valid = false;
+        }
     }
-    return -1.0f;
+    return cached;
+}
+
+float BME688::read_gas_resistance() {
+    const BME688Reading& r = snapshot();
+    return r.valid ? r.gas_resistance : -1.0f;
+}
+
+float BME688::read_temperature() {
+    const BME688Reading& r = snapshot();
+    return r.valid ? r.temperature : -1.0f;
 }
 
 float BME688::read_humidity() {
-    if (!ok) return -1.0f;
-    int8_t rslt = bme68x_set_op_mode(BME68X_FORCED_MODE, &dev);
-    if (rslt != BME68X_OK) return -1.0f;
-    uint32_t del_period = bme68x_get_meas_dur(BME68X_FORCED_MODE, &conf, &dev) / 1000 + heatr_conf.heatr_dur;
-    vTaskDelay(del_period / portTICK_PERIOD_MS + 1);
-    struct bme68x_data data;
-    uint8_t n_fields;
-    rslt = bme68x_get_data(BME68X_FORCED_MODE, &data, &n_fields, &dev);
-    if (rslt == BME68X_OK && n_fields > 0) {
-        return data.humidity;
-    }
-    return -1.0f;
+    const BME688Reading& r = snapshot();
+    return r.valid ? r.humidity : -1.0f;
 }
 
 float BME688::read_pressure() {
-    if (!ok) return -1.0f;
-    int8_t rslt = bme68x_set_op_mode(BME68X_FORCED_MODE, &dev);
-    if (rslt != BME68X_OK) return -1.0f;
-    uint32_t del_period = bme68x_get_meas_dur(BME68X_FORCED_MODE, &conf, &dev) / 1000 + heatr_conf.heatr_dur;
-    vTaskDelay(del_period / portTICK_PERIOD_MS + 1);
-    struct bme68x_data data;
-    uint8_t n_fields;
-    rslt = bme68x_get_data(BME68X_FORCED_MODE, &data, &n_fields, &dev);
-    if (rslt == BME68X_OK && n_fields > 0) {
-        return data.pressure;
-    }
-    return -1.0f;
+    const BME688Reading& r = snapshot();
+    return r.valid ? r.pressure : -1.0f;
 }
 
 int8_t BME688::bme68x_i2c_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr) {
-    uint8_t dev_addr = *(uint8_t *)intf_ptr;
+    BME688 *self = static_cast<BME688 *>(intf_ptr);
+    uint8_t dev_addr = self->dev_addr;
+    self->i2c_count++;
     i2c_cmd_handle_t cmd = i2c_cmd_link_create();
     i2c_master_start(cmd);
     i2c_master_write_byte(cmd, (dev_addr << 1) | I2C_MASTER_WRITE, true);
@@ -134,7 +131,9 @@ int8_t BME688::bme68x_i2c_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len
 }
 
 int8_t BME688::bme68x_i2c_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr) {
-    uint8_t dev_addr = *(uint8_t *)intf_ptr;
+    BME688 *self = static_cast<BME688 *>(intf_ptr);
+    uint8_t dev_addr = self->dev_addr;
+    self->i2c_count++;
     i2c_cmd_handle_t cmd = i2c_cmd_link_create();
     i2c_master_start(cmd);
     i2c_master_write_byte(cmd, (dev_addr << 1) | I2C_MASTER_WRITE, true);
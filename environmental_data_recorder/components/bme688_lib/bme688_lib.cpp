@@ -1,48 +1,238 @@
 #include "bme688_lib.h"
+#include <stddef.h>
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "esp32/rom/ets_sys.h"
+#include "esp_rom_sys.h"
+#include "esp_attr.h"
+#include "esp_rom_crc.h"
 
 // Define a local tag for logging purposes within this source file.
 static const char *TAG = "BME688_LIB";
 
+// Calibration registers of the sensors brought up, one slot per bus position.
+// RTC slow memory keeps them across deep sleep, so a warm boot can skip the
+// soft reset and the calibration register dump in bme68x_init().
+struct BME688CalibCache {
+    uint32_t magic;
+    uint8_t chip_id;
+    uint8_t intf;           // BME688Interface
+    uint8_t dev_addr;       // I2C address, or SPI chip select pin
+    uint8_t variant_id;
+    uint8_t port;           // I2C port, or SPI host
+    int8_t mux_channel;
+    uint8_t coeff[BME68X_LEN_COEFF_ALL];
+    uint32_t crc;
+};
+
+#define BME688_CALIB_CACHE_MAGIC 0x42363838 // "B688"
+
+// Notification bits of the readout task
+#define BME688_MEAS_NOTIFY_READY (1u << 0)   // the measurement timer fired
+#define BME688_MEAS_NOTIFY_EXIT (1u << 1)
+
+static RTC_DATA_ATTR BME688CalibCache calib_cache[BME688_CALIB_CACHE_SLOTS];
+
+static uint32_t calib_cache_crc(const BME688CalibCache &cache) {
+    return esp_rom_crc32_le(0, reinterpret_cast<const uint8_t *>(&cache), offsetof(BME688CalibCache, crc));
+}
+
+static bool calib_cache_valid(const BME688CalibCache &cache) {
+    return cache.magic == BME688_CALIB_CACHE_MAGIC && cache.crc == calib_cache_crc(cache);
+}
+
+// Fills in the bus position fields of a cache slot.
+static void calib_cache_position(const BME688Link &link, BME688CalibCache &cache) {
+    cache.intf = (uint8_t)link.intf;
+    if (link.intf == BME688_INTF_SPI) {
+        cache.dev_addr = (uint8_t)link.cs_io;
+        cache.port = (uint8_t)link.spi_host;
+        cache.mux_channel = -1;
+    } else {
+        cache.dev_addr = link.addr;
+        cache.port = (uint8_t)link.port;
+        cache.mux_channel = link.mux_channel;
+    }
+}
+
+static bool calib_cache_same_position(const BME688CalibCache &a, const BME688CalibCache &b) {
+    return a.intf == b.intf && a.dev_addr == b.dev_addr && a.port == b.port && a.mux_channel == b.mux_channel;
+}
+
+// Returns the valid slot for this bus position, or nullptr.
+static const BME688CalibCache *calib_cache_find(const BME688Link &link) {
+    BME688CalibCache key = {};
+    calib_cache_position(link, key);
+    for (int i = 0; i < BME688_CALIB_CACHE_SLOTS; i++) {
+        const BME688CalibCache &cache = calib_cache[i];
+        if (calib_cache_valid(cache) && calib_cache_same_position(cache, key)) {
+            return &cache;
+        }
+    }
+    return nullptr;
+}
+
+void BME688::clear_calibration_cache() {
+    memset(calib_cache, 0, sizeof(calib_cache));
+}
+
+template <class Conf>
+static constexpr BME688ModeSettings mode_settings() {
+    BME688ModeSettings m = {};
+    m.conf = Conf::conf();
+    m.heatr_conf = Conf::heatr_conf();
+    m.forced_meas_us = Conf::forced_meas_dur_us;
+    m.forced_period_us = Conf::forced_period_us;
+    m.parallel_meas_us = Conf::meas_dur_us(BME68X_PARALLEL_MODE);
+    m.sequential_meas_us = Conf::meas_dur_us(BME68X_SEQUENTIAL_MODE);
+    m.ctrl_meas_forced = Conf::ctrl_meas_forced;
+    m.gas_enabled = Conf::gas_enabled;
+    return m;
+}
+
+// Indexed by BME688Mode; constant-initialized, so usable from static constructors.
+static constexpr BME688ModeSettings mode_table[] = {
+    mode_settings<BME688SensorConf>(),
+    mode_settings<BME688LowLatencyConf>(),
+    mode_settings<BME688PrecisionConf>(),
+};
+
+// Multiplexer state shared by the BME688 instances on an I2C port. The bus
+// itself belongs to i2c_bus_lib.
+struct BME688Bus {
+    int users;
+    SemaphoreHandle_t lock;     // held for a mux select plus the transaction behind it
+    int8_t mux_channel;         // channel the multiplexer was last switched to, -1 if unknown
+};
+
+static BME688Bus buses[I2C_NUM_MAX];
+
+bool BME688::acquire_bus(const BME688Config &config) {
+    if (config.port < 0 || config.port >= I2C_NUM_MAX) {
+        ESP_LOGE(TAG, "Invalid I2C port %d", (int)config.port);
+        return false;
+    }
+    BME688Bus &bus = buses[config.port];
+    if (bus.users > 0) {
+        bus.users++;
+        return true;
+    }
+    bus.lock = xSemaphoreCreateMutex();
+    if (bus.lock == nullptr) {
+        return false;
+    }
+    bus.mux_channel = -1;
+    bus.users = 1;
+    return true;
+}
+
+void BME688::release_bus(i2c_port_t port) {
+    BME688Bus &bus = buses[port];
+    if (bus.users == 0 || --bus.users > 0) return;
+    vSemaphoreDelete(bus.lock);
+    bus.lock = nullptr;
+}
+
+// Takes the port for one transaction and routes the multiplexer to the sensor.
+bool BME688::lock_bus(BME688Link &link) {
+    BME688Bus &bus = buses[link.port];
+    xSemaphoreTake(bus.lock, portMAX_DELAY);
+    if (link.mux_channel < 0 || bus.mux_channel == link.mux_channel) {
+        return true;
+    }
+
+    uint8_t select = (uint8_t)(1u << link.mux_channel);
+    esp_err_t ret = link.mux.write(&select, 1);
+    if (ret != ESP_OK) {
+        bus.mux_channel = -1;
+        xSemaphoreGive(bus.lock);
+        return false;
+    }
+    bus.mux_channel = link.mux_channel;
+    return true;
+}
+
+void BME688::unlock_bus(const BME688Link &link) {
+    xSemaphoreGive(buses[link.port].lock);
+}
+
 // Constructor implementation.
-BME688::BME688() {
-    // Configure and install the I2C driver.
-    i2c_config_t i2c_conf;
-    i2c_conf.mode = I2C_MODE_MASTER;
-    i2c_conf.sda_io_num = I2C_MASTER_SDA_IO;
-    i2c_conf.scl_io_num = I2C_MASTER_SCL_IO;
-    i2c_conf.sda_pullup_en = GPIO_PULLUP_ENABLE;
-    i2c_conf.scl_pullup_en = GPIO_PULLUP_ENABLE;
-    i2c_conf.master.clk_speed = I2C_MASTER_FREQ_HZ;
-    i2c_param_config(I2C_MASTER_NUM, &i2c_conf);
-    i2c_driver_install(I2C_MASTER_NUM, i2c_conf.mode, 0, 0, 0);
+BME688::BME688() : BME688(BME688Config()) {
+}
+
+BME688::BME688(const BME688Config &config) : settings(&mode_table[BME688_MODE_DEFAULT]) {
+    link.owner = this;
+    link.intf = config.intf;
+    link.port = config.port;
+    link.addr = config.addr;
+    link.mux_channel = config.intf == BME688_INTF_SPI ? -1 : config.mux_channel;
+    link.mux_addr = config.mux_addr;
+    link.spi_host = config.spi_host;
+    link.cs_io = config.cs_io;
+    link.spi = nullptr;
+    link.spi_bus_owner = false;
+
+    bool opened = config.intf == BME688_INTF_SPI ? open_spi(config) : open_i2c(config);
+    if (!opened) {
+        ok = false;
+        return;
+    }
 
     // Initialize the BME68x sensor device structure.
-    dev_addr = BME68X_ADDR;
     dev = {};
-    dev.intf = BME68X_I2C_INTF;
-    dev.read = bme68x_i2c_read;
-    dev.write = bme68x_i2c_write;
+    if (link.intf == BME688_INTF_SPI) {
+        dev.intf = BME68X_SPI_INTF;
+        dev.read = bme68x_spi_read;
+        dev.write = bme68x_spi_write;
+    } else {
+        dev.intf = BME68X_I2C_INTF;
+        dev.read = bme68x_i2c_read;
+        dev.write = bme68x_i2c_write;
+    }
     dev.delay_us = bme68x_delay_us;
-    dev.intf_ptr = &dev_addr;
+    dev.intf_ptr = &link;
 
-    // Initialize the BME68x sensor.
-    int8_t rslt = bme68x_init(&dev);
-    if (rslt != BME68X_OK) {
-        ESP_LOGE(TAG, "BME68x initialization failed: %d", rslt);
+    // One-shot timer that wakes blocking forced reads and the driver's delays,
+    // created first so the soft reset in bme68x_init() already sleeps on it.
+    esp_timer_create_args_t timer_args = {};
+    timer_args.callback = wake_timer_cb;
+    timer_args.arg = this;
+    timer_args.dispatch_method = ESP_TIMER_TASK;
+    timer_args.name = "bme688_wake";
+    wake_sem = xSemaphoreCreateBinary();
+    if (wake_sem == nullptr || esp_timer_create(&timer_args, &wake_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Creating the wake-up timer failed");
         ok = false;
         return;
     }
+    // Let the driver track the control registers instead of re-reading and polling them.
+    dev.shadow.enable = 1;
+    set_poll_step_us(config.poll_step_us);
+
+    // Initialize the BME68x sensor. On a warm boot the cached calibration
+    // replaces the soft reset and register dump, leaving one chip-id read.
+    int64_t init_start = esp_timer_get_time();
+    int8_t rslt = BME68X_E_DEV_NOT_FOUND;
+    const BME688CalibCache *cached = calib_cache_find(link);
+    if (cached) {
+        rslt = bme68x_init_with_calib(cached->coeff, cached->variant_id, &dev);
+        warm_start = rslt == BME68X_OK && dev.chip_id == cached->chip_id;
+        if (!warm_start) {
+            ESP_LOGW(TAG, "Calibration cache rejected (%d), doing a full init", rslt);
+        }
+    }
+    if (!warm_start) {
+        rslt = bme68x_init(&dev);
+        if (rslt != BME68X_OK) {
+            ESP_LOGE(TAG, "BME68x initialization failed at 0x%02x: %d", link.addr, rslt);
+            ok = false;
+            return;
+        }
+        save_calibration_cache();
+    }
 
     // Configure sensor oversampling settings.
-    conf.os_hum = BME68X_OS_2X;
-    conf.os_pres = BME68X_OS_4X;
-    conf.os_temp = BME68X_OS_8X;
-    conf.filter = BME68X_FILTER_OFF;
-    conf.odr = BME68X_ODR_NONE;
+    conf = settings->conf;
     rslt = bme68x_set_conf(&conf, &dev);
     if (rslt != BME68X_OK) {
         ESP_LOGE(TAG, "bme68x_set_conf failed: %d", rslt);
@@ -51,98 +241,817 @@ BME688::BME688() {
     }
 
     // Configure the heater profile for gas resistance measurement.
-    heatr_conf.enable = BME68X_ENABLE;
-    heatr_conf.heatr_temp = 300;
-    heatr_conf.heatr_dur = 100;
+    heatr_conf = settings->heatr_conf;
     rslt = bme68x_set_heatr_conf(BME68X_FORCED_MODE, &heatr_conf, &dev);
     if (rslt != BME68X_OK) {
         ESP_LOGE(TAG, "bme68x_set_heatr_conf failed: %d", rslt);
         ok = false;
         return;
     }
+    if (!load_gas_regs()) {
+        ok = false;
+        return;
+    }
+
+    // Forced reads trigger with a single ctrl_meas write, which assumes the
+    // sensor is asleep. A warm boot skips the soft reset, so make sure.
+    rslt = bme68x_set_op_mode(BME68X_SLEEP_MODE, &dev);
+    if (rslt != BME68X_OK) {
+        ESP_LOGE(TAG, "bme68x_set_op_mode (sleep) failed: %d", rslt);
+        ok = false;
+        return;
+    }
+
+    // One-shot timer that ends non-blocking measurements.
+    timer_args.callback = measurement_timer_cb;
+    timer_args.name = "bme688_meas";
+    if (esp_timer_create(&timer_args, &meas_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "esp_timer_create failed");
+        ok = false;
+        return;
+    }
+
+    init_us = esp_timer_get_time() - init_start;
+    ESP_LOGI(TAG, "0x%02x: %s init took %lld us", link.addr, warm_start ? "Warm" : "Cold", init_us);
     ok = true;
 }
 
+// Joins the shared I2C bus at this sensor's own clock.
+bool BME688::open_i2c(const BME688Config &config) {
+    bus_acquired = acquire_bus(config);
+    if (!bus_acquired) {
+        return false;
+    }
+    I2CBusConfig bus_config;
+    bus_config.port = config.port;
+    bus_config.sda_io = config.sda_io;
+    bus_config.scl_io = config.scl_io;
+    esp_err_t err = link.sensor.open(bus_config, config.addr, config.clk_hz);
+    if (err == ESP_OK && config.mux_channel >= 0) {
+        err = link.mux.open(bus_config, config.mux_addr, config.clk_hz);
+    }
+    if (err != ESP_OK) {
+        return false;
+    }
+    // Measurement reads are timer-driven; let them pass queued polling traffic.
+    link.sensor.set_priority(I2C_PRIO_HIGH);
+    link.mux.set_priority(I2C_PRIO_HIGH);
+    // A stuck sensor fails its read in a few ms, and the scheduler moves on to the next one.
+    link.sensor.set_deadline_ms(BME688_I2C_DEADLINE_MS);
+    link.mux.set_deadline_ms(BME688_I2C_DEADLINE_MS);
+    return true;
+}
+
+// Adds the sensor to the SPI host as one more device. The host is normally
+// already up (SDCard::init()); if not, it is initialized here the way
+// SDCard does it, with DMA, so the card can still join it later.
+bool BME688::open_spi(const BME688Config &config) {
+    spi_device_interface_config_t dev_conf = {};
+    dev_conf.address_bits = 8;      // register address, read bit included
+    dev_conf.mode = 0;
+    dev_conf.clock_speed_hz = (int)config.spi_clk_hz;
+    dev_conf.spics_io_num = config.cs_io;
+    dev_conf.queue_size = 1;
+    esp_err_t err = spi_bus_add_device(config.spi_host, &dev_conf, &link.spi);
+    if (err == ESP_ERR_INVALID_STATE) {
+        spi_bus_config_t bus_cfg = {};
+        bus_cfg.mosi_io_num = config.mosi_io;
+        bus_cfg.miso_io_num = config.miso_io;
+        bus_cfg.sclk_io_num = config.sclk_io;
+        bus_cfg.quadwp_io_num = -1;
+        bus_cfg.quadhd_io_num = -1;
+        bus_cfg.max_transfer_sz = 4000;
+        err = spi_bus_initialize(config.spi_host, &bus_cfg, SPI_DMA_CH_AUTO);
+        if (err == ESP_OK) {
+            link.spi_bus_owner = true;
+            err = spi_bus_add_device(config.spi_host, &dev_conf, &link.spi);
+        }
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Adding the sensor (CS %d) to SPI host %d failed: %s", config.cs_io, (int)config.spi_host,
+                 esp_err_to_name(err));
+        link.spi = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// Stores the calibration registers so the next warm boot can skip reading them.
+void BME688::save_calibration_cache() {
+    BME688CalibCache cache;
+    memset(&cache, 0, sizeof(cache));
+    if (bme68x_get_calib_regs(cache.coeff, &dev) != BME68X_OK) {
+        ESP_LOGW(TAG, "Could not read calibration registers for the cache");
+        return;
+    }
+    cache.magic = BME688_CALIB_CACHE_MAGIC;
+    cache.chip_id = dev.chip_id;
+    cache.variant_id = (uint8_t)dev.variant_id;
+    calib_cache_position(link, cache);
+    cache.crc = calib_cache_crc(cache);
+
+    // Reuse this position's slot, else the first free one, else the first slot.
+    int slot = -1;
+    for (int i = 0; i < BME688_CALIB_CACHE_SLOTS; i++) {
+        const BME688CalibCache &c = calib_cache[i];
+        if (!calib_cache_valid(c)) {
+            if (slot < 0) slot = i;
+        } else if (calib_cache_same_position(c, cache)) {
+            slot = i;
+            break;
+        }
+    }
+    calib_cache[slot < 0 ? 0 : slot] = cache;
+}
+
+// Logs how long after boot the first sample was available.
+void BME688::note_first_sample() {
+    if (first_sample_us != 0) return;
+    first_sample_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "First sample %lld us after boot (%s init)", first_sample_us, warm_start ? "warm" : "cold");
+}
+
 // Destructor implementation.
-// Cleans up I2C driver resources.
+// Releases this instance's share of the I2C driver or its SPI device.
 BME688::~BME688() {
-    i2c_driver_delete(I2C_MASTER_NUM);
+    stop_meas_task();
+    // Leaving continuous mode polls through bme68x_delay_us(), which sleeps on
+    // the wake-up timer; do it while the timer still exists.
+    stop_continuous();
+    if (meas_timer) {
+        esp_timer_stop(meas_timer);
+        esp_timer_delete(meas_timer);
+    }
+    if (meas_lock) {
+        vSemaphoreDelete(meas_lock);
+    }
+    if (meas_exited) {
+        vSemaphoreDelete(meas_exited);
+    }
+    if (wake_timer) {
+        esp_timer_stop(wake_timer);
+        esp_timer_delete(wake_timer);
+        wake_timer = nullptr;
+    }
+    if (wake_sem) {
+        vSemaphoreDelete(wake_sem);
+        wake_sem = nullptr;
+    }
+    if (bus_acquired) {
+        release_bus(link.port);
+    }
+    if (link.spi) {
+        spi_bus_remove_device(link.spi);
+        link.spi = nullptr;
+    }
+    if (link.spi_bus_owner && spi_bus_free(link.spi_host) != ESP_OK) {
+        ESP_LOGW(TAG, "SPI host %d still has devices; leaving it initialized", (int)link.spi_host);
+    }
 }
 
 // Reads a measurement from the BME688 sensor.
 bool BME688::read_measurement() {
     if (!ok) return false;
-    
-    // Set the sensor to forced mode to perform a single measurement.
-    int8_t rslt = bme68x_set_op_mode(BME68X_FORCED_MODE, &dev);
-    if (rslt != BME68X_OK) {
-        ESP_LOGE(TAG, "bme68x_set_op_mode failed: %d", rslt);
-        return false;
-    }
-
-    // Get the required delay time for the measurement and heater.
-    uint32_t del_period = bme68x_get_meas_dur(BME68X_FORCED_MODE, &conf, &dev) / 1000 + heatr_conf.heatr_dur;
-
-    // Delay to allow the sensor to complete the measurement.
-    vTaskDelay(pdMS_TO_TICKS(del_period) + 1);
+    if (!run_forced_measurement()) return false;
 
     struct bme68x_data data;
     uint8_t n_fields;
 
     // Read the sensor data.
-    rslt = bme68x_get_data(BME68X_FORCED_MODE, &data, &n_fields, &dev);
+    uint32_t polls = dev.intf_stats.data_polls;
+    int8_t rslt = bme68x_get_data(BME68X_FORCED_MODE, &data, &n_fields, &dev);
     if (rslt == BME68X_OK && n_fields > 0) {
+        note_completion(polls);
         int64_t now = esp_timer_get_time() / 1000; // ms
         last_temperature = data.temperature;
         last_pressure = data.pressure / 100.0f;
         last_humidity = data.humidity;
-        last_gas_resistance = data.gas_resistance / 1000.0f;
+        if (cycle_gas) {
+            last_gas_resistance = data.gas_resistance / 1000.0f;
+        }
         ESP_LOGI(TAG, "Timestamp: %lld ms", now);
         ESP_LOGI(TAG, "Temperature: %.2f degC", last_temperature);
         ESP_LOGI(TAG, "Pressure: %.2f hPa", last_pressure);
         ESP_LOGI(TAG, "Humidity: %.2f %%", last_humidity);
         ESP_LOGI(TAG, "Gas Resistance: %.2f KOhms", last_gas_resistance);
+        note_first_sample();
+        return true;
+    } else {
+        ESP_LOGW(TAG, "No data or error reading BME68x: %d", rslt);
+        return false;
+    }
+}
+
+// Rewrites the configuration registers for another precomputed mode.
+bool BME688::set_mode(BME688Mode new_mode) {
+    if (!ok || continuous || measuring) return false;
+    if ((size_t)new_mode >= sizeof(mode_table) / sizeof(mode_table[0])) return false;
+
+    const BME688ModeSettings &next = mode_table[new_mode];
+    struct bme68x_conf next_conf = next.conf;
+    int8_t rslt = bme68x_set_conf(&next_conf, &dev);
+    if (rslt != BME68X_OK) {
+        ESP_LOGE(TAG, "bme68x_set_conf failed: %d", rslt);
+        return false;
+    }
+    struct bme68x_heatr_conf next_heatr = next.heatr_conf;
+    rslt = bme68x_set_heatr_conf(BME68X_FORCED_MODE, &next_heatr, &dev);
+    if (rslt != BME68X_OK) {
+        ESP_LOGE(TAG, "bme68x_set_heatr_conf failed: %d", rslt);
+        // The oversampling registers already changed; put the old ones back.
+        bme68x_set_conf(&conf, &dev);
+        return false;
+    }
+
+    conf = next_conf;
+    heatr_conf = next_heatr;
+    settings = &next;
+    mode = new_mode;
+    if (!load_gas_regs()) return false;
+    ESP_LOGI(TAG, "Mode %d: %lu us per forced read", (int)new_mode, (unsigned long)settings->forced_period_us);
+    return true;
+}
+
+// Reads back ctrl_gas_1 after bme68x_set_heatr_conf(); one register read per
+// configuration change instead of one per gas on/off switch, none while the
+// driver's shadow copy is valid.
+bool BME688::load_gas_regs() {
+    uint8_t ctrl_gas_1 = dev.shadow.reg[BME68X_REG_CTRL_GAS_1 - BME68X_REG_CTRL_GAS_0];
+    int8_t rslt = BME68X_OK;
+    if (!dev.shadow.valid) {
+        rslt = bme68x_get_regs(BME68X_REG_CTRL_GAS_1, &ctrl_gas_1, 1, &dev);
+    }
+    if (rslt != BME68X_OK) {
+        ESP_LOGE(TAG, "Reading ctrl_gas_1 failed: %d", rslt);
+        return false;
+    }
+    gas_armed = heatr_conf.enable == BME68X_ENABLE;
+    ctrl_gas_off = ctrl_gas_1 & (uint8_t)~BME68X_RUN_GAS_MSK;
+    ctrl_gas_on = gas_armed ? ctrl_gas_1 : ctrl_gas_off;
+    return true;
+}
+
+int8_t BME688::trigger_forced(uint32_t &period_us) {
+    bool gas = settings->gas_enabled && (forced_count % gas_every) == 0;
+    int8_t rslt;
+    if (gas == gas_armed) {
+        rslt = bme688_trigger_forced(settings->ctrl_meas_forced, &dev);
+    } else {
+        rslt = bme688_trigger_forced_gas(settings->ctrl_meas_forced, gas ? ctrl_gas_on : ctrl_gas_off, &dev);
+        if (rslt == BME68X_OK) {
+            gas_armed = gas;
+        }
+    }
+    if (rslt == BME68X_OK) {
+        forced_count++;
+        cycle_gas = gas;
+    }
+    period_us = gas ? settings->forced_period_us : settings->forced_meas_us;
+    return rslt;
+}
+
+// Triggers a forced measurement and waits for the TPH conversion and heater phase.
+bool BME688::run_forced_measurement() {
+    if (continuous || measuring) {
+        ESP_LOGW(TAG, "Forced measurement requested while another measurement is running");
+        return false;
+    }
+    
+    // Set the sensor to forced mode to perform a single measurement.
+    uint32_t period_us = 0;
+    int8_t rslt = trigger_forced(period_us);
+    if (rslt != BME68X_OK) {
+        ESP_LOGE(TAG, "Forced trigger failed: %d", rslt);
+        return false;
+    }
+
+    // The measurement window (with or without the heater) is a compile-time
+    // constant; sleep until it is over, then the driver polls in fine steps.
+    meas_deadline_us = esp_timer_get_time() + period_us;
+    wait_until(meas_deadline_us);
+    return true;
+}
+
+// A tick-based vTaskDelay() lands anywhere in a 10 ms window around the
+// deadline; the one-shot timer wakes the task within a few tens of microseconds.
+void BME688::wait_until(int64_t deadline_us) {
+    int64_t remaining_us = deadline_us - esp_timer_get_time();
+    if (remaining_us <= 0) return;
+    xSemaphoreTake(wake_sem, 0);
+    if (esp_timer_start_once(wake_timer, (uint64_t)remaining_us) != ESP_OK) {
+        vTaskDelay(pdMS_TO_TICKS(remaining_us / 1000) + 1);
+        return;
+    }
+    // The tick timeout only matters if the esp_timer task is starved.
+    if (xSemaphoreTake(wake_sem, pdMS_TO_TICKS(remaining_us / 1000) + 2) != pdTRUE) {
+        esp_timer_stop(wake_timer);
+    }
+}
+
+void BME688::wake_timer_cb(void *arg) {
+    xSemaphoreGive(static_cast<BME688 *>(arg)->wake_sem);
+}
+
+void BME688::set_poll_step_us(uint32_t step_us) {
+    dev.poll_period_us = step_us;
+    uint32_t tries = step_us ? BME688_POLL_BUDGET_US / step_us : 0;
+    dev.poll_tries = (uint8_t)(tries > UINT8_MAX ? UINT8_MAX : tries);
+}
+
+void BME688::note_completion(uint32_t polls_before) {
+    int64_t late_us = esp_timer_get_time() - meas_deadline_us;
+    wake.samples++;
+    if (dev.intf_stats.data_polls != polls_before) {
+        wake.polled++;
+    }
+    wake.total_late_us += late_us;
+    if (late_us > wake.max_late_us) {
+        wake.max_late_us = late_us;
+    }
+}
+
+// Same as read_measurement() but returns the ADC values untouched.
+bool BME688::read_raw_measurement(bme68x_raw_data &raw) {
+    if (!ok) return false;
+    if (!run_forced_measurement()) return false;
+
+    uint8_t n_fields = 0;
+    uint32_t polls = dev.intf_stats.data_polls;
+    int8_t rslt = bme68x_get_raw_data(BME68X_FORCED_MODE, &raw, &n_fields, &dev);
+    if (rslt != BME68X_OK || n_fields == 0) {
+        ESP_LOGW(TAG, "No raw data or error reading BME68x: %d", rslt);
+        return false;
+    }
+    note_completion(polls);
+    note_first_sample();
+    return true;
+}
+
+bool BME688::read_calibration(uint8_t *coeff, uint8_t &variant_id) {
+    if (!ok || coeff == nullptr) return false;
+    const BME688CalibCache *cached = calib_cache_find(link);
+    if (cached) {
+        memcpy(coeff, cached->coeff, BME68X_LEN_COEFF_ALL);
+        variant_id = cached->variant_id;
         return true;
+    }
+    int8_t rslt = bme68x_get_calib_regs(coeff, &dev);
+    if (rslt != BME68X_OK) {
+        ESP_LOGE(TAG, "bme68x_get_calib_regs failed: %d", rslt);
+        return false;
+    }
+    variant_id = (uint8_t)dev.variant_id;
+    return true;
+}
+
+// Triggers a forced measurement and returns; the result is posted to the queue.
+bool BME688::start_measurement(QueueHandle_t completion_queue) {
+    if (!ok || continuous || measuring || completion_queue == nullptr) return false;
+    if (!start_meas_task()) return false;
+
+    uint32_t period_us = 0;
+    int8_t rslt = trigger_forced(period_us);
+    if (rslt != BME68X_OK) {
+        ESP_LOGE(TAG, "Forced trigger failed: %d", rslt);
+        return false;
+    }
+
+    // Wake up exactly when the TPH conversion (and heater phase, on gas reads) is over.
+    uint64_t del_us = period_us;
+    meas_deadline_us = esp_timer_get_time() + period_us;
+    meas_queue = completion_queue;
+    meas_polls = dev.intf_stats.data_polls;
+    meas_poll_us = dev.poll_period_us ? dev.poll_period_us : BME68X_PERIOD_POLL;
+    meas_polls_left = dev.poll_tries ? dev.poll_tries : BME68X_POLL_TRIES;
+    measuring = true;
+    if (esp_timer_start_once(meas_timer, del_us) != ESP_OK) {
+        ESP_LOGE(TAG, "esp_timer_start_once failed");
+        measuring = false;
+        return false;
+    }
+    return true;
+}
+
+void BME688::measurement_timer_cb(void *arg) {
+    BME688 *self = static_cast<BME688 *>(arg);
+    xTaskNotify(self->meas_task, BME688_MEAS_NOTIFY_READY, eSetBits);
+}
+
+bool BME688::start_meas_task() {
+    if (meas_task) return true;
+    if (meas_lock == nullptr) meas_lock = xSemaphoreCreateMutex();
+    if (meas_exited == nullptr) meas_exited = xSemaphoreCreateBinary();
+    meas_closing = false;
+    if (meas_lock == nullptr || meas_exited == nullptr ||
+        xTaskCreate(meas_task_entry, "bme688_meas", BME688_MEAS_TASK_STACK, this, BME688_MEAS_TASK_PRIORITY,
+                    &meas_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create the readout task");
+        meas_task = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// Once meas_closing is set under the lock the task neither reads nor re-arms
+// the timer, and once the timer callbacks are flushed nothing notifies it.
+void BME688::stop_meas_task() {
+    if (meas_task == nullptr) return;
+    xSemaphoreTake(meas_lock, portMAX_DELAY);
+    meas_closing = true;
+    esp_timer_stop(meas_timer);
+    xSemaphoreGive(meas_lock);
+    flush_timer_callbacks();
+    xTaskNotify(meas_task, BME688_MEAS_NOTIFY_EXIT, eSetBits);
+    xSemaphoreTake(meas_exited, portMAX_DELAY);
+    meas_task = nullptr;
+    measuring = false;
+}
+
+// esp_timer runs its task-dispatched callbacks one after another, so a
+// zero-length wake-up timer fires after any callback already under way.
+void BME688::flush_timer_callbacks() {
+    xSemaphoreTake(wake_sem, 0);
+    if (esp_timer_start_once(wake_timer, 0) == ESP_OK) {
+        xSemaphoreTake(wake_sem, portMAX_DELAY);
+    }
+}
+
+void BME688::meas_task_entry(void *arg) {
+    static_cast<BME688 *>(arg)->run_meas_task();
+    vTaskDelete(NULL);
+}
+
+void BME688::run_meas_task() {
+    while (true) {
+        uint32_t bits = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &bits, portMAX_DELAY);
+        if (bits & BME688_MEAS_NOTIFY_EXIT) break;
+        xSemaphoreTake(meas_lock, portMAX_DELAY);
+        if (!meas_closing && measuring) {
+            finish_measurement();
+        }
+        xSemaphoreGive(meas_lock);
+    }
+    // The destructor may free this instance as soon as it sees the semaphore.
+    xSemaphoreGive(meas_exited);
+}
+
+// Runs in the readout task: read the finished measurement and post it. A
+// sensor that is not done yet gets the timer again one poll step later
+// instead of a busy wait, up to the driver's poll budget.
+void BME688::finish_measurement() {
+    BME688Completion done = {};
+    done.sensor = this;
+
+    struct bme68x_data data;
+    uint8_t n_fields = 0;
+    uint8_t tries = dev.poll_tries;
+    dev.poll_tries = 1;
+    int8_t rslt = bme68x_get_data(BME68X_FORCED_MODE, &data, &n_fields, &dev);
+    dev.poll_tries = tries;
+    if (rslt == BME68X_W_NO_NEW_DATA && meas_polls_left > 0) {
+        meas_polls_left--;
+        if (esp_timer_start_once(meas_timer, meas_poll_us) == ESP_OK) {
+            return;
+        }
+    }
+    if (rslt == BME68X_OK && n_fields > 0) {
+        note_completion(meas_polls);
+        done.sample.timestamp_ms = esp_timer_get_time() / 1000;
+        done.sample.temperature = data.temperature;
+        done.sample.pressure = data.pressure / 100.0f;
+        done.sample.humidity = data.humidity;
+        if (cycle_gas) {
+            last_gas_resistance = data.gas_resistance / 1000.0f;
+        }
+        done.sample.gas_resistance = last_gas_resistance;
+        done.sample.status = data.status;
+        done.sample.gas_index = data.gas_index;
+        done.sample.meas_index = data.meas_index;
+        done.ok = true;
+        last_temperature = done.sample.temperature;
+        last_pressure = done.sample.pressure;
+        last_humidity = done.sample.humidity;
+        last_gas_resistance = done.sample.gas_resistance;
+        note_first_sample();
     } else {
         ESP_LOGW(TAG, "No data or error reading BME68x: %d", rslt);
+    }
+
+    measuring = false;
+    if (xQueueSend(meas_queue, &done, 0) != pdTRUE) {
+        dropped_count++;
+    }
+}
+
+// Starts free-running acquisition using the sensor's parallel mode.
+bool BME688::start_continuous(const uint16_t *temps, const uint16_t *muls, uint8_t profile_len,
+                              uint16_t shared_heatr_dur_ms) {
+    if (!ok || measuring) return false;
+    if (profile_len == 0 || profile_len > BME688_MAX_PROFILE_LEN) {
+        ESP_LOGE(TAG, "Invalid heater profile length: %u", profile_len);
+        return false;
+    }
+
+    // Keep private copies; the Bosch API only stores the pointers.
+    for (uint8_t i = 0; i < profile_len; i++) {
+        temp_prof[i] = temps ? temps[i] : heatr_conf.heatr_temp;
+        mul_prof[i] = muls ? muls[i] : 1;
+    }
+
+    // A TPH conversion plus the shared heater phase makes up one field.
+    uint32_t meas_dur_us = settings->parallel_meas_us;
+    if (shared_heatr_dur_ms == 0) {
+        shared_heatr_dur_ms = (uint16_t)(140 - (meas_dur_us / 1000));
+    }
+
+    struct bme68x_heatr_conf par_conf = {};
+    par_conf.enable = BME68X_ENABLE;
+    par_conf.heatr_temp_prof = temp_prof;
+    par_conf.heatr_dur_prof = mul_prof;
+    par_conf.profile_len = profile_len;
+    par_conf.shared_heatr_dur = shared_heatr_dur_ms;
+    int8_t rslt = bme68x_set_heatr_conf(BME68X_PARALLEL_MODE, &par_conf, &dev);
+    if (rslt != BME68X_OK) {
+        ESP_LOGE(TAG, "bme68x_set_heatr_conf (parallel) failed: %d", rslt);
+        return false;
+    }
+
+    rslt = bme68x_set_op_mode(BME68X_PARALLEL_MODE, &dev);
+    if (rslt != BME68X_OK) {
+        ESP_LOGE(TAG, "bme68x_set_op_mode (parallel) failed: %d", rslt);
+        return false;
+    }
+
+    cycle_us = meas_dur_us + (uint32_t)shared_heatr_dur_ms * 1000;
+    for (uint8_t i = 0; i < profile_len; i++) {
+        field_us[i] = cycle_us;
+    }
+    begin_continuous(BME68X_PARALLEL_MODE, profile_len);
+    ESP_LOGI(TAG, "Continuous mode started: %u step(s), %lu us per field",
+             profile_len, (unsigned long)cycle_us);
+    return true;
+}
+
+// Starts free-running acquisition using the sensor's sequential mode.
+bool BME688::start_sequential(const uint16_t *temps, const uint16_t *durs, uint8_t profile_len) {
+    if (!ok || measuring || temps == nullptr || durs == nullptr) return false;
+    if (profile_len == 0 || profile_len > BME688_MAX_PROFILE_LEN) {
+        ESP_LOGE(TAG, "Invalid heater profile length: %u", profile_len);
+        return false;
+    }
+
+    // Keep private copies; the Bosch API only stores the pointers.
+    for (uint8_t i = 0; i < profile_len; i++) {
+        temp_prof[i] = temps[i];
+        mul_prof[i] = durs[i];
+    }
+
+    struct bme68x_heatr_conf seq_conf = {};
+    seq_conf.enable = BME68X_ENABLE;
+    seq_conf.heatr_temp_prof = temp_prof;
+    seq_conf.heatr_dur_prof = mul_prof;
+    seq_conf.profile_len = profile_len;
+    int8_t rslt = bme68x_set_heatr_conf(BME68X_SEQUENTIAL_MODE, &seq_conf, &dev);
+    if (rslt != BME68X_OK) {
+        ESP_LOGE(TAG, "bme68x_set_heatr_conf (sequential) failed: %d", rslt);
+        return false;
+    }
+
+    rslt = bme68x_set_op_mode(BME68X_SEQUENTIAL_MODE, &dev);
+    if (rslt != BME68X_OK) {
+        ESP_LOGE(TAG, "bme68x_set_op_mode (sequential) failed: %d", rslt);
+        return false;
+    }
+
+    // Each step is a TPH conversion followed by its own heater phase.
+    uint32_t meas_dur_us = settings->sequential_meas_us;
+    cycle_us = 0;
+    for (uint8_t i = 0; i < profile_len; i++) {
+        field_us[i] = meas_dur_us + (uint32_t)mul_prof[i] * 1000;
+        cycle_us += field_us[i];
+    }
+    // continuous_poll_period_ms() then gives two average-length fields
+    cycle_us /= profile_len;
+    begin_continuous(BME68X_SEQUENTIAL_MODE, profile_len);
+    ESP_LOGI(TAG, "Sequential mode started: %u step(s), %lu us per field on average",
+             profile_len, (unsigned long)cycle_us);
+    return true;
+}
+
+void BME688::begin_continuous(uint8_t mode, uint8_t len) {
+    cont_mode = mode;
+    profile_len = len;
+    // The first field of a cycle comes from step 0.
+    last_gas_index = len - 1;
+    pending_fp = {};
+    have_meas_index = false;
+    missed_count = 0;
+    continuous = true;
+}
+
+uint32_t BME688::next_poll_delay_ms() const {
+    if (!continuous) return 0;
+    uint8_t next = (uint8_t)((last_gas_index + 1) % profile_len);
+    uint8_t after = (uint8_t)((next + 1) % profile_len);
+    return (field_us[next] + field_us[after]) / 1000;
+}
+
+// Reads all new fields and tracks meas_index gaps and the profile position.
+int BME688::fetch_fields(struct bme68x_data *data) {
+    if (!ok || !continuous) return -1;
+
+    uint8_t n_fields = 0;
+    int8_t rslt = bme68x_get_data(cont_mode, data, &n_fields, &dev);
+    if (rslt == BME68X_W_NO_NEW_DATA) {
+        return 0;
+    }
+    if (rslt != BME68X_OK) {
+        ESP_LOGW(TAG, "Error reading BME68x fields: %d", rslt);
+        return -1;
+    }
+
+    // bme68x_get_data returns the new fields first, oldest to newest.
+    for (uint8_t i = 0; i < n_fields; i++) {
+        // The sub-measurement index advances by one per field; a larger step
+        // means the sensor overwrote fields before we drained them.
+        if (have_meas_index) {
+            uint8_t step = (uint8_t)(data[i].meas_index - last_meas_index);
+            if (step > 1) {
+                missed_count += step - 1;
+            }
+        }
+        last_meas_index = data[i].meas_index;
+        have_meas_index = true;
+        if (data[i].gas_index < profile_len) {
+            last_gas_index = data[i].gas_index;
+        }
+    }
+    if (n_fields > 0) {
+        const struct bme68x_data &newest = data[n_fields - 1];
+        last_temperature = newest.temperature;
+        last_pressure = newest.pressure / 100.0f;
+        last_humidity = newest.humidity;
+        last_gas_resistance = newest.gas_resistance / 1000.0f;
+        note_first_sample();
+    }
+    return n_fields;
+}
+
+// Drains all new continuous-mode fields into the caller's ring buffer.
+int BME688::read_continuous(BME688SampleRing &ring) {
+    struct bme68x_data data[3];
+    int n_fields = fetch_fields(data);
+    if (n_fields <= 0) {
+        return n_fields;
+    }
+
+    int64_t now = esp_timer_get_time() / 1000; // ms
+    int pushed = 0;
+    for (int i = 0; i < n_fields; i++) {
+        BME688Sample sample;
+        sample.timestamp_ms = now;
+        sample.temperature = data[i].temperature;
+        sample.pressure = data[i].pressure / 100.0f;
+        sample.humidity = data[i].humidity;
+        sample.gas_resistance = data[i].gas_resistance / 1000.0f;
+        sample.status = data[i].status;
+        sample.gas_index = data[i].gas_index;
+        sample.meas_index = data[i].meas_index;
+        if (ring.push(sample)) {
+            pushed++;
+        }
+    }
+    return pushed;
+}
+
+// Collects continuous-mode fields step by step into heater profile fingerprints.
+int BME688::read_fingerprints(BME688Fingerprint *out, int max_out) {
+    struct bme68x_data data[3];
+    int n_fields = fetch_fields(data);
+    if (n_fields <= 0) {
+        return n_fields;
+    }
+
+    int64_t now = esp_timer_get_time() / 1000; // ms
+    int emitted = 0;
+    for (int i = 0; i < n_fields; i++) {
+        uint8_t step = data[i].gas_index;
+        if (step >= profile_len) continue;
+
+        // Step 0, or any step already filled in, opens a new cycle; whatever
+        // was left of the previous one lost its last step and is dropped.
+        if (step == 0 || pending_fp.len == 0 || (pending_fp.step_valid >> step) != 0) {
+            pending_fp = {};
+            pending_fp.len = profile_len;
+            for (uint8_t j = 0; j < profile_len; j++) {
+                pending_fp.heatr_temp[j] = temp_prof[j];
+            }
+        }
+        // In parallel mode a step can span several fields; only the one that
+        // ends the heater phase carries a valid gas reading.
+        if (data[i].status & BME68X_GASM_VALID_MSK) {
+            pending_fp.gas_resistance[step] = data[i].gas_resistance / 1000.0f;
+            pending_fp.step_valid |= (uint16_t)(1u << step);
+        }
+        if (step == profile_len - 1 && (data[i].status & BME68X_GASM_VALID_MSK)) {
+            pending_fp.timestamp_ms = now;
+            pending_fp.temperature = data[i].temperature;
+            pending_fp.pressure = data[i].pressure / 100.0f;
+            pending_fp.humidity = data[i].humidity;
+            if (emitted < max_out) {
+                out[emitted++] = pending_fp;
+            }
+            pending_fp.len = 0;
+        }
+    }
+    return emitted;
+}
+
+// Leaves parallel/sequential mode and restores the forced-mode heater configuration.
+bool BME688::stop_continuous() {
+    if (!continuous) return true;
+    continuous = false;
+
+    int8_t rslt = bme68x_set_op_mode(BME68X_SLEEP_MODE, &dev);
+    if (rslt == BME68X_OK) {
+        rslt = bme68x_set_heatr_conf(BME68X_FORCED_MODE, &heatr_conf, &dev);
+    }
+    if (rslt != BME68X_OK) {
+        ESP_LOGE(TAG, "Failed to leave continuous mode: %d", rslt);
         return false;
     }
+    return load_gas_regs();
 }
 
 // Static member function for I2C read, required by the Bosch sensor API.
 int8_t BME688::bme68x_i2c_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr) {
-    uint8_t dev_addr = *(uint8_t *)intf_ptr;
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (dev_addr << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd, reg_addr, true);
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (dev_addr << 1) | I2C_MASTER_READ, true);
-    if (len > 1) {
-        i2c_master_read(cmd, reg_data, len - 1, I2C_MASTER_ACK);
-    }
-    i2c_master_read_byte(cmd, reg_data + len - 1, I2C_MASTER_NACK);
-    i2c_master_stop(cmd);
-    esp_err_t ret = i2c_master_cmd_begin(I2C_MASTER_NUM, cmd, pdMS_TO_TICKS(1000));
-    i2c_cmd_link_delete(cmd);
+    BME688Link &link = *static_cast<BME688Link *>(intf_ptr);
+    if (!lock_bus(link)) return -1;
+    esp_err_t ret = link.sensor.read_reg(reg_addr, reg_data, len);
+    unlock_bus(link);
     return (ret == ESP_OK) ? 0 : -1;
 }
 
 // Static member function for I2C write, required by the Bosch sensor API.
 int8_t BME688::bme68x_i2c_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr) {
-    uint8_t dev_addr = *(uint8_t *)intf_ptr;
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (dev_addr << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd, reg_addr, true);
-    i2c_master_write(cmd, (uint8_t *)reg_data, len, true);
-    i2c_master_stop(cmd);
-    esp_err_t ret = i2c_master_cmd_begin(I2C_MASTER_NUM, cmd, pdMS_TO_TICKS(1000));
-    i2c_cmd_link_delete(cmd);
+    BME688Link &link = *static_cast<BME688Link *>(intf_ptr);
+    if (!lock_bus(link)) return -1;
+    esp_err_t ret = link.sensor.write_reg(reg_addr, reg_data, len);
+    unlock_bus(link);
     return (ret == ESP_OK) ? 0 : -1;
 }
 
+// Static member function for SPI read, required by the Bosch sensor API.
+// Up to four bytes come back in the transaction itself; longer reads land in
+// the word-aligned link buffer, rounded up to whole words so the DMA never
+// needs a bounce buffer of its own (the extra registers read are discarded).
+int8_t BME688::bme68x_spi_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr) {
+    BME688Link &link = *static_cast<BME688Link *>(intf_ptr);
+    for (uint32_t off = 0; off < len; off += BME688_SPI_BUF_LEN) {
+        uint32_t n = len - off < BME688_SPI_BUF_LEN ? len - off : BME688_SPI_BUF_LEN;
+        spi_transaction_t t = {};
+        t.addr = (uint8_t)(reg_addr + off);
+        if (n <= 4) {
+            t.flags = SPI_TRANS_USE_RXDATA;
+            t.length = n * 8;
+        } else {
+            t.length = ((n + 3) & ~3u) * 8;
+            t.rx_buffer = link.spi_buf;
+        }
+        t.rxlength = t.length;
+        if (spi_device_polling_transmit(link.spi, &t) != ESP_OK) return -1;
+        memcpy(reg_data + off, n <= 4 ? t.rx_data : link.spi_buf, n);
+    }
+    return 0;
+}
+
+// Static member function for SPI write, required by the Bosch sensor API.
+int8_t BME688::bme68x_spi_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr) {
+    BME688Link &link = *static_cast<BME688Link *>(intf_ptr);
+    if (len > BME688_SPI_BUF_LEN) return -1;
+    spi_transaction_t t = {};
+    t.addr = reg_addr;
+    t.length = len * 8;
+    if (len <= 4) {
+        t.flags = SPI_TRANS_USE_TXDATA;
+        memcpy(t.tx_data, reg_data, len);
+    } else {
+        memcpy(link.spi_buf, reg_data, len);
+        t.tx_buffer = link.spi_buf;
+    }
+    return spi_device_polling_transmit(link.spi, &t) == ESP_OK ? 0 : -1;
+}
+
 // Static member function for microsecond delays, required by the Bosch sensor API.
+// Up to BME688_POLL_BUDGET_US / poll step new-data polls would otherwise spin
+// the CPU for the whole budget; short settling delays still spin.
 void BME688::bme68x_delay_us(uint32_t period, void *intf_ptr) {
-    ets_delay_us(period);
+    BME688 *self = static_cast<BME688Link *>(intf_ptr)->owner;
+    if (period < BME688_DELAY_SPIN_US || self->wake_timer == nullptr ||
+        xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+        esp_rom_delay_us(period);
+        return;
+    }
+    self->wait_until(esp_timer_get_time() + period);
 }
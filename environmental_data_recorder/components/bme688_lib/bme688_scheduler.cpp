@@ -0,0 +1,78 @@
+#include "bme688_scheduler.h"
+
+static const char *TAG = "BME688_SCHED";
+
+BME688Scheduler::BME688Scheduler(BME688 *const *list, size_t count) {
+    if (count > BME688_SCHEDULER_MAX_SENSORS) {
+        ESP_LOGW(TAG, "Only the first %d of %u sensors are scheduled", BME688_SCHEDULER_MAX_SENSORS, (unsigned)count);
+        count = BME688_SCHEDULER_MAX_SENSORS;
+    }
+    for (size_t i = 0; i < count; i++) {
+        sensors[i] = list[i];
+    }
+    sensor_count = count;
+}
+
+BME688Scheduler::~BME688Scheduler() {
+    stop();
+    if (done_queue) vQueueDelete(done_queue);
+    if (stopped) vSemaphoreDelete(stopped);
+}
+
+bool BME688Scheduler::start(QueueHandle_t queue, UBaseType_t priority) {
+    if (task != nullptr || queue == nullptr || sensor_count == 0) return false;
+
+    // Each sensor has at most one measurement in flight.
+    if (done_queue == nullptr) {
+        done_queue = xQueueCreate(sensor_count, sizeof(BME688Completion));
+        stopped = xSemaphoreCreateBinary();
+        if (done_queue == nullptr || stopped == nullptr) {
+            ESP_LOGE(TAG, "Failed to allocate scheduler queues");
+            return false;
+        }
+    }
+    out_queue = queue;
+    stopping = false;
+    sample_count = 0;
+    dropped_count = 0;
+    if (xTaskCreate(task_entry, "bme688_sched", 3072, this, priority, &task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create scheduler task");
+        task = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void BME688Scheduler::stop() {
+    if (task == nullptr) return;
+    stopping = true;
+    xSemaphoreTake(stopped, portMAX_DELAY);
+    task = nullptr;
+}
+
+void BME688Scheduler::task_entry(void *arg) {
+    static_cast<BME688Scheduler *>(arg)->run();
+    vTaskDelete(NULL);
+}
+
+// Re-triggers each sensor as soon as its completion arrives, so every sensor
+// runs at its own measurement rate and the heater waits overlap.
+void BME688Scheduler::run() {
+    BME688SchedulerPolicy<BME688, QueueHandle_t> policy(sensors, sensor_count, done_queue);
+    size_t started = policy.start_all();
+    ESP_LOGI(TAG, "Scheduling %u sensor(s), %u started", (unsigned)sensor_count, (unsigned)started);
+
+    while (policy.running(stopping)) {
+        BME688Completion done;
+        if (xQueueReceive(done_queue, &done, pdMS_TO_TICKS(100)) == pdTRUE) {
+            if (xQueueSend(out_queue, &done, 0) == pdTRUE) {
+                sample_count++;
+            } else {
+                dropped_count++;
+            }
+            policy.completed(done.sensor, stopping);
+        }
+        policy.retry_idle(stopping);
+    }
+    xSemaphoreGive(stopped);
+}
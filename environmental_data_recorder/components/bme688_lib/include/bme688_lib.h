@@ -4,22 +4,185 @@
 // Core BME68x sensor library headers
 #include "bme68x.h"
 #include "bme68x_defs.h"
+#include "bme688_static_conf.h"
+#include "bme688_sample_ring.h"
 
 // ESP-IDF specific headers
+#include "esp_attr.h"
 #include "esp_log.h"
-#include "driver/i2c.h"
 #include "esp_timer.h"
+#include "i2c_bus_lib.h"
+#include "driver/spi_master.h"
 
 // FreeRTOS header for vTaskDelay
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 
-// Define constants for the I2C bus and BME688 sensor address
-#define I2C_MASTER_NUM I2C_NUM_0
-#define I2C_MASTER_SCL_IO 22
-#define I2C_MASTER_SDA_IO 21
-#define I2C_MASTER_FREQ_HZ 100000
+// Default I2C bus and BME688 sensor address, used by BME688()
+#define I2C_MASTER_NUM I2C_BUS_DEFAULT_PORT
+#define I2C_MASTER_SCL_IO I2C_BUS_DEFAULT_SCL_IO
+#define I2C_MASTER_SDA_IO I2C_BUS_DEFAULT_SDA_IO
+#define I2C_MASTER_FREQ_HZ 400000     // fast mode; other devices on the bus keep their own clock
 #define BME68X_ADDR 0x77
+// Longest a sensor transaction may hold the bus: the 23-byte calibration read
+// takes about 2.5 ms at 100 kHz.
+#define BME688_I2C_DEADLINE_MS 10
+
+// Compile-time oversampling, filter and heater settings of the modes
+// selectable with BME688::set_mode(); pick other BME688StaticConf<>s here to
+// change them. BME688SensorConf is what the constructor starts with.
+typedef BME688DefaultConf BME688SensorConf;
+// T/P/H x1, no filter, no gas measurement: about 11 ms per forced read.
+typedef BME688StaticConf<BME68X_OS_1X, BME68X_OS_1X, BME68X_OS_1X, BME68X_FILTER_OFF, BME68X_ODR_NONE, 300, 100,
+                         BME68X_DISABLE> BME688LowLatencyConf;
+// T x8, P x16, H x4 with an IIR filter of size 15, gas at 300 degC for 100 ms.
+typedef BME688StaticConf<BME68X_OS_8X, BME68X_OS_16X, BME68X_OS_4X, BME68X_FILTER_SIZE_15> BME688PrecisionConf;
+
+enum BME688Mode {
+    BME688_MODE_DEFAULT,        // BME688SensorConf
+    BME688_MODE_LOW_LATENCY,    // BME688LowLatencyConf
+    BME688_MODE_PRECISION,      // BME688PrecisionConf
+};
+
+// Constants of one BME688Mode, copied out of its BME688StaticConf<>.
+struct BME688ModeSettings {
+    struct bme68x_conf conf;
+    struct bme68x_heatr_conf heatr_conf;
+    uint32_t forced_meas_us;        // forced read without the heater phase
+    uint32_t forced_period_us;      // forced read including the heater phase
+    uint32_t parallel_meas_us;
+    uint32_t sequential_meas_us;
+    uint8_t ctrl_meas_forced;
+    bool gas_enabled;
+};
+
+// Default SPI wiring: the SD card's bus (sdcard_lib) on SPI2_HOST, own chip select
+#define BME688_SPI_HOST SPI2_HOST
+#define BME688_SPI_MOSI_IO 23
+#define BME688_SPI_MISO_IO 19
+#define BME688_SPI_SCLK_IO 18
+#define BME688_SPI_CS_IO 5
+#define BME688_SPI_FREQ_HZ 10000000   // datasheet maximum
+
+// Bytes moved per SPI transaction through the word-aligned bounce buffer
+#define BME688_SPI_BUF_LEN 64
+
+enum BME688Interface {
+    BME688_INTF_I2C,
+    BME688_INTF_SPI,
+};
+
+// Default address of a TCA9548A-style I2C multiplexer in front of the sensor
+#define BME688_MUX_ADDR 0x70
+
+// Number of sensors whose calibration is kept in RTC memory across deep sleep
+#define BME688_CALIB_CACHE_SLOTS 4
+
+// Forced reads wake up at the computed completion time and then poll the
+// new-data bit every BME688_POLL_STEP_US, for up to BME688_POLL_BUDGET_US.
+#define BME688_POLL_STEP_US 500
+#define BME688_POLL_BUDGET_US 50000   // the Bosch default: 5 polls 10 ms apart
+// Driver delays shorter than this spin; longer ones sleep on the wake-up timer.
+#define BME688_DELAY_SPIN_US 100
+
+// Task that reads out measurements started with start_measurement(), one per
+// instance, created on the first call.
+#define BME688_MEAS_TASK_STACK 3072
+#define BME688_MEAS_TASK_PRIORITY 10
+
+/**
+ * @struct BME688Config
+ * @brief Where a BME688 instance lives on the I2C or SPI bus.
+ * Instances on the same port share one i2c_bus_lib bus, whose pins come
+ * from the first device opened on it. The clock is per instance.
+ * Over SPI the sensor is one more device on the host; the SPI pins are only
+ * used if nothing (e.g. SDCard::init()) initialized the host before.
+ */
+struct BME688Config {
+    BME688Interface intf = BME688_INTF_I2C;
+    uint8_t addr = BME68X_ADDR;          // 0x77, or 0x76 with SDO tied low
+    i2c_port_t port = I2C_MASTER_NUM;
+    int sda_io = I2C_MASTER_SDA_IO;
+    int scl_io = I2C_MASTER_SCL_IO;
+    uint32_t clk_hz = I2C_MASTER_FREQ_HZ;
+    int8_t mux_channel = -1;             // multiplexer channel (0..7), -1 if wired directly
+    uint8_t mux_addr = BME688_MUX_ADDR;
+
+    // SPI transport, used with BME688_INTF_SPI
+    spi_host_device_t spi_host = BME688_SPI_HOST;
+    int mosi_io = BME688_SPI_MOSI_IO;
+    int miso_io = BME688_SPI_MISO_IO;
+    int sclk_io = BME688_SPI_SCLK_IO;
+    int cs_io = BME688_SPI_CS_IO;
+    uint32_t spi_clk_hz = BME688_SPI_FREQ_HZ;
+
+    uint32_t poll_step_us = BME688_POLL_STEP_US;   // new-data poll step after the wake-up
+};
+
+class BME688;
+
+// Bus coordinates handed to the Bosch API as intf_ptr.
+struct BME688Link {
+    BME688 *owner;                       // for the driver's delay callback
+    BME688Interface intf;
+    i2c_port_t port;
+    uint8_t addr;
+    int8_t mux_channel;
+    uint8_t mux_addr;
+    I2CDevice sensor;
+    I2CDevice mux;                       // only opened when mux_channel >= 0
+    spi_host_device_t spi_host;
+    int cs_io;
+    spi_device_handle_t spi;             // only set with BME688_INTF_SPI
+    bool spi_bus_owner;                  // this instance initialized the SPI host
+    // DMA-safe copy of SPI transfers, so the driver never allocates a bounce buffer
+    WORD_ALIGNED_ATTR uint8_t spi_buf[BME688_SPI_BUF_LEN];
+};
+
+// Maximum number of steps in a BME68x heater profile
+#define BME688_MAX_PROFILE_LEN 10
+
+/**
+ * @struct BME688Fingerprint
+ * @brief Gas resistance of every step of one heater profile cycle.
+ */
+struct BME688Fingerprint {
+    int64_t timestamp_ms;                           // esp_timer time when the last step was drained
+    uint8_t len;                                    // heater profile length
+    uint16_t step_valid;                            // bit i set once step i delivered a valid gas reading
+    uint16_t heatr_temp[BME688_MAX_PROFILE_LEN];    // degC, per step
+    float gas_resistance[BME688_MAX_PROFILE_LEN];   // KOhms, per step
+    float temperature;                              // degC, from the last step
+    float pressure;                                 // hPa, from the last step
+    float humidity;                                 // %, from the last step
+
+    bool complete() const { return step_valid == (uint16_t)((1u << len) - 1); }
+};
+
+/**
+ * @struct BME688WakeStats
+ * @brief How late forced reads completed relative to their computed completion time.
+ * Lateness is measured from the computed completion time to the moment the
+ * new field had been read, so it covers the wake-up, the polls and the bus.
+ */
+struct BME688WakeStats {
+    uint32_t samples;       // forced reads that returned a field
+    uint32_t polled;        // of which the first read found no new data yet
+    int64_t total_late_us;
+    int64_t max_late_us;
+};
+
+/**
+ * @struct BME688Completion
+ * @brief Queue item posted when a measurement started with start_measurement() finishes.
+ */
+struct BME688Completion {
+    BME688 *sensor;         // instance that produced the sample
+    BME688Sample sample;    // valid only when ok is true
+    bool ok;
+};
 
 /**
  * @class BME688
@@ -39,13 +202,24 @@ public:
 
     /**
      * @brief Constructor for the BME688 class.
-     * Initializes the I2C bus and configures the BME68x sensor.
+     * Initializes the I2C bus and configures the BME68x sensor at the default
+     * address (BME68X_ADDR on I2C_MASTER_NUM).
      */
     BME688();
 
+    /**
+     * @brief Constructor for a sensor at a given address, port and multiplexer channel.
+     * The I2C driver of the port is installed by the first instance and
+     * removed by the last one, so any number of sensors can share a bus.
+     * With config.intf = BME688_INTF_SPI the sensor is added to the SPI host
+     * instead, next to whatever else (the SD card) already uses it.
+     * Construct and destroy instances from one task.
+     */
+    explicit BME688(const BME688Config &config);
+
     /**
      * @brief Destructor for the BME688 class.
-     * Cleans up the I2C driver resources.
+     * Removes the sensor from its bus; an I2C bus is deleted with its last device.
      */
     ~BME688();
 
@@ -55,6 +229,46 @@ public:
      * @return true if the measurement was successful, false otherwise.
      */
     bool read_measurement();
+    /**
+     * @brief Switches oversampling, IIR filter and heater settings at runtime.
+     * Rewrites the configuration registers only; bme68x_init() is not re-run.
+     * In BME688_MODE_LOW_LATENCY the gas measurement is off and the gas
+     * resistance keeps its last value. Not allowed while a measurement or
+     * continuous mode is running.
+     * @return true if the sensor now runs in the new mode.
+     */
+    bool set_mode(BME688Mode mode);
+    BME688Mode get_mode() const { return mode; }
+
+    // Time from trigger to result of a forced read in the current mode, in microseconds.
+    uint32_t forced_period_us() const { return settings->forced_period_us; }
+
+    /**
+     * @brief Runs the heater and gas measurement only on every Nth forced read.
+     * The reads in between measure T/P/H only, so they finish after the TPH
+     * conversion instead of the full heater window. The gas on/off switch is
+     * written together with the trigger, so it costs no extra bus transaction.
+     * Those reads keep the last gas resistance and have no
+     * BME68X_GASM_VALID_MSK in their status.
+     * @param every_n 1 (default) heats every read; 0 is treated as 1.
+     */
+    void set_gas_cadence(uint16_t every_n) { gas_every = every_n ? every_n : 1; }
+    uint16_t gas_cadence() const { return gas_every; }
+
+    // True if the last forced read included a gas measurement.
+    bool last_read_had_gas() const { return cycle_gas; }
+
+    /**
+     * @brief Sets how often a forced read polls the new-data bit after waking up.
+     * The wait ends at the computed completion time, so a poll is only needed
+     * when the sensor runs slow; the total polling time stays BME688_POLL_BUDGET_US.
+     * @param step_us Poll step in microseconds; 0 restores the driver's 10 ms.
+     */
+    void set_poll_step_us(uint32_t step_us);
+
+    // Completion lateness of forced reads; polls are counted in intf_stats().data_polls.
+    const BME688WakeStats &wake_stats() const { return wake; }
+
     void get_last_measurement(float &temperature, float &pressure, float &humidity, float &gas_resistance) const {
         temperature = last_temperature;
         pressure = last_pressure;
@@ -62,6 +276,128 @@ public:
         gas_resistance = last_gas_resistance;
     }
 
+    /**
+     * @brief Reads a forced measurement without compensating it.
+     * Takes as long as read_measurement() but skips the float compensation and
+     * logging, so a raw capture loop only moves bytes. Compensate the field
+     * later with bme68x_compensate_raw_data() and the blob from read_calibration().
+     * @return true if a new field was read.
+     */
+    bool read_raw_measurement(bme68x_raw_data &raw);
+
+    /**
+     * @brief Reads the calibration registers needed to compensate raw fields offline.
+     * @param coeff Buffer of BME68X_LEN_COEFF_ALL bytes.
+     * @param variant_id Receives the sensor variant (gas low / gas high).
+     * @return true on success.
+     */
+    bool read_calibration(uint8_t *coeff, uint8_t &variant_id);
+
+    /**
+     * @brief Triggers a forced measurement without blocking.
+     * A one-shot esp_timer fires when the measurement and heater window is over
+     * and wakes this instance's readout task, which reads the result and posts a
+     * BME688Completion to completion_queue. If the sensor is not done yet the
+     * timer is re-armed one poll step later. Several instances can have a
+     * measurement in flight at the same time.
+     * @param completion_queue Queue created with item size sizeof(BME688Completion).
+     * @return true if the measurement was started.
+     */
+    bool start_measurement(QueueHandle_t completion_queue);
+
+    bool measurement_in_progress() const { return measuring; }
+
+    // Completions that could not be posted because the queue was full.
+    uint32_t dropped_completions() const { return dropped_count; }
+
+    /**
+     * @brief Starts free-running acquisition in parallel mode.
+     * The sensor measures back to back and buffers up to three fields, which
+     * read_continuous() drains. The default profile heats every field to 300 degC.
+     * @param temp_prof Heater temperatures in degC, one per profile step.
+     * @param mul_prof Heater step lengths as multiples of the shared heater duration.
+     * @param profile_len Number of steps (1..BME688_MAX_PROFILE_LEN).
+     * @param shared_heatr_dur_ms Shared heater duration in ms, 0 selects a ~140 ms cycle.
+     * @return true if the sensor is now in parallel mode.
+     */
+    bool start_continuous(const uint16_t *temp_prof = nullptr, const uint16_t *mul_prof = nullptr,
+                          uint8_t profile_len = 1, uint16_t shared_heatr_dur_ms = 0);
+
+    /**
+     * @brief Starts free-running acquisition in sequential mode.
+     * Every step is a full TPHG measurement with its own heater duration, so
+     * one pass through the profile gives one field per step.
+     * read_continuous() and read_fingerprints() drain it like parallel mode.
+     * @param temp_prof Heater temperatures in degC, one per profile step.
+     * @param dur_prof Heater durations in ms, one per profile step.
+     * @param profile_len Number of steps (1..BME688_MAX_PROFILE_LEN).
+     * @return true if the sensor is now in sequential mode.
+     */
+    bool start_sequential(const uint16_t *temp_prof, const uint16_t *dur_prof, uint8_t profile_len);
+
+    /**
+     * @brief Drains every new field (up to three) into the ring buffer.
+     * Call at least every continuous_poll_period_ms() so the sensor never
+     * overwrites a field that has not been read.
+     * @return Number of samples pushed, or -1 on a bus/driver error.
+     */
+    int read_continuous(BME688SampleRing &ring);
+
+    /**
+     * @brief Drains new fields and assembles them into per-cycle fingerprints.
+     * Steps are collected as they arrive; a fingerprint is emitted when the
+     * last step of the profile comes in. Sleep next_poll_delay_ms() between
+     * calls so each call picks up about two steps.
+     * @param out Array receiving completed fingerprints.
+     * @param max_out Size of out; a profile of three or more steps completes at most one per call.
+     * @return Number of fingerprints written, or -1 on a bus/driver error.
+     */
+    int read_fingerprints(BME688Fingerprint *out, int max_out);
+
+    /**
+     * @brief Puts the sensor back to sleep and restores the forced-mode heater setup.
+     */
+    bool stop_continuous();
+
+    bool is_continuous() const { return continuous; }
+
+    // Time the sensor needs for one parallel-mode field, in microseconds.
+    uint32_t continuous_cycle_us() const { return cycle_us; }
+
+    // Longest safe interval between read_continuous() calls (two fields of margin).
+    uint32_t continuous_poll_period_ms() const { return (2 * cycle_us) / 1000; }
+
+    // Time until the sensor has produced the next two fields of the profile,
+    // which leaves one slot of its three-field buffer as margin.
+    uint32_t next_poll_delay_ms() const;
+
+    // Fields the sensor produced but which were overwritten before being drained.
+    uint32_t missed_samples() const { return missed_count; }
+
+    // True if the constructor used the calibration cached in RTC memory.
+    bool warm_started() const { return warm_start; }
+
+    // Time spent in the constructor bringing the sensor up, in microseconds.
+    int64_t init_time_us() const { return init_us; }
+
+    // esp_timer time (microseconds since boot) of the first sample, 0 until then.
+    int64_t first_sample_time_us() const { return first_sample_us; }
+
+    /**
+     * @brief Forgets the cached calibration so the next construction does a full init.
+     * Only needed if the sensor may be swapped while the chip is in deep sleep.
+     */
+    static void clear_calibration_cache();
+
+    BME688Interface interface() const { return link.intf; }
+    uint8_t address() const { return link.addr; }
+    i2c_port_t port() const { return link.port; }
+    int8_t mux_channel() const { return link.mux_channel; }
+    // Queue wait, bus time and errors of this sensor's I2C transactions.
+    I2CDeviceStats bus_stats() const { return link.sensor.stats(); }
+    // Transactions, bytes and SPI page switches issued by the Bosch driver, on either interface.
+    const bme68x_intf_stats &intf_stats() const { return dev.intf_stats; }
+
 private:
     /**
      * @brief I2C read function for the BME68x API.
@@ -75,17 +411,119 @@ private:
      */
     static int8_t bme68x_i2c_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr);
 
+    /**
+     * @brief SPI read and write functions for the BME68x API.
+     * reg_addr already carries the read/write bit; the driver selects the memory page.
+     */
+    static int8_t bme68x_spi_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr);
+    static int8_t bme68x_spi_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr);
+
     /**
      * @brief Delay function for the BME68x API.
      * This function is a static member and is passed to the Bosch API.
+     * The new-data polls and the soft reset sleep on the wake-up timer, so
+     * other tasks run while the sensor finishes.
      */
     static void bme68x_delay_us(uint32_t period, void *intf_ptr);
 
+    /**
+     * @brief esp_timer callback of a measurement started by start_measurement().
+     * Only notifies the readout task; the bus is never touched from the esp_timer task.
+     */
+    static void measurement_timer_cb(void *arg);
+    static void meas_task_entry(void *arg);
+    void run_meas_task();
+    bool start_meas_task();
+    void stop_meas_task();
+    void finish_measurement();
+    // Returns once every esp_timer callback dispatched before the call has returned.
+    void flush_timer_callbacks();
+
+    // Triggers a forced measurement and blocks until it is complete.
+    bool run_forced_measurement();
+    // Sleeps until the esp_timer time deadline_us, with microsecond resolution.
+    void wait_until(int64_t deadline_us);
+    static void wake_timer_cb(void *arg);
+    // Adds a completed forced read to the wake-up statistics.
+    void note_completion(uint32_t polls_before);
+
+    // Starts a forced read, with or without gas per the cadence, and returns its duration.
+    int8_t trigger_forced(uint32_t &period_us);
+    // Caches the ctrl_gas_1 values that turn the gas measurement on and off.
+    bool load_gas_regs();
+
+    void save_calibration_cache();
+
+    // Opens the link of the configured interface.
+    bool open_i2c(const BME688Config &config);
+    bool open_spi(const BME688Config &config);
+
+    // Per-port lock reference counting and transaction locking.
+    static bool acquire_bus(const BME688Config &config);
+    static void release_bus(i2c_port_t port);
+    static bool lock_bus(BME688Link &link);
+    static void unlock_bus(const BME688Link &link);
+    void note_first_sample();
+
+    // Resets the drain state after the sensor entered parallel/sequential mode.
+    void begin_continuous(uint8_t mode, uint8_t len);
+    // Reads up to three new fields and updates the gap counter and last_* values.
+    int fetch_fields(struct bme68x_data *data);
+
     struct bme68x_dev dev;
     struct bme68x_conf conf;
     struct bme68x_heatr_conf heatr_conf;
-    uint8_t dev_addr;
-    bool ok;
+    BME688Mode mode = BME688_MODE_DEFAULT;
+    const BME688ModeSettings *settings;
+
+    // Gas cadence
+    uint16_t gas_every = 1;
+    uint32_t forced_count = 0;
+    uint8_t ctrl_gas_on = 0;
+    uint8_t ctrl_gas_off = 0;
+    bool gas_armed = false;             // run_gas currently set in the sensor
+    bool cycle_gas = false;             // the read in flight measures gas
+    BME688Link link;
+    bool bus_acquired = false;
+    bool ok = false;
+
+    // Bring-up latency
+    bool warm_start = false;
+    int64_t init_us = 0;
+    int64_t first_sample_us = 0;
+
+    // Precise wake-up of blocking forced reads
+    esp_timer_handle_t wake_timer = nullptr;
+    SemaphoreHandle_t wake_sem = nullptr;
+    int64_t meas_deadline_us = 0;       // computed completion time of the read in flight
+    BME688WakeStats wake = {};
+
+    // Non-blocking forced measurement state
+    esp_timer_handle_t meas_timer = nullptr;
+    QueueHandle_t meas_queue = nullptr;
+    TaskHandle_t meas_task = nullptr;
+    SemaphoreHandle_t meas_lock = nullptr;      // held by the readout task while it uses the sensor
+    SemaphoreHandle_t meas_exited = nullptr;
+    bool meas_closing = false;                  // set under meas_lock; no more readouts or re-arms
+    uint32_t meas_polls = 0;                    // data_polls when the measurement was started
+    uint32_t meas_poll_us = 0;
+    uint8_t meas_polls_left = 0;
+    volatile bool measuring = false;
+    uint32_t dropped_count = 0;
+
+    // Parallel/sequential-mode (continuous) acquisition state
+    uint16_t temp_prof[BME688_MAX_PROFILE_LEN];
+    uint16_t mul_prof[BME688_MAX_PROFILE_LEN];
+    uint32_t field_us[BME688_MAX_PROFILE_LEN];   // time the sensor spends on a field of each step
+    uint8_t profile_len = 0;
+    uint8_t cont_mode = BME68X_PARALLEL_MODE;
+    bool continuous = false;
+    uint32_t cycle_us = 0;
+    uint8_t last_gas_index = 0;
+    BME688Fingerprint pending_fp = {};
+    bool have_meas_index = false;
+    uint8_t last_meas_index = 0;
+    uint32_t missed_count = 0;
 };
 
 #endif // BME688_LIB_H
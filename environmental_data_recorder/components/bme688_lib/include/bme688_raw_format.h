@@ -0,0 +1,108 @@
+#ifndef BME688_RAW_FORMAT_H
+#define BME688_RAW_FORMAT_H
+
+// On-disk layout of raw BME688 capture files.
+// This header only depends on the Bosch definitions so the host-side reader
+// (tools/bme688_raw_reader.cpp) can share it with the firmware.
+//
+// A capture file is a sequence of fixed-size blocks, each starting with a tag
+// byte. Every log segment starts with a calibration block holding the
+// sensor's coefficient registers, followed by one sample block per field.
+// Multi-byte values are little endian.
+//
+// Both blocks carry the session id, a random number the firmware picks at
+// boot. A preallocated segment can hold data of an earlier boot past the last
+// record, with the same layout; its blocks carry another session id.
+//
+// Calibration block (BME688_RAW_CALIB_LEN bytes):
+//   [0] 'C'  [1] format version  [2] variant id  [3] reserved  [4..7] session id
+//   [8 .. 8 + BME68X_LEN_COEFF_ALL) coefficient registers, as read by bme68x_get_calib_regs()
+//
+// Sample block (BME688_RAW_SAMPLE_LEN bytes):
+//   [0] 'S'  [1..4] timestamp in ms  [5] status | gas_index  [6] meas_index
+//   [7..11] pres_adc (bits 0..19) and temp_adc (bits 20..39)
+//   [12..13] hum_adc  [14..15] gas_adc (bits 4..13) and gas_range (bits 0..3)
+//   [16..19] session id
+
+#include <stdint.h>
+#include "bme68x_defs.h"
+
+#define BME688_RAW_TAG_CALIB 'C'
+#define BME688_RAW_TAG_SAMPLE 'S'
+#define BME688_RAW_VERSION 2
+#define BME688_RAW_CALIB_LEN (8 + BME68X_LEN_COEFF_ALL)
+#define BME688_RAW_SAMPLE_LEN 20
+
+inline void bme688_raw_put32(uint8_t *out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+inline uint32_t bme688_raw_get32(const uint8_t *in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+inline void bme688_raw_encode_calib(uint8_t *out, uint32_t session_id, const uint8_t *coeff, uint8_t variant_id) {
+    out[0] = BME688_RAW_TAG_CALIB;
+    out[1] = BME688_RAW_VERSION;
+    out[2] = variant_id;
+    out[3] = 0;
+    bme688_raw_put32(&out[4], session_id);
+    for (int i = 0; i < BME68X_LEN_COEFF_ALL; i++) {
+        out[8 + i] = coeff[i];
+    }
+}
+
+// Returns false if the block is not a calibration block of a known version.
+inline bool bme688_raw_decode_calib(const uint8_t *in, uint32_t &session_id, uint8_t *coeff, uint8_t &variant_id) {
+    if (in[0] != BME688_RAW_TAG_CALIB || in[1] != BME688_RAW_VERSION) return false;
+    variant_id = in[2];
+    session_id = bme688_raw_get32(&in[4]);
+    for (int i = 0; i < BME68X_LEN_COEFF_ALL; i++) {
+        coeff[i] = in[8 + i];
+    }
+    return true;
+}
+
+inline void bme688_raw_encode_sample(uint8_t *out, uint32_t session_id, uint32_t timestamp_ms,
+                                     const bme68x_raw_data &raw) {
+    uint64_t adc = (uint64_t)(raw.pres_adc & 0xFFFFF) | ((uint64_t)(raw.temp_adc & 0xFFFFF) << 20);
+    uint16_t gas = (uint16_t)(((raw.gas_adc & 0x3FF) << 4) | (raw.gas_range & BME68X_GAS_RANGE_MSK));
+
+    out[0] = BME688_RAW_TAG_SAMPLE;
+    bme688_raw_put32(&out[1], timestamp_ms);
+    // new_data, gasm_valid and heat_stab do not overlap the gas index bits
+    out[5] = (uint8_t)(raw.status | (raw.gas_index & BME68X_GAS_INDEX_MSK));
+    out[6] = raw.meas_index;
+    for (int i = 0; i < 5; i++) {
+        out[7 + i] = (uint8_t)(adc >> (8 * i));
+    }
+    out[12] = (uint8_t)raw.hum_adc;
+    out[13] = (uint8_t)(raw.hum_adc >> 8);
+    out[14] = (uint8_t)gas;
+    out[15] = (uint8_t)(gas >> 8);
+    bme688_raw_put32(&out[16], session_id);
+}
+
+inline void bme688_raw_decode_sample(const uint8_t *in, uint32_t &session_id, uint32_t &timestamp_ms,
+                                     bme68x_raw_data &raw) {
+    uint64_t adc = 0;
+    uint16_t gas = (uint16_t)(in[14] | (in[15] << 8));
+
+    timestamp_ms = bme688_raw_get32(&in[1]);
+    session_id = bme688_raw_get32(&in[16]);
+    for (int i = 0; i < 5; i++) {
+        adc |= (uint64_t)in[7 + i] << (8 * i);
+    }
+    raw.status = in[5] & (uint8_t)~BME68X_GAS_INDEX_MSK;
+    raw.gas_index = in[5] & BME68X_GAS_INDEX_MSK;
+    raw.meas_index = in[6];
+    raw.pres_adc = (uint32_t)(adc & 0xFFFFF);
+    raw.temp_adc = (uint32_t)((adc >> 20) & 0xFFFFF);
+    raw.hum_adc = (uint16_t)(in[12] | (in[13] << 8));
+    raw.gas_adc = gas >> 4;
+    raw.gas_range = gas & BME68X_GAS_RANGE_MSK;
+}
+
+#endif // BME688_RAW_FORMAT_H
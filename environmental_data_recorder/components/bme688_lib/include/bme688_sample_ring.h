@@ -0,0 +1,79 @@
+#ifndef BME688_SAMPLE_RING_H
+#define BME688_SAMPLE_RING_H
+
+// Sample type and ring buffer of BME688 continuous acquisition.
+// This header only depends on the C++ standard library so the host-side
+// test (tools/bme688_continuous_sim.cpp) can share it with the firmware.
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @struct BME688Sample
+ * @brief One measurement field, in the same units as the BME688 last_* members.
+ */
+struct BME688Sample {
+    int64_t timestamp_ms;   // esp_timer time when the field was drained
+    float temperature;      // degC
+    float pressure;         // hPa
+    float humidity;         // %
+    float gas_resistance;   // KOhms
+    uint8_t status;         // new_data / gasm_valid / heat_stab bits
+    uint8_t gas_index;      // heater profile step that produced the field
+    uint8_t meas_index;     // sensor sub-measurement index (wraps at 256)
+};
+
+/**
+ * @class BME688SampleRing
+ * @brief Fixed-capacity ring buffer over caller-owned storage.
+ * Single producer, single consumer, which may run in different tasks or on
+ * different cores: each side publishes its index with a release store after
+ * touching the slot, and loads the other side's index with acquire. When the
+ * ring is full push() refuses the sample and counts an overrun instead of
+ * overwriting unread data.
+ */
+class BME688SampleRing {
+public:
+    BME688SampleRing(BME688Sample *storage, size_t capacity)
+        : buf(storage), cap(capacity), head(0), tail(0), overrun_count(0) {}
+
+    bool push(const BME688Sample &sample) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (distance(h, tail.load(std::memory_order_acquire)) >= cap) {
+            overrun_count.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        buf[h % cap] = sample;
+        head.store(next(h), std::memory_order_release);
+        return true;
+    }
+
+    bool pop(BME688Sample &sample) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t) return false;
+        sample = buf[t % cap];
+        tail.store(next(t), std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return distance(head.load(std::memory_order_acquire), tail.load(std::memory_order_acquire));
+    }
+    size_t capacity() const { return cap; }
+    size_t free_space() const { return cap - size(); }
+    uint32_t overruns() const { return overrun_count.load(std::memory_order_relaxed); }
+
+private:
+    // Indices run over [0, 2 * capacity) so a full ring is distinguishable from an empty one.
+    size_t next(size_t index) const { return (index + 1) % (2 * cap); }
+    size_t distance(size_t h, size_t t) const { return (h + 2 * cap - t) % (2 * cap); }
+
+    BME688Sample *buf;
+    size_t cap;
+    std::atomic<size_t> head;           // written by the producer only
+    std::atomic<size_t> tail;           // written by the consumer only
+    std::atomic<uint32_t> overrun_count;
+};
+
+#endif // BME688_SAMPLE_RING_H
@@ -0,0 +1,62 @@
+#ifndef BME688_SCHEDULER_H
+#define BME688_SCHEDULER_H
+
+#include "bme688_lib.h"
+#include "bme688_scheduler_policy.h"
+
+/**
+ * @class BME688Scheduler
+ * @brief Keeps several BME688 sensors measuring back to back.
+ * Every sensor runs forced measurements through start_measurement(), so its
+ * heater wait is a timer rather than a blocked task. While one sensor heats,
+ * the bus is free to trigger or read out the others, and the total sample
+ * rate grows with the number of sensors until the bus itself is busy.
+ * Which sensor starts when is BME688SchedulerPolicy (bme688_scheduler_policy.h).
+ */
+class BME688Scheduler {
+public:
+    /**
+     * @param sensors Sensors to drive; they must outlive the scheduler.
+     * @param count Number of sensors (1..BME688_SCHEDULER_MAX_SENSORS).
+     */
+    BME688Scheduler(BME688 *const *sensors, size_t count);
+    ~BME688Scheduler();
+
+    /**
+     * @brief Starts the scheduler task.
+     * @param out_queue Queue created with item size sizeof(BME688Completion);
+     *        every finished measurement of every sensor is posted to it.
+     * @param priority FreeRTOS priority of the scheduler task.
+     * @return true if the task is running.
+     */
+    bool start(QueueHandle_t out_queue, UBaseType_t priority = 5);
+
+    /**
+     * @brief Stops re-triggering and waits for measurements in flight to finish.
+     */
+    void stop();
+
+    bool is_running() const { return task != nullptr; }
+
+    // Measurements posted to the output queue since start().
+    uint32_t samples() const { return sample_count; }
+
+    // Completions dropped because the output queue was full.
+    uint32_t dropped() const { return dropped_count; }
+
+private:
+    static void task_entry(void *arg);
+    void run();
+
+    BME688 *sensors[BME688_SCHEDULER_MAX_SENSORS];
+    size_t sensor_count = 0;
+    QueueHandle_t done_queue = nullptr;     // completions from the sensors' timers
+    QueueHandle_t out_queue = nullptr;
+    TaskHandle_t task = nullptr;
+    SemaphoreHandle_t stopped = nullptr;
+    volatile bool stopping = false;
+    volatile uint32_t sample_count = 0;
+    volatile uint32_t dropped_count = 0;
+};
+
+#endif // BME688_SCHEDULER_H
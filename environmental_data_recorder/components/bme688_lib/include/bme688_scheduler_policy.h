@@ -0,0 +1,84 @@
+#ifndef BME688_SCHEDULER_POLICY_H
+#define BME688_SCHEDULER_POLICY_H
+
+// Re-trigger policy of BME688Scheduler, apart from the driver and FreeRTOS.
+// This header only depends on the C standard headers, so the host-side
+// simulation (tools/bme688_scheduler_sim.cpp) runs the same code as the
+// scheduler task, against simulated sensors.
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Maximum number of sensors one scheduler drives
+#define BME688_SCHEDULER_MAX_SENSORS 8
+
+/**
+ * @class BME688SchedulerPolicy
+ * @brief Which sensors the scheduler loop starts, and when it may end.
+ * Sensor needs bool start_measurement(Queue), which starts one measurement
+ * whose completion is posted to the queue. Every sensor has at most one
+ * measurement in flight and is re-triggered from its completion. A sensor
+ * whose start fails is idle and retried on every pass of the loop. Once
+ * stopping, nothing is started and the loop runs until the measurements in
+ * flight are in.
+ */
+template <class Sensor, class Queue>
+class BME688SchedulerPolicy {
+public:
+    BME688SchedulerPolicy(Sensor *const *sensors, size_t count, Queue done_queue)
+        : sensors(sensors), count(count), done_queue(done_queue) {}
+
+    // Starts every sensor; returns how many started.
+    size_t start_all() {
+        for (size_t i = 0; i < count; i++) {
+            start(i);
+        }
+        return in_flight;
+    }
+
+    // A completion of sensor came in; re-triggers it unless stopping.
+    void completed(Sensor *sensor, bool stopping) {
+        in_flight--;
+        if (stopping) return;
+        for (size_t i = 0; i < count; i++) {
+            if (sensors[i] == sensor) {
+                start(i);
+                return;
+            }
+        }
+    }
+
+    // Retries the sensors whose last start failed, unless stopping.
+    void retry_idle(bool stopping) {
+        if (idle == 0 || stopping) return;
+        for (size_t i = 0; i < count; i++) {
+            if (idle & (1u << i)) start(i);
+        }
+    }
+
+    // True while the scheduler loop has to keep running.
+    bool running(bool stopping) const { return !stopping || in_flight > 0; }
+
+    size_t measurements_in_flight() const { return in_flight; }
+
+    // Bit i set while sensor i is idle.
+    uint32_t idle_sensors() const { return idle; }
+
+private:
+    void start(size_t i) {
+        if (sensors[i]->start_measurement(done_queue)) {
+            idle &= ~(1u << i);
+            in_flight++;
+        } else {
+            idle |= 1u << i;
+        }
+    }
+
+    Sensor *const *sensors;
+    size_t count;
+    Queue done_queue;
+    size_t in_flight = 0;
+    uint32_t idle = 0;
+};
+
+#endif // BME688_SCHEDULER_POLICY_H
@@ -0,0 +1,101 @@
+#ifndef I2C_BUS_POLICY_H
+#define I2C_BUS_POLICY_H
+
+// Scheduling policy of the shared I2C bus, apart from the driver and FreeRTOS.
+// This header only depends on the C standard headers, so the host-side
+// simulations (tools/i2c_arbiter_sim.cpp, tools/i2c_fault_sim.cpp) and
+// tools/i2c_bus_policy_test.cpp run the same code as i2c_bus_lib.
+
+#include <stddef.h>
+#include <stdint.h>
+
+// After a timeout a device's calls fail with ESP_ERR_INVALID_STATE without
+// touching the bus for two deadlines, doubling with every further timeout in
+// a row up to this limit, so a dead slave takes little bus time from the others.
+#define I2C_BUS_BACKOFF_MAX_MS 1000
+
+// Arbiter queue a device's transactions go to. With an arbiter running, a
+// queued HIGH transaction always runs before NORMAL and LOW ones; a
+// transaction already on the wire is never interrupted.
+enum I2CPriority {
+    I2C_PRIO_HIGH,          // latency-sensitive sensor reads
+    I2C_PRIO_NORMAL,
+    I2C_PRIO_LOW,           // polling and bulk transfers
+    I2C_PRIO_COUNT,
+};
+
+/**
+ * @class I2CArbiterQueue
+ * @brief Items waiting for the bus, one FIFO of up to N per priority level.
+ * pop() takes the oldest item of the highest level that has one. Not thread
+ * safe; the arbiter guards it with a lock.
+ */
+template <class T, size_t N>
+class I2CArbiterQueue {
+public:
+    // Returns false if the item's level is full.
+    bool push(I2CPriority prio, const T &item) {
+        if (count[prio] == N) return false;
+        items[prio][(head[prio] + count[prio]) % N] = item;
+        count[prio]++;
+        return true;
+    }
+
+    // Returns false if every level is empty.
+    bool pop(T &item, I2CPriority *prio = nullptr) {
+        for (int p = 0; p < I2C_PRIO_COUNT; p++) {
+            if (count[p] == 0) continue;
+            item = items[p][head[p]];
+            head[p] = (head[p] + 1) % N;
+            count[p]--;
+            if (prio != nullptr) *prio = (I2CPriority)p;
+            return true;
+        }
+        return false;
+    }
+
+    size_t size(I2CPriority prio) const { return count[prio]; }
+
+    bool empty() const {
+        for (int p = 0; p < I2C_PRIO_COUNT; p++) {
+            if (count[p] > 0) return false;
+        }
+        return true;
+    }
+
+private:
+    T items[I2C_PRIO_COUNT][N];
+    size_t head[I2C_PRIO_COUNT] = {};
+    size_t count[I2C_PRIO_COUNT] = {};
+};
+
+/**
+ * @struct I2CBackoff
+ * @brief Per-device backoff after deadline overruns (I2C_BUS_BACKOFF_MAX_MS).
+ * Times are esp_timer microseconds.
+ */
+struct I2CBackoff {
+    uint32_t timeouts_in_row = 0;
+    int64_t until_us = 0;
+
+    // True while the device's calls are refused.
+    bool active(int64_t now_us) const { return now_us < until_us; }
+
+    // A transaction overran its deadline and ended at end_us.
+    void timed_out(int64_t end_us, int deadline_ms) {
+        // Two deadlines, doubled per further timeout in a row.
+        const int64_t max_us = I2C_BUS_BACKOFF_MAX_MS * 1000LL;
+        int64_t backoff_us = 2 * (int64_t)deadline_ms * 1000;
+        for (uint32_t i = 0; i < timeouts_in_row && backoff_us < max_us; i++) {
+            backoff_us *= 2;
+        }
+        if (backoff_us > max_us) backoff_us = max_us;
+        timeouts_in_row++;
+        until_us = end_us + backoff_us;
+    }
+
+    // A transaction completed; other errors leave the count as it is.
+    void succeeded() { timeouts_in_row = 0; }
+};
+
+#endif // I2C_BUS_POLICY_H
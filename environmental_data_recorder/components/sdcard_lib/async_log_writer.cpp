@@ -0,0 +1,420 @@
+#include "async_log_writer.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/unistd.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "ASYNC_LOG";
+
+// Word alignment is what the SD host DMA needs to read a buffer in place
+#define ASYNC_LOG_BUFFER_ALIGN 4
+
+// Segment names tried before start() gives up: log.txt, log.1.txt ... log.999.txt
+#define ASYNC_LOG_MAX_SEGMENTS 1000
+
+static const int STOP_INDEX = -1;
+
+// Guards the stats of every writer: the producer and the writer task both update them
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Relative path of segment n: the path itself, then the number before the extension
+static void segment_path(char *out, size_t len, const char *path, int n) {
+    const char *slash = strrchr(path, '/');
+    const char *dot = strrchr(slash != nullptr ? slash : path, '.');
+    if (n == 0) {
+        snprintf(out, len, "%s", path);
+    } else if (dot == nullptr) {
+        snprintf(out, len, "%s.%d", path, n);
+    } else {
+        snprintf(out, len, "%.*s.%d%s", (int)(dot - path), path, n, dot);
+    }
+}
+
+AsyncLogWriter::AsyncLogWriter(SDCard &card, const char *path, const AsyncLogWriterConfig &config)
+    : card(card), config(config) {
+    snprintf(full_path, sizeof(full_path), "%s/%s", card.getMountPoint(), path);
+    snprintf(rel_path, sizeof(rel_path), "%s", path);
+    // Whole sectors, and at least two, so that any record that fits fits across two buffers
+    size_t size = (config.bufferSize + ASYNC_LOG_SECTOR_SIZE - 1) & ~(size_t)(ASYNC_LOG_SECTOR_SIZE - 1);
+    this->config.bufferSize = size < 2 * ASYNC_LOG_SECTOR_SIZE ? 2 * ASYNC_LOG_SECTOR_SIZE : size;
+    // Whole sectors, and at least one buffer, so that a header and any record fit in a fresh segment
+    uint32_t segment = (config.segmentBytes + ASYNC_LOG_SECTOR_SIZE - 1) & ~(uint32_t)(ASYNC_LOG_SECTOR_SIZE - 1);
+    if (segment > 0 && segment < this->config.bufferSize) {
+        segment = (uint32_t)this->config.bufferSize;
+    }
+    this->config.segmentBytes = segment;
+}
+
+AsyncLogWriter::~AsyncLogWriter() {
+    stop();
+}
+
+// Open the file for appending and start the writer task
+esp_err_t AsyncLogWriter::start() {
+    if (task != nullptr) {
+        return ESP_OK;
+    }
+    if (!card.isMounted()) {
+        ESP_LOGE(TAG, "SD card is not mounted. Cannot open %s.", full_path);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (config.segmentBytes > 0) {
+        if (!openSegment(0)) {
+            return ESP_FAIL;
+        }
+        offset = 0;
+    } else {
+        fd = open(full_path, O_WRONLY | O_CREAT | O_APPEND, 0666);
+        if (fd < 0) {
+            ESP_LOGE(TAG, "Failed to open %s for appending (errno=%d: %s)", full_path, errno, strerror(errno));
+            return ESP_FAIL;
+        }
+        struct stat st;
+        offset = (fstat(fd, &st) == 0) ? (uint64_t)st.st_size : 0;
+    }
+
+    esp_err_t ret = ESP_OK;
+    free_queue = xQueueCreate(ASYNC_LOG_BUFFERS, sizeof(int));
+    full_queue = xQueueCreate(ASYNC_LOG_BUFFERS + 1, sizeof(int));
+    stopped = xSemaphoreCreateBinary();
+    if (free_queue == nullptr || full_queue == nullptr || stopped == nullptr) {
+        ret = ESP_ERR_NO_MEM;
+    }
+    for (int i = 0; i < ASYNC_LOG_BUFFERS && ret == ESP_OK; i++) {
+        buffers[i] = (uint8_t *)heap_caps_aligned_alloc(ASYNC_LOG_BUFFER_ALIGN, config.bufferSize,
+                                                        MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+        if (buffers[i] == nullptr) {
+            ESP_LOGE(TAG, "No memory for %d buffers of %u bytes", ASYNC_LOG_BUFFERS, (unsigned)config.bufferSize);
+            ret = ESP_ERR_NO_MEM;
+        } else {
+            xQueueSend(free_queue, &i, 0);
+        }
+    }
+    if (ret == ESP_OK &&
+        xTaskCreatePinnedToCore(taskEntry, "async_log", config.stackSize, this, config.priority, &task,
+                                config.core) != pdPASS) {
+        task = nullptr;
+        ret = ESP_ERR_NO_MEM;
+    }
+    if (ret != ESP_OK) {
+        stop();
+        return ret;
+    }
+    current = -1;
+    fill = 0;
+    header_due = true;
+    if (config.core == tskNO_AFFINITY) {
+        ESP_LOGI(TAG, "Writing %s from a task on any core, %d x %u byte buffers", full_path, ASYNC_LOG_BUFFERS,
+                 (unsigned)config.bufferSize);
+    } else {
+        ESP_LOGI(TAG, "Writing %s from a task on core %d, %d x %u byte buffers", full_path, (int)config.core,
+                 ASYNC_LOG_BUFFERS, (unsigned)config.bufferSize);
+    }
+    return ESP_OK;
+}
+
+// Hand over the partial buffer, write everything, trim, fsync, close and end the task
+void AsyncLogWriter::stop() {
+    if (task != nullptr) {
+        flush();
+        int stop_index = STOP_INDEX;
+        xQueueSend(full_queue, &stop_index, portMAX_DELAY);
+        xSemaphoreTake(stopped, portMAX_DELAY);
+        task = nullptr;
+    }
+    if (fd >= 0) {
+        // Give the unwritten tail of the last segment back to the volume
+        bool trimmed = config.segmentBytes == 0 || ftruncate(fd, segment_pos) == 0;
+        if (!trimmed) {
+            ESP_LOGE(TAG, "Failed to trim %s (errno=%d: %s)", full_path, errno, strerror(errno));
+        }
+        bool synced = fsync(fd) == 0;
+        portENTER_CRITICAL(&stats_lock);
+        stats.writeErrors += !trimmed + !synced;
+        stats.syncs += synced;
+        portEXIT_CRITICAL(&stats_lock);
+        ::close(fd);
+        fd = -1;
+    }
+    for (int i = 0; i < ASYNC_LOG_BUFFERS; i++) {
+        heap_caps_free(buffers[i]);
+        buffers[i] = nullptr;
+    }
+    if (free_queue != nullptr) {
+        vQueueDelete(free_queue);
+        free_queue = nullptr;
+    }
+    if (full_queue != nullptr) {
+        vQueueDelete(full_queue);
+        full_queue = nullptr;
+    }
+    if (stopped != nullptr) {
+        vSemaphoreDelete(stopped);
+        stopped = nullptr;
+    }
+    current = -1;
+    fill = 0;
+}
+
+// Take a free buffer, waiting up to overflowWaitMs if both are with the writer task
+bool AsyncLogWriter::acquire(int &index) {
+    if (xQueueReceive(free_queue, &index, 0) == pdTRUE) {
+        return true;
+    }
+    portENTER_CRITICAL(&stats_lock);
+    stats.overflows++;
+    portEXIT_CRITICAL(&stats_lock);
+    if (config.overflowWaitMs == 0) {
+        return false;
+    }
+    int64_t start = esp_timer_get_time();
+    bool ok = xQueueReceive(free_queue, &index, pdMS_TO_TICKS(config.overflowWaitMs)) == pdTRUE;
+    uint32_t waited = (uint32_t)(esp_timer_get_time() - start);
+    portENTER_CRITICAL(&stats_lock);
+    if (waited > stats.maxWaitUs) {
+        stats.maxWaitUs = waited;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+    return ok;
+}
+
+// Start filling a buffer, sized to end on the next sector boundary past a
+// full buffer or at the end of the segment, headed by the segment header if due
+void AsyncLogWriter::beginBuffer(int index) {
+    current = index;
+    fill = 0;
+    starts_segment[index] = false;
+    capacity = config.bufferSize - (size_t)(offset % ASYNC_LOG_SECTOR_SIZE);
+    if (config.segmentBytes > 0 && config.segmentBytes - offset < capacity) {
+        capacity = (size_t)(config.segmentBytes - offset);
+    }
+    if (header_due) {
+        header_due = false;
+        if (config.segmentHeader != nullptr) {
+            size_t len = config.segmentHeader(buffers[index], ASYNC_LOG_SECTOR_SIZE, config.segmentHeaderArg);
+            fill = len < ASYNC_LOG_SECTOR_SIZE ? len : ASYNC_LOG_SECTOR_SIZE;
+            oldest_us = esp_timer_get_time();
+        }
+    }
+}
+
+// Hand the current buffer to the writer task
+void AsyncLogWriter::submit() {
+    used[current] = fill;
+    offset += fill;
+    xQueueSend(full_queue, &current, 0);
+    uint32_t queued = (uint32_t)uxQueueMessagesWaiting(full_queue);
+    portENTER_CRITICAL(&stats_lock);
+    if (queued > stats.maxQueued) {
+        stats.maxQueued = queued;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+    current = -1;
+    fill = 0;
+}
+
+void AsyncLogWriter::drop(size_t len) {
+    portENTER_CRITICAL(&stats_lock);
+    stats.droppedRecords++;
+    stats.droppedBytes += len;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+// Queue a record of up to bufferSize - ASYNC_LOG_SECTOR_SIZE bytes
+bool AsyncLogWriter::write(const void *data, size_t len) {
+    if (task == nullptr || len == 0 || len > config.bufferSize - ASYNC_LOG_SECTOR_SIZE) {
+        drop(len);
+        return false;
+    }
+    if (config.segmentBytes > 0 && offset + fill + len > config.segmentBytes) {
+        // The record does not fit in this segment; it starts the next one
+        int index;
+        if (!acquire(index)) {
+            drop(len);
+            return false;
+        }
+        if (current >= 0) {
+            submit();
+        }
+        offset = 0;
+        header_due = true;
+        beginBuffer(index);
+        starts_segment[index] = true;
+    } else if (current < 0) {
+        int index;
+        if (!acquire(index)) {
+            drop(len);
+            return false;
+        }
+        beginBuffer(index);
+    }
+
+    const uint8_t *src = (const uint8_t *)data;
+    size_t room = capacity - fill;
+    if (fill == 0) {
+        oldest_us = esp_timer_get_time();
+    }
+    if (len < room) {
+        memcpy(buffers[current] + fill, src, len);
+        fill += len;
+    } else {
+        // The record fills this buffer; take the next one first, so the
+        // record is either queued whole or dropped whole
+        int next = -1;
+        if (len > room && !acquire(next)) {
+            drop(len);
+            return false;
+        }
+        memcpy(buffers[current] + fill, src, room);
+        fill += room;
+        submit();
+        if (next >= 0) {
+            beginBuffer(next);
+            memcpy(buffers[current], src + room, len - room);
+            fill = len - room;
+            oldest_us = esp_timer_get_time();
+        }
+    }
+    portENTER_CRITICAL(&stats_lock);
+    stats.records++;
+    stats.bytes += len;
+    portEXIT_CRITICAL(&stats_lock);
+    return true;
+}
+
+// Queue a line of text
+bool AsyncLogWriter::write(const char *line) {
+    return write(line, strlen(line));
+}
+
+// Hand over the partial buffer once its oldest record is flushAgeMs old
+void AsyncLogWriter::poll() {
+    if (current >= 0 && fill > 0 && config.flushAgeMs > 0 &&
+        esp_timer_get_time() - oldest_us >= (int64_t)config.flushAgeMs * 1000) {
+        submit();
+    }
+}
+
+// Hand over the partial buffer now
+void AsyncLogWriter::flush() {
+    if (current >= 0 && fill > 0) {
+        submit();
+    }
+}
+
+AsyncLogWriterStats AsyncLogWriter::getStats() const {
+    portENTER_CRITICAL(&stats_lock);
+    AsyncLogWriterStats copy = stats;
+    portEXIT_CRITICAL(&stats_lock);
+    return copy;
+}
+
+// Open the first unused segment from first_index on, allocated contiguously
+bool AsyncLogWriter::openSegment(int first_index) {
+    char path[sizeof(rel_path) + 8];
+    for (int n = first_index; n < ASYNC_LOG_MAX_SEGMENTS; n++) {
+        segment_path(path, sizeof(path), rel_path, n);
+        snprintf(full_path, sizeof(full_path), "%s/%s", card.getMountPoint(), path);
+        struct stat st;
+        if (stat(full_path, &st) == 0 && st.st_size > 0) {
+            continue;
+        }
+        if (card.createContiguousFile(path, config.segmentBytes) != ESP_OK) {
+            ESP_LOGW(TAG, "%s is not preallocated, it grows as it is written", full_path);
+        }
+        fd = open(full_path, O_WRONLY | O_CREAT, 0666);
+        if (fd < 0) {
+            ESP_LOGE(TAG, "Failed to open %s (errno=%d: %s)", full_path, errno, strerror(errno));
+            return false;
+        }
+        segment_index = n;
+        segment_pos = 0;
+        portENTER_CRITICAL(&stats_lock);
+        stats.segments++;
+        portEXIT_CRITICAL(&stats_lock);
+        ESP_LOGI(TAG, "Logging to %s, %lu bytes preallocated", full_path, (unsigned long)config.segmentBytes);
+        return true;
+    }
+    ESP_LOGE(TAG, "No unused segment name left for %s", rel_path);
+    return false;
+}
+
+// Close the segment, trimmed to what was written, and open the next one
+bool AsyncLogWriter::nextSegment() {
+    if (fd >= 0) {
+        bool trimmed = segment_pos == config.segmentBytes || ftruncate(fd, segment_pos) == 0;
+        if (!trimmed) {
+            ESP_LOGE(TAG, "Failed to trim %s (errno=%d: %s)", full_path, errno, strerror(errno));
+        }
+        bool synced = fsync(fd) == 0;
+        portENTER_CRITICAL(&stats_lock);
+        stats.writeErrors += !trimmed;
+        stats.syncs += synced;
+        portEXIT_CRITICAL(&stats_lock);
+        ::close(fd);
+        fd = -1;
+    }
+    return openSegment(segment_index + 1);
+}
+
+void AsyncLogWriter::taskEntry(void *arg) {
+    static_cast<AsyncLogWriter *>(arg)->run();
+    vTaskDelete(NULL);
+}
+
+// Writer task: one write() per buffer, fsync per fsyncIntervalMs
+void AsyncLogWriter::run() {
+    int64_t last_sync_us = esp_timer_get_time();
+    bool dirty = false;
+    TickType_t idle_wait = config.fsyncIntervalMs > 0 ? pdMS_TO_TICKS(config.fsyncIntervalMs) : portMAX_DELAY;
+    while (true) {
+        int index;
+        if (xQueueReceive(full_queue, &index, dirty ? idle_wait : portMAX_DELAY) == pdTRUE) {
+            if (index == STOP_INDEX) {
+                break;
+            }
+            int64_t start = esp_timer_get_time();
+            bool ok = !starts_segment[index] || nextSegment();
+            if (ok) {
+                ssize_t written = ::write(fd, buffers[index], used[index]);
+                ok = written == (ssize_t)used[index];
+                if (ok) {
+                    segment_pos += used[index];
+                } else {
+                    ESP_LOGE(TAG, "Short write to %s: %d of %u bytes (errno=%d: %s)", full_path, (int)written,
+                             (unsigned)used[index], errno, strerror(errno));
+                }
+            }
+            uint32_t took = (uint32_t)(esp_timer_get_time() - start);
+            portENTER_CRITICAL(&stats_lock);
+            stats.writeErrors += !ok;
+            if (took > stats.maxWriteUs) {
+                stats.maxWriteUs = took;
+            }
+            stats.buffersWritten++;
+            portEXIT_CRITICAL(&stats_lock);
+            dirty = true;
+            xQueueSend(free_queue, &index, 0);
+        }
+        if (dirty && config.fsyncIntervalMs > 0 &&
+            esp_timer_get_time() - last_sync_us >= (int64_t)config.fsyncIntervalMs * 1000) {
+            bool synced = fsync(fd) == 0;
+            if (!synced) {
+                ESP_LOGE(TAG, "Failed to sync %s (errno=%d: %s)", full_path, errno, strerror(errno));
+            }
+            portENTER_CRITICAL(&stats_lock);
+            stats.syncs += synced;
+            stats.writeErrors += !synced;
+            portEXIT_CRITICAL(&stats_lock);
+            dirty = false;
+            last_sync_us = esp_timer_get_time();
+        }
+    }
+    xSemaphoreGive(stopped);
+}
@@ -0,0 +1,95 @@
+#ifndef LOG_APPENDER_H
+#define LOG_APPENDER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sdcard_lib.h"
+
+// Size of the stdio buffer of a LogAppender, a whole number of 512-byte sectors
+#define LOG_APPENDER_BUFFER_SIZE (8 * 1024)
+
+// Alignment of the stdio buffer; the SD host DMA reads word-aligned buffers in place
+#define LOG_APPENDER_BUFFER_ALIGN 4
+
+// Appenders that the shutdown handler flushes and syncs on esp_restart()
+#define LOG_APPENDER_MAX_OPEN 4
+
+// Flush and fsync policy of a LogAppender. A flush hands the buffered lines
+// to FatFs, which writes the data sectors; an fsync also writes the FAT and
+// the directory entry, so the new file size survives a power cut.
+struct LogAppenderConfig {
+    size_t bufferSize = LOG_APPENDER_BUFFER_SIZE;
+    size_t flushBytes = 4096;           // Flush once this many bytes are buffered, 0 = when the buffer fills
+    uint32_t flushAgeMs = 2000;         // Flush once the oldest buffered line is this old, 0 = never by age
+    uint32_t fsyncIntervalMs = 10000;   // fsync at most this often after a flush, 0 = only on close
+    bool flushOnShutdown = true;        // Flush and fsync from an esp_restart() shutdown handler
+};
+
+struct LogAppenderStats {
+    uint32_t lines;         // append() calls that succeeded
+    uint32_t bytes;         // Bytes appended
+    uint32_t flushes;       // fflush() calls that wrote buffered data
+    uint32_t syncs;         // fsync() calls
+    uint32_t errors;        // Failed writes, flushes and syncs
+};
+
+// Appends log lines to one file on the SD card, keeping it open between
+// lines. SDCard::writeFile() opens, writes and closes the file for every
+// line, and each of those walks the FAT chain and rewrites the directory
+// entry. Here lines collect in a large buffer and reach the card per
+// flushBytes, per flushAgeMs or on close(), and the directory entry is
+// rewritten only per fsyncIntervalMs.
+// Not thread safe: append from one task, or guard the appender with a mutex.
+class LogAppender {
+public:
+    // The card must be mounted before open() and outlive the appender
+    LogAppender(SDCard &card, const char *path, const LogAppenderConfig &config = LogAppenderConfig());
+
+    // Closes the file, flushing and syncing what is buffered
+    ~LogAppender();
+
+    // Open the file for appending, creating it if needed
+    esp_err_t open();
+
+    // Flush, fsync and close the file
+    void close();
+
+    bool isOpen() const { return file != nullptr; }
+
+    // Append a line (or any text) and apply the flush and fsync policy
+    bool append(const char *line);
+
+    // Append raw bytes and apply the flush and fsync policy. A record larger
+    // than the buffer goes straight to the file, after what was buffered.
+    bool append(const void *data, size_t len);
+
+    // Apply the age-based flush and the fsync cadence without appending.
+    // Call it from the logging loop when lines may stop arriving.
+    bool poll();
+
+    // Write the buffered lines to the card now
+    bool flush();
+
+    // Flush, then fsync so the FAT and the directory entry are current
+    bool sync();
+
+    LogAppenderStats getStats() const { return stats; }
+
+private:
+    bool applyPolicy(int64_t now_us);
+    static void shutdownHandler();
+
+    SDCard &card;
+    char full_path[128];
+    LogAppenderConfig config;
+    FILE *file = nullptr;
+    char *buffer = nullptr;
+    size_t pending = 0;             // Bytes appended since the last flush
+    int64_t oldest_us = 0;          // When the oldest unflushed byte was appended
+    int64_t last_sync_us = 0;
+    bool dirty = false;             // Flushed but not yet synced
+    LogAppenderStats stats = {};
+};
+
+#endif // LOG_APPENDER_H
@@ -0,0 +1,65 @@
+// Per-sample bus time of the BME688 at standard and fast-mode clocks.
+// To run it, select it under Environmental Data Recorder Configuration > Application in menuconfig.
+//
+// Opens the sensor address twice on the shared i2c_bus_lib bus, at 100 kHz
+// (the clock every driver used to share) and at I2C_MASTER_FREQ_HZ, and times
+// the transactions of one forced sample through each: the ctrl_meas trigger
+// write and the 17-byte field burst. The trigger writes back the sleep value,
+// so no measurement is started and only bus time is counted. Register reads of
+// 1 and 15 bytes are timed as well.
+
+#include "bme688_lib.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "BUS_SPEED_BENCH";
+
+#define BENCH_ROUNDS 500
+#define BENCH_SLOW_HZ 100000
+
+// Mean time of one trigger + field readout, or -1 if a transaction failed.
+static double time_sample(I2CDevice &dev, uint8_t ctrl_meas_sleep) {
+    uint8_t field[BME68X_LEN_FIELD];
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_ROUNDS; i++) {
+        if (dev.write_reg(BME68X_REG_CTRL_MEAS, &ctrl_meas_sleep, 1) != ESP_OK ||
+            dev.read_reg(BME68X_REG_FIELD0, field, BME68X_LEN_FIELD) != ESP_OK) {
+            return -1;
+        }
+    }
+    return (esp_timer_get_time() - start) / (double)BENCH_ROUNDS;
+}
+
+static double time_reads(I2CDevice &dev, size_t len) {
+    uint8_t buf[BME68X_LEN_FIELD];
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_ROUNDS; i++) {
+        if (dev.read_reg(BME68X_REG_FIELD0, buf, len) != ESP_OK) return -1;
+    }
+    return (esp_timer_get_time() - start) / (double)BENCH_ROUNDS;
+}
+
+extern "C" void app_main() {
+    // The sensor instance brings the chip up and puts it to sleep.
+    BME688 sensor;
+    I2CBusConfig bus;
+    bus.port = sensor.port();
+    I2CDevice slow, fast;
+    if (slow.open(bus, sensor.address(), BENCH_SLOW_HZ) != ESP_OK ||
+        fast.open(bus, sensor.address(), I2C_MASTER_FREQ_HZ) != ESP_OK) {
+        ESP_LOGE(TAG, "Opening the sensor address failed");
+        return;
+    }
+    uint8_t ctrl_meas = 0;
+    if (fast.read_reg(BME68X_REG_CTRL_MEAS, &ctrl_meas, 1) != ESP_OK) {
+        ESP_LOGE(TAG, "Reading ctrl_meas failed");
+        return;
+    }
+    ctrl_meas &= (uint8_t)~BME68X_MODE_MSK;
+
+    ESP_LOGI(TAG, "clock       sample     1-byte read  15-byte read");
+    I2CDevice *devs[] = { &slow, &fast };
+    for (I2CDevice *dev : devs) {
+        ESP_LOGI(TAG, "%4lu kHz  %7.1f us  %9.1f us  %10.1f us", (unsigned long)(dev->clk_hz() / 1000),
+                 time_sample(*dev, ctrl_meas), time_reads(*dev, 1), time_reads(*dev, 15));
+    }
+}
@@ -0,0 +1,108 @@
+// Heap check for the BME688 register callbacks.
+// To run it, enable Component config > Heap memory debugging > Heap tracing (Standalone), then
+// select it under Environmental Data Recorder Configuration > Application in menuconfig.
+//
+// Heap-traces the I2CDevice calls the BME688 callbacks make, read_reg() of
+// 15 bytes and write_reg() of one, first with the device calling the driver
+// directly and then through a bus arbiter, and a run of
+// BME688::start_measurement() samples. It fails with an error if any of
+// them allocates anything.
+// main/bme688_bus_speed_benchmark.cpp has the per-access timings.
+
+#include "bme688_lib.h"
+#include "esp_heap_trace.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+static const char *TAG = "I2C_HEAP_BENCH";
+
+#define BENCH_SAMPLES 20
+#define TRACE_RECORDS 256
+
+static heap_trace_record_t trace_records[TRACE_RECORDS];
+
+// Heap operations recorded while running fn.
+template <class Fn>
+static size_t count_allocs(Fn fn) {
+    heap_trace_start(HEAP_TRACE_ALL);
+    fn();
+    heap_trace_stop();
+    return heap_trace_get_count();
+}
+
+extern "C" void app_main() {
+    BME688 sensor;
+    QueueHandle_t queue = xQueueCreate(1, sizeof(BME688Completion));
+    if (queue == nullptr || heap_trace_init_standalone(trace_records, TRACE_RECORDS) != ESP_OK) {
+        ESP_LOGE(TAG, "Setup failed; is heap tracing enabled in menuconfig?");
+        return;
+    }
+    I2CBusConfig bus;
+    bus.port = sensor.port();
+    I2CDevice probe;
+    if (probe.open(bus, sensor.address(), I2C_MASTER_FREQ_HZ) != ESP_OK) {
+        ESP_LOGE(TAG, "Opening the sensor address failed");
+        return;
+    }
+
+    // The sensor sleeps between samples; writing ctrl_meas back as read keeps it asleep
+    uint8_t buf[BME68X_LEN_FIELD];
+    uint8_t ctrl_meas = 0;
+    int bus_failures = 0;
+    auto reg_access = [&]() {
+        for (int i = 0; i < 4; i++) {
+            bus_failures += probe.read_reg(BME68X_REG_FIELD0, buf, 15) != ESP_OK;
+            bus_failures += probe.write_reg(BME68X_REG_CTRL_MEAS, &ctrl_meas, 1) != ESP_OK;
+        }
+    };
+    probe.read_reg(BME68X_REG_CTRL_MEAS, &ctrl_meas, 1);
+    reg_access();
+    size_t direct_allocs = count_allocs(reg_access);
+    ESP_LOGI(TAG, "heap operations for 4 register reads and writes: %u", (unsigned)direct_allocs);
+    if (direct_allocs != 0) {
+        heap_trace_dump();
+    }
+
+    size_t arbiter_allocs = 0;
+    if (I2CBus::start_arbiter(bus.port) != ESP_OK) {
+        ESP_LOGE(TAG, "Starting the bus arbiter failed");
+        bus_failures++;
+    } else {
+        reg_access();
+        arbiter_allocs = count_allocs(reg_access);
+        I2CBus::stop_arbiter(bus.port);
+        ESP_LOGI(TAG, "heap operations for 4 register reads and writes through the arbiter: %u",
+                 (unsigned)arbiter_allocs);
+        if (arbiter_allocs != 0) {
+            heap_trace_dump();
+        }
+    }
+
+    // Warm up once, so one-time allocations (the timer, newlib's stdout) are out of the trace.
+    BME688Completion done;
+    sensor.start_measurement(queue);
+    xQueueReceive(queue, &done, pdMS_TO_TICKS(1000));
+    int failures = 0;
+    size_t lib_allocs = count_allocs([&]() {
+        for (int i = 0; i < BENCH_SAMPLES; i++) {
+            if (!sensor.start_measurement(queue) || xQueueReceive(queue, &done, pdMS_TO_TICKS(1000)) != pdTRUE ||
+                !done.ok) {
+                failures++;
+            }
+        }
+    });
+    if (direct_allocs != 0 || arbiter_allocs != 0 || bus_failures != 0) {
+        ESP_LOGE(TAG, "FAIL: %u heap operations on the I2CDevice path, %u through the arbiter (%d failed)",
+                 (unsigned)direct_allocs, (unsigned)arbiter_allocs, bus_failures);
+    }
+    if (lib_allocs != 0 || failures != 0) {
+        ESP_LOGE(TAG, "FAIL: %u heap operations in %d samples (%d failed)", (unsigned)lib_allocs, BENCH_SAMPLES,
+                 failures);
+        heap_trace_dump();
+    }
+    if (direct_allocs == 0 && arbiter_allocs == 0 && bus_failures == 0 && lib_allocs == 0 && failures == 0) {
+        ESP_LOGI(TAG, "PASS: I2CDevice register access, with and without the arbiter, and %d samples through "
+                 "bme688_lib with no heap operations", BENCH_SAMPLES);
+    }
+    vQueueDelete(queue);
+}
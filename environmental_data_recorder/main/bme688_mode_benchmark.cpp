@@ -0,0 +1,80 @@
+// Sample-rate and noise benchmark for the BME688 runtime modes.
+// To run it, select it under Environmental Data Recorder Configuration > Application in menuconfig.
+//
+// Keep the sensor in a steady environment. For each mode the sensor is read
+// back to back through start_measurement() for BENCH_SECONDS; the achieved
+// sample rate and the standard deviation of temperature, pressure and
+// humidity are logged. With a steady input the deviation is the noise of the
+// mode. tools/bme688_mode_bench.cpp gives the same figures for a simulated sensor.
+
+#include <math.h>
+#include "bme688_lib.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+static const char *TAG = "MODE_BENCH";
+
+#define BENCH_SECONDS 30
+#define BENCH_WARMUP 20     // samples dropped after a mode switch while the IIR filter settles
+
+struct RunningStats {
+    long n = 0;
+    double mean = 0, m2 = 0;
+    void add(double x) {
+        n++;
+        double d = x - mean;
+        mean += d / n;
+        m2 += d * (x - mean);
+    }
+    double sd() const { return n > 1 ? sqrt(m2 / (n - 1)) : 0; }
+};
+
+static void run_mode(BME688 &sensor, QueueHandle_t queue, BME688Mode mode, const char *name) {
+    if (!sensor.set_mode(mode)) {
+        ESP_LOGE(TAG, "%s: set_mode failed", name);
+        return;
+    }
+
+    RunningStats t, p, h;
+    long samples = 0, failures = 0;
+    int64_t start = 0;
+    int64_t end = esp_timer_get_time() + (int64_t)(BENCH_SECONDS + 5) * 1000000;
+    while (esp_timer_get_time() < end) {
+        BME688Completion done;
+        if (!sensor.start_measurement(queue) || xQueueReceive(queue, &done, pdMS_TO_TICKS(1000)) != pdTRUE) {
+            failures++;
+            continue;
+        }
+        if (!done.ok) {
+            failures++;
+            continue;
+        }
+        samples++;
+        if (samples == BENCH_WARMUP) {
+            start = esp_timer_get_time();
+        } else if (samples > BENCH_WARMUP) {
+            t.add(done.sample.temperature);
+            p.add(done.sample.pressure * 100.0); // Pa
+            h.add(done.sample.humidity);
+        }
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    ESP_LOGI(TAG, "%-11s %6.1f Hz (%lu us per read), sd T %.4f degC, P %.3f Pa, H %.4f %%rH, %ld failed", name,
+             t.n * 1e6 / (double)elapsed, (unsigned long)sensor.forced_period_us(), t.sd(), p.sd(), h.sd(), failures);
+}
+
+extern "C" void app_main() {
+    BME688 sensor;
+    QueueHandle_t queue = xQueueCreate(1, sizeof(BME688Completion));
+    if (queue == nullptr) {
+        ESP_LOGE(TAG, "Failed to create queue");
+        return;
+    }
+
+    run_mode(sensor, queue, BME688_MODE_LOW_LATENCY, "low-latency");
+    run_mode(sensor, queue, BME688_MODE_DEFAULT, "default");
+    run_mode(sensor, queue, BME688_MODE_PRECISION, "precision");
+    sensor.set_mode(BME688_MODE_DEFAULT);
+    vQueueDelete(queue);
+}
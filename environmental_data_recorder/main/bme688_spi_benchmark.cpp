@@ -0,0 +1,70 @@
+// Bus time of the BME688 over SPI next to I2C.
+// To run it, select it under Environmental Data Recorder Configuration > Application in menuconfig.
+//
+// Mounts the SD card first, so the SPI sensor joins the card's SPI2_HOST bus
+// as a second device, then brings up one sensor on SPI (chip select
+// BME688_SPI_CS_IO) and, if fitted, one on the default I2C bus. For each it
+// times mode changes (configuration register traffic, with a memory page
+// switch on SPI) and forced raw reads, and logs the transactions, bytes and
+// SPI page switches the Bosch driver issued per operation.
+// A forced read includes the measurement window; the difference between the
+// two interfaces is bus time. tools/bme688_spi_bus_time.cpp has the modelled
+// breakdown per phase.
+
+#include "bme688_lib.h"
+#include "sdcard_lib.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "SPI_BENCH";
+
+#define BENCH_ROUNDS 20
+
+static void run_bench(const char *name, BME688 &sensor) {
+    bme68x_intf_stats before = sensor.intf_stats();
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_ROUNDS; i++) {
+        if (!sensor.set_mode(BME688_MODE_PRECISION) || !sensor.set_mode(BME688_MODE_DEFAULT)) {
+            ESP_LOGE(TAG, "%s: set_mode failed", name);
+            return;
+        }
+    }
+    double mode_us = (esp_timer_get_time() - start) / (2.0 * BENCH_ROUNDS);
+    bme68x_intf_stats after = sensor.intf_stats();
+    ESP_LOGI(TAG, "%s mode change: %8.1f us, %5.1f txns, %6.1f bytes, %4.1f page switches", name, mode_us,
+             (after.transactions - before.transactions) / (2.0 * BENCH_ROUNDS),
+             (after.bytes - before.bytes) / (2.0 * BENCH_ROUNDS),
+             (after.page_switches - before.page_switches) / (2.0 * BENCH_ROUNDS));
+
+    bme68x_raw_data raw;
+    before = after;
+    start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_ROUNDS; i++) {
+        if (!sensor.read_raw_measurement(raw)) {
+            ESP_LOGE(TAG, "%s: forced read failed", name);
+            return;
+        }
+    }
+    double read_us = (esp_timer_get_time() - start) / (double)BENCH_ROUNDS;
+    after = sensor.intf_stats();
+    ESP_LOGI(TAG, "%s forced read: %8.1f us, %5.1f txns, %6.1f bytes, %4.1f page switches", name, read_us,
+             (after.transactions - before.transactions) / (double)BENCH_ROUNDS,
+             (after.bytes - before.bytes) / (double)BENCH_ROUNDS,
+             (after.page_switches - before.page_switches) / (double)BENCH_ROUNDS);
+}
+
+extern "C" void app_main() {
+    SDCard sdCard("/sdcard", BME688_SPI_MOSI_IO, BME688_SPI_MISO_IO, BME688_SPI_SCLK_IO, 2);
+    if (sdCard.init() != ESP_OK) {
+        ESP_LOGW(TAG, "No SD card; the SPI sensor initializes the bus itself");
+    }
+
+    BME688Config spi_config;
+    spi_config.intf = BME688_INTF_SPI;
+    BME688 spi_sensor(spi_config);
+    ESP_LOGI(TAG, "SPI at %lu kHz, I2C at %lu kHz", (unsigned long)(BME688_SPI_FREQ_HZ / 1000),
+             (unsigned long)(I2C_MASTER_FREQ_HZ / 1000));
+    run_bench("SPI", spi_sensor);
+
+    BME688 i2c_sensor;
+    run_bench("I2C", i2c_sensor);
+}
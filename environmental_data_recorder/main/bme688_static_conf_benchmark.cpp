@@ -0,0 +1,108 @@
+// Read-path benchmark for bme688_static_conf.h on a real sensor.
+// To run it, select it under Environmental Data Recorder Configuration > Application in menuconfig.
+//
+// Alternates forced reads through the runtime path (bme68x_set_op_mode and
+// bme68x_get_meas_dur) and the compile-time path (BME688StaticConf::trigger_forced
+// and forced_period_us). For each read it times the trigger and the field
+// readout with esp_timer, leaving out the heater wait, and logs the mean of both.
+
+#include "bme68x.h"
+#include "bme688_static_conf.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "i2c_bus_lib.h"
+
+static const char *TAG = "CONF_BENCH";
+
+#define BENCH_FREQ_HZ 100000
+#define BENCH_ADDR 0x77
+#define BENCH_ROUNDS 50
+
+typedef BME688DefaultConf Conf;
+
+static I2CDevice bench_dev;
+
+static int8_t bench_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr) {
+    esp_err_t ret = static_cast<I2CDevice *>(intf_ptr)->read_reg(reg_addr, reg_data, len);
+    return (ret == ESP_OK) ? 0 : -1;
+}
+
+static int8_t bench_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr) {
+    esp_err_t ret = static_cast<I2CDevice *>(intf_ptr)->write_reg(reg_addr, reg_data, len);
+    return (ret == ESP_OK) ? 0 : -1;
+}
+
+static void bench_delay_us(uint32_t period, void *intf_ptr) {
+    esp_rom_delay_us(period);
+}
+
+extern "C" void app_main() {
+    I2CBusConfig bus;
+    if (bench_dev.open(bus, BENCH_ADDR, BENCH_FREQ_HZ) != ESP_OK) {
+        ESP_LOGE(TAG, "Opening the I2C device failed");
+        return;
+    }
+
+    struct bme68x_dev dev = {};
+    dev.intf = BME68X_I2C_INTF;
+    dev.read = bench_read;
+    dev.write = bench_write;
+    dev.delay_us = bench_delay_us;
+    dev.intf_ptr = &bench_dev;
+    dev.amb_temp = 25;
+    struct bme68x_conf conf = Conf::conf();
+    struct bme68x_heatr_conf heatr_conf = Conf::heatr_conf();
+    if (bme68x_init(&dev) != BME68X_OK || bme68x_set_conf(&conf, &dev) != BME68X_OK ||
+        bme68x_set_heatr_conf(BME68X_FORCED_MODE, &heatr_conf, &dev) != BME68X_OK) {
+        ESP_LOGE(TAG, "BME688 setup failed");
+        return;
+    }
+
+    int64_t runtime_trigger_us = 0, runtime_read_us = 0;
+    int64_t static_trigger_us = 0, static_read_us = 0;
+    int failures = 0;
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int path = 0; path < 2; path++) {
+            int64_t t0 = esp_timer_get_time();
+            int8_t rslt;
+            uint32_t period_us;
+            if (path == 0) {
+                rslt = bme68x_set_op_mode(BME68X_FORCED_MODE, &dev);
+                period_us = bme68x_get_meas_dur(BME68X_FORCED_MODE, &conf, &dev) + heatr_conf.heatr_dur * 1000;
+            } else {
+                rslt = Conf::trigger_forced(&dev);
+                period_us = Conf::forced_period_us;
+            }
+            int64_t t1 = esp_timer_get_time();
+            vTaskDelay(pdMS_TO_TICKS(period_us / 1000) + 1);
+
+            struct bme68x_data data;
+            uint8_t n_fields = 0;
+            int64_t t2 = esp_timer_get_time();
+            if (rslt == BME68X_OK) {
+                rslt = bme68x_get_data(BME68X_FORCED_MODE, &data, &n_fields, &dev);
+            }
+            int64_t t3 = esp_timer_get_time();
+            if (rslt != BME68X_OK || n_fields == 0) {
+                failures++;
+            }
+            if (path == 0) {
+                runtime_trigger_us += t1 - t0;
+                runtime_read_us += t3 - t2;
+            } else {
+                static_trigger_us += t1 - t0;
+                static_read_us += t3 - t2;
+            }
+        }
+    }
+
+    ESP_LOGI(TAG, "%d reads per path, %d failed", BENCH_ROUNDS, failures);
+    ESP_LOGI(TAG, "runtime:      trigger %lld us, readout %lld us", runtime_trigger_us / BENCH_ROUNDS,
+             runtime_read_us / BENCH_ROUNDS);
+    ESP_LOGI(TAG, "compile-time: trigger %lld us, readout %lld us", static_trigger_us / BENCH_ROUNDS,
+             static_read_us / BENCH_ROUNDS);
+    bench_dev.close();
+}
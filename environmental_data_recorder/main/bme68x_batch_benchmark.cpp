@@ -0,0 +1,121 @@
+// Throughput benchmark for bme68x_compensate_batch.
+// To run it, select it under Environmental Data Recorder Configuration > Application in menuconfig.
+//
+// The same synthetic raw samples are compensated once per sample (len = 1, the
+// cost bme68x_get_data pays per field) and in one batch call, the outputs are
+// compared bit for bit and the time per sample is logged for both.
+
+#include <cstring>
+#include "bme68x.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "BATCH_BENCH";
+
+#define BENCH_SAMPLES 1024
+#define BENCH_ROUNDS 20
+
+#ifdef BME68X_USE_FPU
+typedef float temp_t;
+typedef float comp_t;
+#else
+typedef int16_t temp_t;
+typedef uint32_t comp_t;
+#endif
+
+static uint32_t temp_adc[BENCH_SAMPLES];
+static uint32_t pres_adc[BENCH_SAMPLES];
+static uint16_t hum_adc[BENCH_SAMPLES];
+static uint16_t gas_adc[BENCH_SAMPLES];
+static uint8_t gas_range[BENCH_SAMPLES];
+
+static temp_t single_t[BENCH_SAMPLES], batch_t[BENCH_SAMPLES];
+static comp_t single_p[BENCH_SAMPLES], batch_p[BENCH_SAMPLES];
+static comp_t single_h[BENCH_SAMPLES], batch_h[BENCH_SAMPLES];
+static comp_t single_g[BENCH_SAMPLES], batch_g[BENCH_SAMPLES];
+
+// Coefficients in the range of a production BME688, good enough for timing.
+static void fill_calibration(bme68x_calib_data &calib) {
+    memset(&calib, 0, sizeof(calib));
+    calib.par_t1 = 26000;
+    calib.par_t2 = 26500;
+    calib.par_t3 = 3;
+    calib.par_p1 = 36000;
+    calib.par_p2 = -10400;
+    calib.par_p3 = 88;
+    calib.par_p4 = 7000;
+    calib.par_p5 = -100;
+    calib.par_p6 = 30;
+    calib.par_p7 = 30;
+    calib.par_p8 = -300;
+    calib.par_p9 = -2600;
+    calib.par_p10 = 30;
+    calib.par_h1 = 800;
+    calib.par_h2 = 1000;
+    calib.par_h3 = 0;
+    calib.par_h4 = 45;
+    calib.par_h5 = 20;
+    calib.par_h6 = 120;
+    calib.par_h7 = -100;
+    calib.range_sw_err = 0;
+    bme68x_precompute_calib(&calib);
+}
+
+static void fill_samples() {
+    uint32_t seed = 1;
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        seed = seed * 1103515245u + 12345u;
+        temp_adc[i] = 480000 + (seed >> 16) % 40000;
+        pres_adc[i] = 380000 + (seed >> 8) % 40000;
+        hum_adc[i] = 20000 + (seed >> 4) % 20000;
+        gas_adc[i] = (seed >> 12) % 1024;
+        gas_range[i] = (seed >> 24) % 16;
+    }
+}
+
+extern "C" void app_main() {
+    bme68x_calib_data calib;
+    fill_calibration(calib);
+    fill_samples();
+
+    const uint32_t variant = BME68X_VARIANT_GAS_HIGH;
+    bme68x_raw_batch raw = {BENCH_SAMPLES, temp_adc, pres_adc, hum_adc, gas_adc, gas_range};
+    bme68x_comp_batch batch = {batch_t, batch_p, batch_h, batch_g};
+
+    int64_t single_us = 0;
+    int64_t batch_us = 0;
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        int64_t start = esp_timer_get_time();
+        for (int i = 0; i < BENCH_SAMPLES; i++) {
+            bme68x_raw_batch one = {1, &temp_adc[i], &pres_adc[i], &hum_adc[i], &gas_adc[i], &gas_range[i]};
+            bme68x_comp_batch out = {&single_t[i], &single_p[i], &single_h[i], &single_g[i]};
+            bme68x_compensate_batch(&one, &out, &calib, variant);
+        }
+        single_us += esp_timer_get_time() - start;
+
+        start = esp_timer_get_time();
+        bme68x_compensate_batch(&raw, &batch, &calib, variant);
+        batch_us += esp_timer_get_time() - start;
+    }
+
+    bool exact = memcmp(single_t, batch_t, sizeof(batch_t)) == 0 &&
+                 memcmp(single_p, batch_p, sizeof(batch_p)) == 0 &&
+                 memcmp(single_h, batch_h, sizeof(batch_h)) == 0 &&
+                 memcmp(single_g, batch_g, sizeof(batch_g)) == 0;
+
+    const int64_t total = (int64_t)BENCH_SAMPLES * BENCH_ROUNDS;
+    ESP_LOGI(TAG, "Per sample: %lld ns, batch: %lld ns (%d samples x %d rounds, chunk %u)",
+             single_us * 1000 / total, batch_us * 1000 / total, BENCH_SAMPLES, BENCH_ROUNDS,
+             (unsigned)BME68X_BATCH_CHUNK);
+    if (exact) {
+        ESP_LOGI(TAG, "Batch output is bit-identical to per-sample output");
+    } else {
+        ESP_LOGE(TAG, "Batch output differs from per-sample output");
+    }
+
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+}
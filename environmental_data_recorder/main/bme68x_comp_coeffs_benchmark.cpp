@@ -0,0 +1,127 @@
+// Cycle counts of the BME68x compensation with precomputed coefficients.
+// To run it, select it under Environmental Data Recorder Configuration > Application in menuconfig.
+//
+// Compensates the same synthetic raw samples (T/P/H, no gas) with
+// bme68x_compensate_batch and with the driver's previous formulas from
+// tools/bme68x_reference_comp.h, logs the CPU cycles per sample of both and
+// the largest difference between their results. Build once as is and once
+// with BME68X_DO_NOT_USE_FPU added to the project's compile definitions for
+// the integer build. tools/bme68x_comp_coeffs_bench.cpp runs the same
+// comparison on a host.
+
+#include <cstring>
+#include <cmath>
+#include "bme68x.h"
+#include "../tools/bme68x_reference_comp.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "COMP_BENCH";
+
+#define BENCH_SAMPLES 1024
+#define BENCH_ROUNDS 20
+
+#ifdef BME68X_USE_FPU
+typedef float temp_t;
+typedef float comp_t;
+#define TEMP_SCALE 1.0f
+#define HUM_SCALE 1.0f
+#else
+typedef int16_t temp_t;
+typedef uint32_t comp_t;
+#define TEMP_SCALE 100.0f
+#define HUM_SCALE 1000.0f
+#endif
+
+static uint32_t temp_adc[BENCH_SAMPLES];
+static uint32_t pres_adc[BENCH_SAMPLES];
+static uint16_t hum_adc[BENCH_SAMPLES];
+
+static temp_t ref_t[BENCH_SAMPLES], new_t[BENCH_SAMPLES];
+static comp_t ref_p[BENCH_SAMPLES], new_p[BENCH_SAMPLES];
+static comp_t ref_h[BENCH_SAMPLES], new_h[BENCH_SAMPLES];
+
+// Coefficients in the range of a production BME688.
+static void fill_calibration(bme68x_calib_data &calib) {
+    memset(&calib, 0, sizeof(calib));
+    calib.par_t1 = 26000;
+    calib.par_t2 = 26500;
+    calib.par_t3 = 3;
+    calib.par_p1 = 36000;
+    calib.par_p2 = -10400;
+    calib.par_p3 = 88;
+    calib.par_p4 = 7000;
+    calib.par_p5 = -100;
+    calib.par_p6 = 30;
+    calib.par_p7 = 30;
+    calib.par_p8 = -300;
+    calib.par_p9 = -2600;
+    calib.par_p10 = 30;
+    calib.par_h1 = 800;
+    calib.par_h2 = 1000;
+    calib.par_h3 = 0;
+    calib.par_h4 = 45;
+    calib.par_h5 = 20;
+    calib.par_h6 = 120;
+    calib.par_h7 = -100;
+    bme68x_precompute_calib(&calib);
+}
+
+static void fill_samples() {
+    uint32_t seed = 1;
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        seed = seed * 1103515245u + 12345u;
+        temp_adc[i] = 480000 + (seed >> 16) % 40000;
+        pres_adc[i] = 380000 + (seed >> 8) % 40000;
+        hum_adc[i] = 20000 + (seed >> 4) % 20000;
+    }
+}
+
+extern "C" void app_main() {
+    bme68x_calib_data calib;
+    fill_calibration(calib);
+    fill_samples();
+
+    bme68x_raw_batch raw = {BENCH_SAMPLES, temp_adc, pres_adc, hum_adc, NULL, NULL};
+    bme68x_comp_batch ref_out = {ref_t, ref_p, ref_h, NULL};
+    bme68x_comp_batch new_out = {new_t, new_p, new_h, NULL};
+
+    // Best of the rounds, with the scheduler suspended so no other task runs in between.
+    uint32_t ref_cycles = UINT32_MAX;
+    uint32_t new_cycles = UINT32_MAX;
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        vTaskSuspendAll();
+        uint32_t start = esp_cpu_get_cycle_count();
+        ref_compensate_batch(&raw, &ref_out, &calib);
+        uint32_t mid = esp_cpu_get_cycle_count();
+        bme68x_compensate_batch(&raw, &new_out, &calib, BME68X_VARIANT_GAS_HIGH);
+        uint32_t end = esp_cpu_get_cycle_count();
+        xTaskResumeAll();
+        if (mid - start < ref_cycles) ref_cycles = mid - start;
+        if (end - mid < new_cycles) new_cycles = end - mid;
+    }
+
+    float max_t = 0;
+    float max_p = 0;
+    float max_h = 0;
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        max_t = fmaxf(max_t, fabsf(((float)new_t[i] - (float)ref_t[i]) / TEMP_SCALE));
+        max_p = fmaxf(max_p, fabsf((float)new_p[i] - (float)ref_p[i]));
+        max_h = fmaxf(max_h, fabsf(((float)new_h[i] - (float)ref_h[i]) / HUM_SCALE));
+    }
+
+#ifdef BME68X_USE_FPU
+    ESP_LOGI(TAG, "Floating point build, %d samples, best of %d rounds", BENCH_SAMPLES, BENCH_ROUNDS);
+#else
+    ESP_LOGI(TAG, "Integer build, %d samples, best of %d rounds", BENCH_SAMPLES, BENCH_ROUNDS);
+#endif
+    ESP_LOGI(TAG, "Reference formulas: %lu cycles per sample", (unsigned long)(ref_cycles / BENCH_SAMPLES));
+    ESP_LOGI(TAG, "Precomputed coefficients: %lu cycles per sample", (unsigned long)(new_cycles / BENCH_SAMPLES));
+    ESP_LOGI(TAG, "Max difference: %.3g degC, %.3g Pa, %.3g %%rH", max_t, max_p, max_h);
+
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+}
@@ -1,15 +1,28 @@
 #include "bme688_lib.h"
+#include "bme688_raw_format.h"
+#include "async_log_writer.h"
 #include "sdcard_lib.h"
+#include "sdkconfig.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_random.h"
+#include <string.h>
+
+#if CONFIG_EDR_RAW_CAPTURE
+// Heads every raw segment with the calibration block, so each one decodes on its own
+static size_t raw_segment_header(uint8_t *out, size_t size, void *arg) {
+    memcpy(out, arg, BME688_RAW_CALIB_LEN);
+    return BME688_RAW_CALIB_LEN;
+}
+#endif
 
 extern "C" void app_main() {
     // No SNTP or real-time clock initialization
     static int i = 10;
 
     // Initialize SD card
-    SDCard sdCard("/sdcard", 23, 19, 18, 2);
+    SDCard sdCard("/sdcard", 23, 19, 18, 2, CONFIG_EDR_SD_FREQ_KHZ);
     if (sdCard.init() != ESP_OK) {
         ESP_LOGE("APP", "Failed to initialize SD card");
         sdCard.unmount();
@@ -40,23 +53,78 @@ extern "C" void app_main() {
     }
     ESP_LOGI("APP", "BME688 sensor initialized successfully");
 
+    // Records go to a writer task, so a slow card does not stall sampling;
+    // on two cores it runs on the one this loop does not. Each session
+    // fills preallocated segments of CONFIG_EDR_LOG_SEGMENT_KB.
+    AsyncLogWriterConfig logConfig;
+    logConfig.segmentBytes = CONFIG_EDR_LOG_SEGMENT_KB * 1024;
+#if CONFIG_EDR_RAW_CAPTURE
+    // Raw capture: each segment starts with the calibration registers, every
+    // field after that is a fixed-size block of ADC values.
+    const char* filePath = logsDirOk ? "logs/raw.bin" : "raw.bin";
+    uint8_t coeff[BME68X_LEN_COEFF_ALL];
+    uint8_t variantId = 0;
+    if (!bme688.read_calibration(coeff, variantId)) {
+        ESP_LOGE("APP", "Failed to read BME688 calibration");
+        sdCard.unmount();
+        return;
+    }
+    // Marks this boot's blocks apart from stale ones of earlier boots that a
+    // preallocated segment may still hold past the last record
+    uint32_t sessionId = esp_random();
+    uint8_t calibBlock[BME688_RAW_CALIB_LEN];
+    bme688_raw_encode_calib(calibBlock, sessionId, coeff, variantId);
+    logConfig.segmentHeader = raw_segment_header;
+    logConfig.segmentHeaderArg = calibBlock;
+#else
+    const char* filePath = logsDirOk ? "logs/log.txt" : "log.txt";
+#endif
+#if portNUM_PROCESSORS > 1
+    logConfig.core = 1;
+#endif
+    AsyncLogWriter logFile(sdCard, filePath, logConfig);
+    if (logFile.start() != ESP_OK) {
+        ESP_LOGE("APP", "Failed to open %s", filePath);
+        sdCard.unmount();
+        return;
+    }
+
+#if CONFIG_EDR_RAW_CAPTURE
+    ESP_LOGI("APP", "Raw capture to %s", filePath);
+#endif
+
     // Task to read BME688 data and log to SD card
     while (i>0) {
+#if CONFIG_EDR_RAW_CAPTURE
+        bme68x_raw_data raw;
+        if (bme688.read_raw_measurement(raw)) {
+            uint8_t record[BME688_RAW_SAMPLE_LEN];
+            bme688_raw_encode_sample(record, sessionId, (uint32_t)(esp_timer_get_time() / 1000), raw);
+            logFile.write(record, sizeof(record));
+            i--;
+        }
+#else
         if (bme688.read_measurement()) {
             float temperature = 0, pressure = 0, humidity = 0, gas_resistance = 0;
             bme688.get_last_measurement(temperature, pressure, humidity, gas_resistance);
             char logLine[256];
             int64_t ms = esp_timer_get_time() / 1000;
             snprintf(logLine, sizeof(logLine), "Timestamp: %lld ms, Temp: %.2f C, Press: %.2f hPa, Hum: %.2f %%, Gas: %.2f KOhms\n", ms, temperature, pressure, humidity, gas_resistance);
-            const char* filePath = logsDirOk ? "logs/log.txt" : "log.txt";
-            ESP_LOGI("APP", "Writing to file: %s", filePath);
-            sdCard.writeFile(filePath, logLine);
-            ESP_LOGI("APP", "Logged BME688 data to SD card");
+            logFile.write(logLine);
+            ESP_LOGI("APP", "Logged BME688 data to %s", filePath);
             i--;
         }
+#endif
+        logFile.poll();
         vTaskDelay(1000 / portTICK_PERIOD_MS);
     }
-    // Unmount SD card before exiting
+    // Write out what is buffered, then unmount SD card before exiting
+    logFile.stop();
+    AsyncLogWriterStats logStats = logFile.getStats();
+    if (logStats.droppedRecords > 0 || logStats.writeErrors > 0) {
+        ESP_LOGW("APP", "Log writer dropped %lu records, %lu write errors", (unsigned long)logStats.droppedRecords,
+                 (unsigned long)logStats.writeErrors);
+    }
     sdCard.unmount();
     ESP_LOGI("APP", "SD card unmounted");
 }
\ No newline at end of file
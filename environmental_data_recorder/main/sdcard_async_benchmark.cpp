@@ -0,0 +1,114 @@
+// Producer-side latency of LogAppender against AsyncLogWriter.
+// To run it, select it under Environmental Data Recorder Configuration > Application in menuconfig.
+//
+// Writes the same 100-byte log lines to a fresh file on the card and logs the
+// average and slowest call as the sampling loop sees it:
+//  - LogAppender with the default policy at a line every 2 ms, where the
+//    call that flushes pays for the SD write;
+//  - AsyncLogWriter at the same rate with the writer task on the other core;
+//  - AsyncLogWriter at a line every 100 us, faster than the card can take,
+//    once dropping on overflow and once waiting up to 50 ms, to show the
+//    overflow policy and its counters.
+// Each run ends with close() or stop(), which are not in the per-line times.
+
+#include <cstring>
+#include "async_log_writer.h"
+#include "log_appender.h"
+#include "sdcard_lib.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "ASYNC_BENCH";
+
+#define BENCH_LINES 2000
+
+static void format_line(char *line, size_t len, int i) {
+    // Same shape as the app's log line, padded to 100 bytes
+    snprintf(line, len, "Timestamp: %8d ms, Temp: %5.2f C, Press: %7.2f hPa, Hum: %5.2f %%, Gas: %7.2f KOhms  \n",
+             i * 1000, 21.5 + (i % 10) * 0.01, 1013.25, 45.0, 120.0);
+}
+
+static void report(const char *name, int64_t sum_us, int64_t worst_us) {
+    ESP_LOGI(TAG, "%-32s avg %6.1f us, slowest %6lld us", name, sum_us / (double)BENCH_LINES, worst_us);
+}
+
+static void bench_appender(SDCard &card, const char *path, uint32_t gap_us) {
+    LogAppender appender(card, path);
+    if (appender.open() != ESP_OK) {
+        ESP_LOGE(TAG, "LogAppender: open failed");
+        return;
+    }
+    char line[128];
+    int64_t sum_us = 0, worst_us = 0;
+    for (int i = 0; i < BENCH_LINES; i++) {
+        format_line(line, sizeof(line), i);
+        int64_t t0 = esp_timer_get_time();
+        appender.append(line);
+        int64_t dt = esp_timer_get_time() - t0;
+        sum_us += dt;
+        worst_us = dt > worst_us ? dt : worst_us;
+        esp_rom_delay_us(gap_us);
+    }
+    appender.close();
+    report("LogAppender", sum_us, worst_us);
+}
+
+static void bench_async(SDCard &card, const char *name, const char *path, const AsyncLogWriterConfig &config,
+                        uint32_t gap_us) {
+    AsyncLogWriter writer(card, path, config);
+    if (writer.start() != ESP_OK) {
+        ESP_LOGE(TAG, "%s: start failed", name);
+        return;
+    }
+    char line[128];
+    int64_t sum_us = 0, worst_us = 0;
+    for (int i = 0; i < BENCH_LINES; i++) {
+        format_line(line, sizeof(line), i);
+        int64_t t0 = esp_timer_get_time();
+        writer.write(line);
+        int64_t dt = esp_timer_get_time() - t0;
+        sum_us += dt;
+        worst_us = dt > worst_us ? dt : worst_us;
+        esp_rom_delay_us(gap_us);
+    }
+    writer.stop();
+    report(name, sum_us, worst_us);
+    AsyncLogWriterStats stats = writer.getStats();
+    ESP_LOGI(TAG, "%-32s %lu dropped, %lu overflows, %lu buffers, queue high-water %lu", "",
+             (unsigned long)stats.droppedRecords, (unsigned long)stats.overflows,
+             (unsigned long)stats.buffersWritten, (unsigned long)stats.maxQueued);
+    ESP_LOGI(TAG, "%-32s slowest buffer write %lu us, longest producer wait %lu us", "",
+             (unsigned long)stats.maxWriteUs, (unsigned long)stats.maxWaitUs);
+}
+
+extern "C" void app_main() {
+    SDCard sdCard("/sdcard", 23, 19, 18, 2);
+    if (sdCard.init() != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize SD card");
+        return;
+    }
+    const char *paths[] = {"bench1.txt", "bench2.txt", "bench3.txt", "bench4.txt"};
+    for (const char *path : paths) {
+        sdCard.deleteFile(path);
+    }
+    esp_log_level_set("SD_CARD_LIB", ESP_LOG_WARN);
+
+    bench_appender(sdCard, paths[0], 2000);
+
+    AsyncLogWriterConfig config;
+#if portNUM_PROCESSORS > 1
+    config.core = 1;
+#endif
+    bench_async(sdCard, "AsyncLogWriter", paths[1], config, 2000);
+    bench_async(sdCard, "AsyncLogWriter, 100us, drop", paths[2], config, 100);
+    config.overflowWaitMs = 50;
+    bench_async(sdCard, "AsyncLogWriter, 100us, wait 50ms", paths[3], config, 100);
+
+    sdCard.unmount();
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+}
@@ -0,0 +1,107 @@
+// Lines per second of SDCard::writeFile() against LogAppender.
+// To run it, select it under Environmental Data Recorder Configuration > Application in menuconfig.
+//
+// Writes the same 100-byte log lines to a fresh file on the card with each
+// method and logs lines per second and the slowest line:
+//  - writeFile: open, write, flush and close per line, as the app did, once
+//    with its per-line log output and once with SD_CARD_LIB quiet;
+//  - LogAppender with the default policy (flush per 4 KB or 2 s, fsync per 10 s);
+//  - LogAppender flushing every line, which shows what keeping the file open
+//    saves on its own;
+//  - LogAppender flushing every line and syncing every 100 ms.
+// The appender times include close(), so the last flush and fsync count.
+
+#include <cstring>
+#include "log_appender.h"
+#include "sdcard_lib.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "LOG_BENCH";
+
+#define BENCH_LINES 500
+
+static void format_line(char *line, size_t len, int i) {
+    // Same shape as the app's log line, padded to 100 bytes
+    snprintf(line, len, "Timestamp: %8d ms, Temp: %5.2f C, Press: %7.2f hPa, Hum: %5.2f %%, Gas: %7.2f KOhms  \n",
+             i * 1000, 21.5 + (i % 10) * 0.01, 1013.25, 45.0, 120.0);
+}
+
+static void report(const char *name, int64_t total_us, int64_t worst_us) {
+    ESP_LOGI(TAG, "%-28s %8.1f lines/s, slowest line %6lld us", name, BENCH_LINES * 1e6 / (double)total_us,
+             worst_us);
+}
+
+static void bench_write_file(SDCard &card, const char *name, const char *path) {
+    char line[128];
+    int64_t worst_us = 0;
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_LINES; i++) {
+        format_line(line, sizeof(line), i);
+        int64_t t0 = esp_timer_get_time();
+        card.writeFile(path, line);
+        int64_t dt = esp_timer_get_time() - t0;
+        worst_us = dt > worst_us ? dt : worst_us;
+    }
+    report(name, esp_timer_get_time() - start, worst_us);
+}
+
+static void bench_appender(SDCard &card, const char *name, const char *path, const LogAppenderConfig &config) {
+    LogAppender appender(card, path, config);
+    char line[128];
+    int64_t worst_us = 0;
+    int64_t start = esp_timer_get_time();
+    if (appender.open() != ESP_OK) {
+        ESP_LOGE(TAG, "%s: open failed", name);
+        return;
+    }
+    for (int i = 0; i < BENCH_LINES; i++) {
+        format_line(line, sizeof(line), i);
+        int64_t t0 = esp_timer_get_time();
+        if (!appender.append(line)) {
+            ESP_LOGE(TAG, "%s: append failed", name);
+            return;
+        }
+        int64_t dt = esp_timer_get_time() - t0;
+        worst_us = dt > worst_us ? dt : worst_us;
+    }
+    appender.close();
+    report(name, esp_timer_get_time() - start, worst_us);
+    LogAppenderStats stats = appender.getStats();
+    ESP_LOGI(TAG, "%-28s %lu flushes, %lu syncs, %lu errors", "", (unsigned long)stats.flushes,
+             (unsigned long)stats.syncs, (unsigned long)stats.errors);
+}
+
+extern "C" void app_main() {
+    SDCard sdCard("/sdcard", 23, 19, 18, 2);
+    if (sdCard.init() != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize SD card");
+        return;
+    }
+    const char *paths[] = {"bench1.txt", "bench2.txt", "bench3.txt", "bench4.txt", "bench5.txt"};
+    for (const char *path : paths) {
+        sdCard.deleteFile(path);
+    }
+
+    bench_write_file(sdCard, "writeFile", paths[0]);
+    esp_log_level_set("SD_CARD_LIB", ESP_LOG_WARN);
+    bench_write_file(sdCard, "writeFile, quiet", paths[1]);
+
+    LogAppenderConfig config;
+    bench_appender(sdCard, "LogAppender, default policy", paths[2], config);
+
+    config.flushBytes = 1;
+    config.flushAgeMs = 0;
+    config.fsyncIntervalMs = 0;
+    bench_appender(sdCard, "LogAppender, flush per line", paths[3], config);
+
+    config.fsyncIntervalMs = 100;
+    bench_appender(sdCard, "LogAppender, fsync per 100ms", paths[4], config);
+
+    sdCard.unmount();
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+}
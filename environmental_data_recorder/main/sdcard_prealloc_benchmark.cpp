@@ -0,0 +1,116 @@
+// Append latency of a growing file against a preallocated contiguous segment.
+// To run it, select it under Environmental Data Recorder Configuration > Application in menuconfig.
+//
+// WARNING: this formats the card, once per cluster size.
+//
+// For 4, 16 and 64 KB clusters it formats the card, then appends 2048
+// sector-sized records (1 MB) to:
+//  - a file opened with O_APPEND, which takes a free cluster and links it
+//    into the FAT every cluster's worth of records;
+//  - a segment made with SDCard::createContiguousFile(), written from the
+//    start and trimmed with ftruncate() at the end, as AsyncLogWriter does.
+// It logs the 50th, 90th, 99th and 99.9th percentile and the slowest
+// write() call, and the total time including the close.
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <cstring>
+#include <sys/unistd.h>
+#include "sdcard_lib.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "SD_PREALLOC";
+
+#define BENCH_RECORD_SIZE 512
+#define BENCH_RECORDS 2048
+
+static uint32_t append_us[BENCH_RECORDS];
+static uint8_t record[BENCH_RECORD_SIZE] __attribute__((aligned(4)));
+
+static void report(const char *name, size_t cluster, int64_t total_us) {
+    std::sort(append_us, append_us + BENCH_RECORDS);
+    ESP_LOGI(TAG, "%2u KB %-13s p50 %5lu, p90 %5lu, p99 %5lu, p99.9 %5lu, max %6lu us, total %5lld ms",
+             (unsigned)(cluster / 1024), name, (unsigned long)append_us[BENCH_RECORDS / 2],
+             (unsigned long)append_us[BENCH_RECORDS * 9 / 10], (unsigned long)append_us[BENCH_RECORDS * 99 / 100],
+             (unsigned long)append_us[BENCH_RECORDS * 999 / 1000], (unsigned long)append_us[BENCH_RECORDS - 1],
+             total_us / 1000);
+}
+
+static bool append_records(int fd) {
+    for (int i = 0; i < BENCH_RECORDS; i++) {
+        int64_t t0 = esp_timer_get_time();
+        if (write(fd, record, BENCH_RECORD_SIZE) != BENCH_RECORD_SIZE) {
+            ESP_LOGE(TAG, "Append %d failed (errno=%d: %s)", i, errno, strerror(errno));
+            return false;
+        }
+        append_us[i] = (uint32_t)(esp_timer_get_time() - t0);
+    }
+    return true;
+}
+
+static void bench_growing(size_t cluster) {
+    int64_t start = esp_timer_get_time();
+    int fd = open("/sdcard/grow.bin", O_WRONLY | O_CREAT | O_APPEND, 0666);
+    if (fd < 0) {
+        ESP_LOGE(TAG, "Failed to open grow.bin (errno=%d: %s)", errno, strerror(errno));
+        return;
+    }
+    bool ok = append_records(fd);
+    close(fd);
+    if (ok) {
+        report("growing", cluster, esp_timer_get_time() - start);
+    }
+}
+
+static void bench_preallocated(SDCard &card, size_t cluster) {
+    int64_t start = esp_timer_get_time();
+    // Twice what is written, so the trim has a tail to give back
+    if (card.createContiguousFile("seg.bin", 2 * BENCH_RECORDS * BENCH_RECORD_SIZE) != ESP_OK) {
+        return;
+    }
+    int fd = open("/sdcard/seg.bin", O_WRONLY);
+    if (fd < 0) {
+        ESP_LOGE(TAG, "Failed to open seg.bin (errno=%d: %s)", errno, strerror(errno));
+        return;
+    }
+    bool ok = append_records(fd);
+    if (ok && ftruncate(fd, BENCH_RECORDS * BENCH_RECORD_SIZE) != 0) {
+        ESP_LOGE(TAG, "Failed to trim seg.bin (errno=%d: %s)", errno, strerror(errno));
+        ok = false;
+    }
+    close(fd);
+    if (ok) {
+        report("preallocated", cluster, esp_timer_get_time() - start);
+    }
+}
+
+extern "C" void app_main() {
+    SDCard sdCard("/sdcard", 23, 19, 18, 2, SDMMC_FREQ_DEFAULT);
+    if (sdCard.init() != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize SD card");
+        return;
+    }
+    for (int i = 0; i < BENCH_RECORD_SIZE; i++) {
+        record[i] = (uint8_t)i;
+    }
+
+    const size_t clusters[] = {4 * 1024, 16 * 1024, 64 * 1024};
+    for (size_t cluster : clusters) {
+        if (sdCard.format(cluster) != ESP_OK) {
+            break;
+        }
+        esp_log_level_set("SD_CARD_LIB", ESP_LOG_WARN);
+        bench_growing(cluster);
+        bench_preallocated(sdCard, cluster);
+        esp_log_level_set("SD_CARD_LIB", ESP_LOG_INFO);
+    }
+
+    sdCard.unmount();
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+}
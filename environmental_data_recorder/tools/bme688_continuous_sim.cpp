@@ -0,0 +1,315 @@
+// Host-side zero-loss test for BME688 parallel-mode continuous acquisition.
+//
+// Runs the Bosch driver's parallel-mode path against a simulated register
+// map with a clock. The simulated sensor writes a new field every cycle into
+// its three field slots (slot = sub-measurement index mod 3), and a field
+// whose new-data bit is still set when its slot comes round again is lost.
+// Reading a field clears its new-data bit. Every transaction costs its I2C
+// time at 400 kHz plus TXN_OVERHEAD_US.
+//
+// The producer thread does what BME688::read_continuous() does: it wakes on
+// a fixed continuous_poll_period_ms() grid, late by up to JITTER_FIELDS of a
+// field, drains bme68x_get_data(), counts meas_index gaps as missed fields
+// and pushes every field into a 16-slot BME688SampleRing (the firmware's
+// header). A consumer thread pops concurrently and checks that every field
+// arrives once, in order, with the values the sensor produced. A last run
+// drains every four fields instead, which must lose fields, to show that
+// the gap count accounts for every one of them.
+//
+// Build with -fsanitize=thread to have the ring's cross-thread accesses
+// checked as well.
+//
+// Build from this directory:
+//   cc -O2 -c ../components/bme68x/bme68x.c -I../components/bme68x -o bme68x.o
+//   c++ -std=c++17 -O2 -pthread -I../components/bme68x -I../components/bme688_lib/include bme688_continuous_sim.cpp bme68x.o -o bme688_continuous_sim
+//
+// Usage: ./bme688_continuous_sim [fields]
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include "bme68x.h"
+#include "bme688_sample_ring.h"
+#include "bme688_static_conf.h"
+
+// T/P/H x1, the fastest parallel-mode field, and bme688_lib.h's default mode.
+typedef BME688StaticConf<BME68X_OS_1X, BME68X_OS_1X, BME68X_OS_1X> FastConf;
+typedef BME688DefaultConf DefaultConf;
+
+namespace {
+
+const double TXN_OVERHEAD_US = 60;
+const double I2C_CLK_HZ = 400000;
+const double JITTER_FIELDS = 0.9;       // wake-up lateness, in fields; one field is the margin
+const size_t RING_LEN = 16;
+
+uint8_t regs[256];
+double now_us;
+bool running;           // parallel mode
+double start_us;        // when parallel mode was entered
+uint32_t cycle_us;
+uint8_t profile_len;
+long produced;          // fields written by the sensor so far
+
+void bus(uint32_t wire_bytes) {
+    now_us += TXN_OVERHEAD_US + wire_bytes * 9 * 1e6 / I2C_CLK_HZ;
+}
+
+// Raw values of field seq, so the consumer can tell which field it got.
+struct bme68x_raw_data field_raw(long seq) {
+    struct bme68x_raw_data raw = {};
+    raw.status = BME68X_NEW_DATA_MSK | BME68X_GASM_VALID_MSK | BME68X_HEAT_STAB_MSK;
+    raw.gas_index = (uint8_t)(seq % profile_len);
+    raw.meas_index = (uint8_t)seq;
+    raw.pres_adc = 400000 + (uint32_t)(seq * 37 % 20000);
+    raw.temp_adc = 500000 + (uint32_t)(seq * 53 % 30000);
+    raw.hum_adc = (uint16_t)(20000 + seq * 11 % 10000);
+    raw.gas_adc = (uint16_t)(300 + seq % 500);
+    raw.gas_range = (uint8_t)(seq % 16);
+    return raw;
+}
+
+void write_field(long seq) {
+    struct bme68x_raw_data raw = field_raw(seq);
+    uint8_t *f = &regs[BME68X_REG_FIELD0 + (seq % 3) * BME68X_LEN_FIELD_OFFSET];
+    f[0] = (uint8_t)(BME68X_NEW_DATA_MSK | raw.gas_index);
+    f[1] = raw.meas_index;
+    f[2] = (uint8_t)(raw.pres_adc >> 12);
+    f[3] = (uint8_t)(raw.pres_adc >> 4);
+    f[4] = (uint8_t)(raw.pres_adc << 4);
+    f[5] = (uint8_t)(raw.temp_adc >> 12);
+    f[6] = (uint8_t)(raw.temp_adc >> 4);
+    f[7] = (uint8_t)(raw.temp_adc << 4);
+    f[8] = (uint8_t)(raw.hum_adc >> 8);
+    f[9] = (uint8_t)raw.hum_adc;
+    f[15] = (uint8_t)(raw.gas_adc >> 2);
+    f[16] = (uint8_t)((raw.gas_adc << 6) | BME68X_GASM_VALID_MSK | BME68X_HEAT_STAB_MSK | raw.gas_range);
+}
+
+void advance_sensor() {
+    while (running && start_us + (double)(produced + 1) * cycle_us <= now_us) {
+        write_field(produced++);
+    }
+}
+
+int8_t sim_read(uint8_t reg_addr, uint8_t *data, uint32_t len, void *) {
+    bus(len + 3);
+    advance_sensor();
+    memcpy(data, &regs[reg_addr], len);
+    for (int slot = 0; slot < 3; slot++) {
+        uint32_t status = BME68X_REG_FIELD0 + slot * BME68X_LEN_FIELD_OFFSET;
+        if (status >= reg_addr && status < reg_addr + len) {
+            regs[status] &= (uint8_t)~BME68X_NEW_DATA_MSK;
+        }
+    }
+    return BME68X_OK;
+}
+
+int8_t sim_write(uint8_t reg_addr, const uint8_t *data, uint32_t len, void *) {
+    bus(len + 2);
+    advance_sensor();
+    regs[reg_addr] = data[0];
+    for (uint32_t i = 1; i + 1 < len; i += 2) {
+        regs[data[i]] = data[i + 1];
+    }
+    bool parallel = (regs[BME68X_REG_CTRL_MEAS] & BME68X_MODE_MSK) == BME68X_PARALLEL_MODE;
+    if (parallel && !running) {
+        start_us = now_us;
+        produced = 0;
+    }
+    running = parallel;
+    return BME68X_OK;
+}
+
+void sim_delay_us(uint32_t period, void *) {
+    now_us += period;
+    advance_sensor();
+}
+
+struct Result {
+    long produced;
+    long drained;
+    long missed;        // meas_index gaps seen by the producer
+    long overruns;
+    long received;
+    long bad;           // out of order, duplicated or wrong values
+    long gaps;          // fields the consumer found missing
+};
+
+bool same(const BME688Sample &a, const BME688Sample &b) {
+    return a.temperature == b.temperature && a.pressure == b.pressure && a.humidity == b.humidity &&
+           a.gas_resistance == b.gas_resistance && a.status == b.status && a.gas_index == b.gas_index &&
+           a.meas_index == b.meas_index;
+}
+
+BME688Sample to_sample(const struct bme68x_data &d, int64_t timestamp_ms) {
+    BME688Sample s;
+    s.timestamp_ms = timestamp_ms;
+    s.temperature = d.temperature;
+    s.pressure = d.pressure / 100.0f;
+    s.humidity = d.humidity;
+    s.gas_resistance = d.gas_resistance / 1000.0f;
+    s.status = d.status;
+    s.gas_index = d.gas_index;
+    s.meas_index = d.meas_index;
+    return s;
+}
+
+// Pops until the producer is done and the ring is empty; checks every field
+// against the one the sensor produced, using its own copy of the calibration.
+void consume(BME688SampleRing &ring, const std::atomic<bool> &done, struct bme68x_dev dev, Result &r) {
+    long expect = 0;
+    BME688Sample s;
+    while (true) {
+        if (!ring.pop(s)) {
+            if (done.load(std::memory_order_acquire) && ring.size() == 0) break;
+            std::this_thread::yield();
+            continue;
+        }
+        // Like the producer, start counting at the first field drained.
+        if (r.received == 0) expect = s.meas_index;
+        uint8_t skip = (uint8_t)(s.meas_index - (uint8_t)expect);
+        if (skip > 3) {
+            r.bad++;                // a field from the past: duplicate or reordered
+        }
+        r.gaps += skip;
+        expect += skip;
+        struct bme68x_raw_data raw = field_raw(expect);
+        struct bme68x_data ref;
+        bme68x_compensate_raw_data(&raw, &ref, &dev);
+        if (!same(s, to_sample(ref, 0))) {
+            r.bad++;
+        }
+        expect++;
+        r.received++;
+    }
+}
+
+template <class Conf>
+bool run(const char *name, uint16_t shared_heatr_dur_ms, long fields, double poll_fields) {
+    for (int i = 0; i < 256; i++) {
+        regs[i] = (uint8_t)(i * 7 + 3);
+    }
+    regs[BME68X_REG_CHIP_ID] = BME68X_CHIP_ID;
+    regs[BME68X_REG_VARIANT_ID] = BME68X_VARIANT_GAS_HIGH;
+    regs[BME68X_REG_CTRL_MEAS] = 0;
+    for (int slot = 0; slot < 3; slot++) {
+        regs[BME68X_REG_FIELD0 + slot * BME68X_LEN_FIELD_OFFSET] = 0;
+    }
+    now_us = 0;
+    running = false;
+    profile_len = 1;
+
+    struct bme68x_dev dev;
+    memset(&dev, 0, sizeof(dev));
+    dev.intf = BME68X_I2C_INTF;
+    dev.read = sim_read;
+    dev.write = sim_write;
+    dev.delay_us = sim_delay_us;
+    dev.amb_temp = 25;
+    dev.shadow.enable = 1;
+
+    // As BME688::start_continuous() sets it up, with its default profile.
+    uint16_t temp_prof[1] = { 300 };
+    uint16_t mul_prof[1] = { 1 };
+    struct bme68x_conf conf = Conf::conf();
+    struct bme68x_heatr_conf heatr = {};
+    heatr.enable = BME68X_ENABLE;
+    heatr.heatr_temp_prof = temp_prof;
+    heatr.heatr_dur_prof = mul_prof;
+    heatr.profile_len = profile_len;
+    heatr.shared_heatr_dur = shared_heatr_dur_ms;
+    cycle_us = Conf::meas_dur_us(BME68X_PARALLEL_MODE) + (uint32_t)shared_heatr_dur_ms * 1000;
+    if (bme68x_init(&dev) != BME68X_OK || bme68x_set_conf(&conf, &dev) != BME68X_OK ||
+        bme68x_set_heatr_conf(BME68X_PARALLEL_MODE, &heatr, &dev) != BME68X_OK ||
+        bme68x_set_op_mode(BME68X_PARALLEL_MODE, &dev) != BME68X_OK) {
+        fprintf(stderr, "simulated sensor setup failed\n");
+        exit(1);
+    }
+
+    // continuous_poll_period_ms() for the safe runs
+    double period_us = poll_fields == 2 ? (2 * cycle_us) / 1000 * 1000.0 : poll_fields * cycle_us;
+    BME688Sample storage[RING_LEN];
+    BME688SampleRing ring(storage, RING_LEN);
+    std::atomic<bool> done(false);
+    Result r = {};
+    std::thread consumer(consume, std::ref(ring), std::cref(done), dev, std::ref(r));
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> jitter(0, JITTER_FIELDS * cycle_us);
+    bool have_index = false;
+    uint8_t last_index = 0;
+    double grid_us = now_us;
+    while (produced < fields) {
+        grid_us += period_us;
+        double wake_us = grid_us + jitter(rng);
+        if (wake_us > now_us) now_us = wake_us;
+        advance_sensor();
+
+        struct bme68x_data data[3];
+        uint8_t n_fields = 0;
+        int8_t rslt = bme68x_get_data(BME68X_PARALLEL_MODE, data, &n_fields, &dev);
+        if (rslt != BME68X_OK && rslt != BME68X_W_NO_NEW_DATA) {
+            fprintf(stderr, "bme68x_get_data failed: %d\n", rslt);
+            exit(1);
+        }
+        for (uint8_t i = 0; i < n_fields; i++) {
+            if (have_index) {
+                uint8_t step = (uint8_t)(data[i].meas_index - last_index);
+                if (step > 1) r.missed += step - 1;
+            }
+            last_index = data[i].meas_index;
+            have_index = true;
+            // The consumer keeps up on the device; here it only has to make room.
+            while (ring.free_space() == 0) {
+                std::this_thread::yield();
+            }
+            if (ring.push(to_sample(data[i], (int64_t)(now_us / 1000)))) {
+                r.drained++;
+            }
+        }
+    }
+    done.store(true, std::memory_order_release);
+    consumer.join();
+    r.produced = produced;
+    r.overruns = ring.overruns();
+
+    // Fields still in the sensor when the loop stopped, or lost before the
+    // first drain, are neither drained nor counted as missed.
+    long pending = r.produced - r.drained - r.missed;
+    printf("  %-34s %7.2f ms %8ld %8ld %6ld %8ld %8ld %5ld %5ld\n", name, cycle_us / 1000.0, r.produced,
+           r.received, r.missed, r.gaps, r.overruns, r.bad, pending);
+    bool accounted = r.received == r.drained && r.gaps == r.missed && r.bad == 0 && r.overruns == 0 &&
+                     pending >= 0 && pending <= 3;
+    if (poll_fields <= 2) {
+        return accounted && r.missed == 0;
+    }
+    return accounted && r.missed > 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    long fields = argc > 1 ? atol(argv[1]) : 200000;
+    if (fields <= 0) {
+        fprintf(stderr, "Usage: %s [fields]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%ld fields per run, %zu-slot ring, wake-ups up to %.1f field late\n\n", fields, RING_LEN,
+           JITTER_FIELDS);
+    printf("  %-34s %10s %8s %8s %6s %8s %8s %5s %5s\n", "run", "field", "produced", "received", "missed", "gaps",
+           "overruns", "bad", "left");
+    // The fastest field: T/P/H x1 and a 1 ms shared heater phase.
+    bool ok = run<FastConf>("T/P/H x1, 1 ms heater, 2-field poll", 1, fields, 2);
+    // start_continuous() defaults: a ~140 ms cycle.
+    uint16_t dflt_heatr_ms = (uint16_t)(140 - DefaultConf::meas_dur_us(BME68X_PARALLEL_MODE) / 1000);
+    ok = run<DefaultConf>("default mode, 2-field poll", dflt_heatr_ms, fields / 20, 2) && ok;
+    // Too slow on purpose: every loss must show up in missed_samples().
+    ok = run<FastConf>("T/P/H x1, 4-field poll (lossy)", 1, fields, 4) && ok;
+    printf("\nno loss at the poll period, every loss counted when polling too slowly: %s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+// Host-side benchmark for the BME688 gas cadence (BME688::set_gas_cadence).
+//
+// Runs forced reads against a simulated sensor register map with the heater
+// on every Nth read only, using the same trigger logic as bme688_lib: the
+// ctrl_gas_1 values are read once after bme68x_set_heatr_conf(), and a read
+// that switches the gas measurement on or off writes ctrl_gas_1 together with
+// ctrl_meas in one transaction. It reports the effective T/P/H and gas sample
+// rates and the I2C traffic per sample. The baseline row is the loop before
+// the cadence: bme68x_set_op_mode() before every read, with the heater always
+// on. Each cadence row also gives its T/P/H rate and bytes per sample
+// relative to that baseline.
+//
+// One read costs its measurement window (forced_meas_dur_us, plus the heater
+// duration on gas reads) and its bus time at 100 kHz: 9 clocks per byte,
+// counting the device address byte of every transaction.
+//
+// bme688_lib.h pulls in ESP-IDF headers, so the trigger logic is repeated
+// below; keep it in sync with BME688::trigger_forced().
+//
+// Build from this directory:
+//   cc -O2 -c ../components/bme68x/bme68x.c -I../components/bme68x -o bme68x.o
+//   c++ -std=c++17 -O2 -I../components/bme68x bme688_gas_cadence_bench.cpp bme68x.o -o bme688_gas_cadence_bench
+//
+// Usage: ./bme688_gas_cadence_bench [reads]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "bme68x.h"
+#include "bme688_static_conf.h"
+
+typedef BME688DefaultConf Conf;
+
+namespace {
+
+uint8_t regs[256];
+unsigned long transactions;
+unsigned long bytes;
+unsigned long heated_reads;
+
+// Register address plus data bytes; the device address is added per transaction below.
+int8_t sim_read(uint8_t reg_addr, uint8_t *data, uint32_t len, void *) {
+    memcpy(data, &regs[reg_addr], len);
+    transactions++;
+    bytes += len + 1;
+    return BME68X_OK;
+}
+
+// bme68x_set_regs sends the first register address, then data/address pairs.
+int8_t sim_write(uint8_t reg_addr, const uint8_t *data, uint32_t len, void *) {
+    regs[reg_addr] = data[0];
+    for (uint32_t i = 1; i + 1 < len; i += 2) {
+        regs[data[i]] = data[i + 1];
+    }
+    transactions++;
+    bytes += len + 1;
+    if ((regs[BME68X_REG_CTRL_MEAS] & BME68X_MODE_MSK) == BME68X_FORCED_MODE) {
+        // The simulated measurement finishes at once; the gas result is only
+        // valid if run_gas was set when it started.
+        bool gas = (regs[BME68X_REG_CTRL_GAS_1] & BME68X_RUN_GAS_MSK) != 0;
+        heated_reads += gas;
+        regs[BME68X_REG_FIELD0 + 14] = gas ? (BME68X_GASM_VALID_MSK | BME68X_HEAT_STAB_MSK) : 0;
+        regs[BME68X_REG_CTRL_MEAS] &= (uint8_t)~BME68X_MODE_MSK;
+    }
+    return BME68X_OK;
+}
+
+void sim_delay_us(uint32_t, void *) {
+}
+
+bool init_sim(struct bme68x_dev &dev) {
+    for (int i = 0; i < 256; i++) {
+        regs[i] = (uint8_t)(i * 7 + 3);
+    }
+    regs[BME68X_REG_CHIP_ID] = BME68X_CHIP_ID;
+    regs[BME68X_REG_VARIANT_ID] = BME68X_VARIANT_GAS_HIGH;
+    regs[BME68X_REG_CTRL_MEAS] = 0;
+    regs[BME68X_REG_CTRL_GAS_1] = 0;
+    regs[BME68X_REG_FIELD0] = BME68X_NEW_DATA_MSK;
+
+    memset(&dev, 0, sizeof(dev));
+    dev.intf = BME68X_I2C_INTF;
+    dev.read = sim_read;
+    dev.write = sim_write;
+    dev.delay_us = sim_delay_us;
+    dev.amb_temp = 25;
+    struct bme68x_conf conf = Conf::conf();
+    struct bme68x_heatr_conf heatr = Conf::heatr_conf();
+    return bme68x_init(&dev) == BME68X_OK && bme68x_set_conf(&conf, &dev) == BME68X_OK &&
+           bme68x_set_heatr_conf(BME68X_FORCED_MODE, &heatr, &dev) == BME68X_OK;
+}
+
+struct Result {
+    double tph_hz;
+    double gas_hz;
+    double transactions_per_sample;
+    double bytes_per_sample;
+    unsigned long gas_valid;
+    unsigned long gas_expected;
+};
+
+Result finish(long reads, double elapsed_us) {
+    Result r = {};
+    elapsed_us += (bytes + transactions) * 90.0;
+    r.tph_hz = reads * 1e6 / elapsed_us;
+    r.gas_hz = heated_reads * 1e6 / elapsed_us;
+    r.transactions_per_sample = (double)transactions / reads;
+    r.bytes_per_sample = (double)(bytes + transactions) / reads;
+    return r;
+}
+
+void setup(struct bme68x_dev &dev) {
+    if (!init_sim(dev)) {
+        fprintf(stderr, "simulated sensor setup failed\n");
+        exit(1);
+    }
+    transactions = 0;
+    bytes = 0;
+    heated_reads = 0;
+}
+
+// The read before the gas cadence: bme68x_set_op_mode() reads ctrl_meas,
+// then writes it with the forced mode, and every read runs the heater.
+Result run_baseline(long reads) {
+    struct bme68x_dev dev;
+    setup(dev);
+    double elapsed_us = 0;
+    unsigned long gas_valid = 0;
+    for (long i = 0; i < reads; i++) {
+        bme68x_set_op_mode(BME68X_FORCED_MODE, &dev);
+        elapsed_us += Conf::forced_period_us;
+
+        struct bme68x_data data;
+        uint8_t n_fields = 0;
+        bme68x_get_data(BME68X_FORCED_MODE, &data, &n_fields, &dev);
+        gas_valid += n_fields > 0 && (data.status & BME68X_GASM_VALID_MSK);
+    }
+    Result r = finish(reads, elapsed_us);
+    r.gas_valid = gas_valid;
+    r.gas_expected = reads;
+    return r;
+}
+
+Result run_cadence(long reads, unsigned every_n) {
+    struct bme68x_dev dev;
+    setup(dev);
+
+    // BME688::load_gas_regs()
+    uint8_t ctrl_gas_1 = 0;
+    bme68x_get_regs(BME68X_REG_CTRL_GAS_1, &ctrl_gas_1, 1, &dev);
+    const uint8_t ctrl_gas_off = ctrl_gas_1 & (uint8_t)~BME68X_RUN_GAS_MSK;
+    const uint8_t ctrl_gas_on = ctrl_gas_1;
+    bool gas_armed = true;
+    // The ctrl_gas_1 read above is set-up, not sampling
+    transactions = 0;
+    bytes = 0;
+
+    double elapsed_us = 0;
+    unsigned long gas_valid = 0;
+    unsigned long gas_expected = 0;
+    for (long i = 0; i < reads; i++) {
+        // BME688::trigger_forced()
+        bool gas = (i % every_n) == 0;
+        if (gas == gas_armed) {
+            bme688_trigger_forced(Conf::ctrl_meas_forced, &dev);
+        } else {
+            bme688_trigger_forced_gas(Conf::ctrl_meas_forced, gas ? ctrl_gas_on : ctrl_gas_off, &dev);
+            gas_armed = gas;
+        }
+        elapsed_us += gas ? Conf::forced_period_us : Conf::forced_meas_dur_us;
+
+        struct bme68x_data data;
+        uint8_t n_fields = 0;
+        bme68x_get_data(BME68X_FORCED_MODE, &data, &n_fields, &dev);
+        gas_expected += gas;
+        gas_valid += gas && n_fields > 0 && (data.status & BME68X_GASM_VALID_MSK);
+    }
+    Result r = finish(reads, elapsed_us);
+    r.gas_valid = gas_valid;
+    r.gas_expected = gas_expected;
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    long reads = argc > 1 ? atol(argv[1]) : 10000;
+    if (reads <= 0) {
+        fprintf(stderr, "Usage: %s [reads]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%ld forced reads per cadence, TPH window %u us, heater %u ms\n", reads,
+           (unsigned)Conf::forced_meas_dur_us, (unsigned)Conf::heatr_dur_ms);
+    printf("gas every  T/P/H Hz  gas Hz  transactions  I2C bytes/sample  gas valid    rate  bytes\n");
+    Result base = run_baseline(reads);
+    printf("%9s  %8.1f  %6.2f  %12.2f  %16.2f  %lu/%lu\n", "baseline", base.tph_hz, base.gas_hz,
+           base.transactions_per_sample, base.bytes_per_sample, base.gas_valid, base.gas_expected);
+    bool ok = base.gas_valid == base.gas_expected;
+    const unsigned cadences[] = { 1, 2, 5, 10, 30, 100 };
+    for (unsigned n : cadences) {
+        Result r = run_cadence(reads, n);
+        printf("%9u  %8.1f  %6.2f  %12.2f  %16.2f  %lu/%lu  %5.2fx  %4.0f%%\n", n, r.tph_hz, r.gas_hz,
+               r.transactions_per_sample, r.bytes_per_sample, r.gas_valid, r.gas_expected, r.tph_hz / base.tph_hz,
+               100.0 * (r.bytes_per_sample / base.bytes_per_sample - 1.0));
+        ok = ok && r.gas_valid == r.gas_expected;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+// Host-side benchmark for the BME688 runtime modes (BME688::set_mode).
+//
+// Samples a simulated signal back to back in each mode and reports the
+// achieved sample rate, the noise standard deviation around the true value,
+// and how long a pressure step takes to settle through the IIR filter.
+//
+// The mode settings and forced periods come from BME688StaticConf<>, with the
+// same parameters as the firmware's mode typedefs. The sensor model is:
+//  - one read costs forced_period_us plus the trigger and field readout on a
+//    100 kHz bus (about 2.3 ms, see bme688_static_conf_bench);
+//  - RMS noise of one conversion at x1 oversampling is noise_t / noise_p /
+//    noise_h and shrinks with the square root of the oversampling ratio;
+//  - the IIR filter of size N applies to temperature and pressure only:
+//    out = (out_prev * N + in) / (N + 1).
+// The noise figures are assumptions in the range of the datasheet; pass
+// other values on the command line to match a measured sensor.
+//
+// bme688_lib.h pulls in ESP-IDF headers, so the mode typedefs are repeated
+// below; keep them in sync with bme688_lib.h.
+//
+// Build from this directory:
+//   c++ -std=c++17 -O2 -I../components/bme68x bme688_mode_bench.cpp -o bme688_mode_bench
+//
+// Usage: ./bme688_mode_bench [noise_t_degC] [noise_p_Pa] [noise_h_pct]
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include "bme688_static_conf.h"
+
+// Same as BME688SensorConf / BME688LowLatencyConf / BME688PrecisionConf in bme688_lib.h.
+typedef BME688DefaultConf DefaultConf;
+typedef BME688StaticConf<BME68X_OS_1X, BME68X_OS_1X, BME68X_OS_1X, BME68X_FILTER_OFF, BME68X_ODR_NONE, 300, 100,
+                         BME68X_DISABLE> LowLatencyConf;
+typedef BME688StaticConf<BME68X_OS_8X, BME68X_OS_16X, BME68X_OS_4X, BME68X_FILTER_SIZE_15> PrecisionConf;
+
+namespace {
+
+const double BUS_US_PER_READ = 2250;    // trigger + single-burst readout at 100 kHz
+const double SIM_SECONDS = 120;
+const double STEP_PA = 50;              // pressure step half way through the run
+
+double noise_t = 0.01;                  // degC RMS at x1
+double noise_p = 1.4;                   // Pa RMS at x1
+double noise_h = 0.03;                  // %rH RMS at x1
+
+struct Result {
+    double rate_hz;
+    double latency_ms;
+    double sd_t, sd_p, sd_h;
+    double settle_ms;                   // time for 90 % of the pressure step
+};
+
+double oversampling(uint8_t os) {
+    return os == BME68X_OS_NONE ? 0 : (double)(1 << (os - 1));
+}
+
+unsigned filter_size(uint8_t filter) {
+    return filter == BME68X_FILTER_OFF ? 0 : (1u << filter) - 1;
+}
+
+struct Welford {
+    long n = 0;
+    double mean = 0, m2 = 0;
+    void add(double x) {
+        n++;
+        double d = x - mean;
+        mean += d / n;
+        m2 += d * (x - mean);
+    }
+    double sd() const { return n > 1 ? std::sqrt(m2 / (n - 1)) : 0; }
+};
+
+template <class Conf>
+Result run_mode() {
+    std::mt19937_64 rng(688);
+    std::normal_distribution<double> gauss(0.0, 1.0);
+    const double sd1_t = noise_t / std::sqrt(oversampling(Conf::os_temp));
+    const double sd1_p = noise_p / std::sqrt(oversampling(Conf::os_pres));
+    const double sd1_h = Conf::os_hum == BME68X_OS_NONE ? 0 : noise_h / std::sqrt(oversampling(Conf::os_hum));
+    const unsigned n = filter_size(Conf::filter);
+
+    const double period_us = Conf::forced_period_us + BUS_US_PER_READ;
+    const double step_at_us = SIM_SECONDS * 1e6 / 2;
+    const double true_t = 23.0, true_p = 100000.0, true_h = 45.0;
+
+    Welford err_t, err_p, err_h;
+    double filt_t = true_t, filt_p = true_p;
+    double settle_ms = -1;
+    long samples = 0;
+    for (double t_us = period_us; t_us < SIM_SECONDS * 1e6; t_us += period_us) {
+        bool after_step = t_us >= step_at_us;
+        double p_now = true_p + (after_step ? STEP_PA : 0);
+        double in_t = true_t + sd1_t * gauss(rng);
+        double in_p = p_now + sd1_p * gauss(rng);
+        double in_h = true_h + sd1_h * gauss(rng);
+        filt_t = (filt_t * n + in_t) / (n + 1);
+        filt_p = (filt_p * n + in_p) / (n + 1);
+        samples++;
+
+        if (!after_step) {
+            // Noise is measured on the settled first half only.
+            if (t_us > 10e6) {
+                err_t.add(filt_t - true_t);
+                err_p.add(filt_p - true_p);
+                err_h.add(in_h - true_h);
+            }
+        } else if (settle_ms < 0 && filt_p - true_p >= 0.9 * STEP_PA) {
+            settle_ms = (t_us - step_at_us) / 1000;
+        }
+    }
+
+    Result r;
+    r.rate_hz = samples / SIM_SECONDS;
+    r.latency_ms = period_us / 1000;
+    r.sd_t = err_t.sd();
+    r.sd_p = err_p.sd();
+    r.sd_h = err_h.sd();
+    r.settle_ms = settle_ms;
+    return r;
+}
+
+void print(const char *name, const Result &r) {
+    printf("%-12s %7.1f %9.1f %10.4f %9.3f %10.4f %10.0f\n", name, r.rate_hz, r.latency_ms, r.sd_t, r.sd_p, r.sd_h,
+           r.settle_ms);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc > 1) noise_t = atof(argv[1]);
+    if (argc > 2) noise_p = atof(argv[2]);
+    if (argc > 3) noise_h = atof(argv[3]);
+
+    printf("x1 noise: %.4f degC, %.3f Pa, %.4f %%rH; %.0f s simulated per mode\n", noise_t, noise_p, noise_h,
+           SIM_SECONDS);
+    printf("mode         rate/Hz  read/ms   sd T/degC  sd P/Pa  sd H/%%rH  P 90%%/ms\n");
+    print("low-latency", run_mode<LowLatencyConf>());
+    print("default", run_mode<DefaultConf>());
+    print("precision", run_mode<PrecisionConf>());
+    return 0;
+}
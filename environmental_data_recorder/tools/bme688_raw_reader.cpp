@@ -0,0 +1,135 @@
+// Host-side reader for raw BME688 capture files (CONFIG_EDR_RAW_CAPTURE).
+//
+// Compensates every sample block with the calibration block before it,
+// using the same Bosch driver code as the firmware, and prints CSV. Values are
+// in bme68x_data units (degC, Pa, %rH, Ohms) and printed with enough digits to
+// round-trip, so they compare equal to what bme68x_get_data returns on the device.
+//
+// Build from this directory (add -DBME68X_DO_NOT_USE_FPU to both lines if the
+// firmware is built without FPU support):
+//   cc -c ../components/bme68x/bme68x.c -I../components/bme68x -o bme68x.o
+//   c++ -std=c++11 -I../components/bme68x -I../components/bme688_lib/include bme688_raw_reader.cpp bme68x.o -o bme688_raw_reader
+//
+// Usage: ./bme688_raw_reader raw.bin [raw.1.bin ...] > raw.csv
+//
+// Every segment starts with a calibration block, so each file decodes on its
+// own; give several in order to get one CSV. The session column counts the
+// session ids the firmware picks at boot.
+// Reading a file stops at the first block that cannot be part of the log: an
+// unknown tag, a cut-off block, a calibration block past the start of the
+// file, a sample of another session than the file's calibration block, or a
+// sample older than the one before it. That is where the stale tail of a
+// segment left at its preallocated size by a power cut begins.
+
+#include <cstdio>
+#include <cstring>
+#include "bme68x.h"
+#include "bme688_raw_format.h"
+
+struct Reader {
+    struct bme68x_dev dev;
+    bool have_calib = false;        // The file being read started with a calibration block
+    bool have_session = false;
+    uint32_t session_id = 0;
+    uint32_t last_ms = 0;
+    unsigned session = 0;
+    unsigned long samples = 0;
+};
+
+// Returns false at the first block that is not part of the log
+static bool read_block(Reader &r, FILE *f, const char *path) {
+    uint8_t block[BME688_RAW_CALIB_LEN];
+    long offset = ftell(f);
+    int tag = fgetc(f);
+    if (tag == EOF) return false;
+    block[0] = (uint8_t)tag;
+    if (tag == BME688_RAW_TAG_CALIB) {
+        uint8_t coeff[BME68X_LEN_COEFF_ALL];
+        uint8_t variant_id;
+        uint32_t session_id;
+        if (fread(&block[1], 1, BME688_RAW_CALIB_LEN - 1, f) != BME688_RAW_CALIB_LEN - 1 ||
+            !bme688_raw_decode_calib(block, session_id, coeff, variant_id)) {
+            fprintf(stderr, "%s: no calibration block of version %u at offset %ld, stopping\n", path,
+                    BME688_RAW_VERSION, offset);
+            return false;
+        }
+        if (offset != 0) {
+            fprintf(stderr, "%s: calibration block at offset %ld, past the start of the file, stopping\n",
+                    path, offset);
+            return false;
+        }
+        if (!r.have_session || session_id != r.session_id) {
+            r.have_session = true;
+            r.session_id = session_id;
+            r.session++;
+            r.last_ms = 0;
+        }
+        bme68x_set_calib_regs(coeff, variant_id, &r.dev);
+        r.have_calib = true;
+    } else if (tag == BME688_RAW_TAG_SAMPLE) {
+        if (fread(&block[1], 1, BME688_RAW_SAMPLE_LEN - 1, f) != BME688_RAW_SAMPLE_LEN - 1) {
+            fprintf(stderr, "%s: sample block cut off at offset %ld, stopping\n", path, offset);
+            return false;
+        }
+        if (!r.have_calib) {
+            fprintf(stderr, "%s: no calibration block at the start of the file, stopping\n", path);
+            return false;
+        }
+        uint32_t session_id;
+        uint32_t timestamp_ms;
+        struct bme68x_raw_data raw;
+        struct bme68x_data data;
+        bme688_raw_decode_sample(block, session_id, timestamp_ms, raw);
+        if (session_id != r.session_id) {
+            fprintf(stderr, "%s: sample at offset %ld is from another session, stopping\n", path, offset);
+            return false;
+        }
+        if (timestamp_ms < r.last_ms) {
+            fprintf(stderr, "%s: sample at offset %ld is older than the one before, stopping\n", path, offset);
+            return false;
+        }
+        r.last_ms = timestamp_ms;
+        bme68x_compensate_raw_data(&raw, &data, &r.dev);
+#ifdef BME68X_USE_FPU
+        printf("%u,%u,%.9g,%.9g,%.9g,%.9g,0x%02x,%u,%u\n", r.session, (unsigned)timestamp_ms,
+               data.temperature, data.pressure, data.humidity, data.gas_resistance,
+               data.status, data.gas_index, data.meas_index);
+#else
+        printf("%u,%u,%d,%u,%u,%u,0x%02x,%u,%u\n", r.session, (unsigned)timestamp_ms,
+               data.temperature, (unsigned)data.pressure, (unsigned)data.humidity,
+               (unsigned)data.gas_resistance, data.status, data.gas_index, data.meas_index);
+#endif
+        r.samples++;
+    } else {
+        fprintf(stderr, "%s: unknown block tag 0x%02x at offset %ld, stopping\n", path, tag, offset);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <raw.bin> [raw.1.bin ...]\n", argv[0]);
+        return 1;
+    }
+
+    Reader r;
+    memset(&r.dev, 0, sizeof(r.dev));
+
+    printf("session,timestamp_ms,temperature,pressure,humidity,gas_resistance,status,gas_index,meas_index\n");
+
+    for (int i = 1; i < argc; i++) {
+        FILE *f = fopen(argv[i], "rb");
+        if (f == NULL) {
+            perror(argv[i]);
+            return 1;
+        }
+        r.have_calib = false;
+        while (read_block(r, f, argv[i])) {
+        }
+        fclose(f);
+    }
+
+    fprintf(stderr, "%lu samples in %u sessions\n", r.samples, r.session);
+    return 0;
+}
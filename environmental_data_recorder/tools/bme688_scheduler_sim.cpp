@@ -0,0 +1,264 @@
+// Host-side benchmark for BME688Scheduler with simulated sensors.
+//
+// Models N BME688 sensors on one I2C bus and compares two ways of sampling
+// them: a single task calling read_measurement() on each sensor in turn
+// (trigger, block through the heater wait, read out), and BME688Scheduler,
+// which re-triggers each sensor from its completion so the heater waits
+// overlap and only the bus transactions are serialized. Sensors beyond the
+// two addresses of one bus segment (0x76/0x77) sit behind a multiplexer and
+// pay for a channel switch whenever the bus moves to another segment.
+//
+// The scheduler side runs BME688SchedulerPolicy (bme688_scheduler_policy.h),
+// the code of BME688Scheduler::run(), in a loop like run(): wait up to 100 ms
+// for a completion, pass it on, re-trigger, retry idle sensors. The sensors
+// and the bus around it are modelled; the blocking loop is modelled too. Two
+// more runs check what the steady state does not reach: a sensor whose
+// starts fail for the first 5 s (an I2C backoff) is retried and comes back,
+// and stopping lets the measurements in flight finish, with one completion
+// for every trigger.
+//
+// Timings follow the firmware: forced-mode measurement with 8x/4x/2x
+// oversampling (bme68x_get_meas_dur) plus a 100 ms heater phase, a trigger
+// of one register read and one write made by the scheduler task, a
+// single-burst field readout, and a 100 Hz FreeRTOS tick for the blocking delay.
+//
+// Build from this directory:
+//   c++ -std=c++11 -O2 -I../components/bme688_lib/include bme688_scheduler_sim.cpp -o bme688_scheduler_sim
+//
+// Usage: ./bme688_scheduler_sim [i2c_clk_hz] [max_sensors]
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "bme688_scheduler_policy.h"
+
+namespace {
+
+struct Timing {
+    double byte_us;         // one byte plus ACK on the wire
+    double txn_overhead_us; // driver, ISR and task switch per transaction
+    double meas_us;         // TPH conversion (bme68x_get_meas_dur)
+    double heatr_us;        // heater phase
+    double tick_us;         // FreeRTOS tick
+};
+
+// Bytes on the wire, including address and register bytes.
+const int TRIGGER_BYTES = 4 + 3;    // read ctrl_meas, write ctrl_meas
+const int READOUT_BYTES = 3 + 17;   // one burst over the field registers
+const int MUX_SELECT_BYTES = 2;     // address + channel mask
+
+double txn_us(const Timing &t, int bytes) {
+    return t.txn_overhead_us + bytes * t.byte_us;
+}
+
+int segment_of(int sensor) {
+    return sensor / 2;
+}
+
+// Blocking loop: each read_measurement() owns the calling task for a full cycle.
+double blocking_rate(const Timing &t, int sensors, double duration_us) {
+    double wait_ms = (t.meas_us + t.heatr_us) / 1000.0;
+    // vTaskDelay(pdMS_TO_TICKS(ms) + 1)
+    double wait_us = ((int)(wait_ms * 1000.0 / t.tick_us) + 1) * t.tick_us;
+
+    double now = 0;
+    long samples = 0;
+    int current_segment = -1;
+    while (now < duration_us) {
+        for (int s = 0; s < sensors && now < duration_us; s++) {
+            int mux_txns = 0;
+            if (sensors > 2 && segment_of(s) != current_segment) {
+                current_segment = segment_of(s);
+                mux_txns = 1;
+            }
+            now += mux_txns * txn_us(t, MUX_SELECT_BYTES) + txn_us(t, TRIGGER_BYTES);
+            now += wait_us;
+            now += txn_us(t, READOUT_BYTES);
+            samples++;
+        }
+    }
+    return samples / (duration_us / 1e6);
+}
+
+const double RECEIVE_TIMEOUT_US = 100000;  // xQueueReceive() in BME688Scheduler::run()
+
+// The bus, the sensors' timers and the scheduler's done queue. Bus
+// transactions are granted in request order.
+struct Sim {
+    Timing t;
+    int sensors;
+    double now = 0;             // scheduler task time
+    double bus_free = 0;
+    double bus_busy = 0;
+    int current_segment = -1;
+    long completions = 0;
+    // Readouts due when a sensor's measurement window is over, by time
+    std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int> >,
+                        std::greater<std::pair<double, int> > > readouts;
+    std::deque<std::pair<double, int> > done;   // completions posted, by time
+
+    Sim(const Timing &t, int sensors) : t(t), sensors(sensors) {}
+
+    // Runs a transaction for sensor requested at at; returns when it ends.
+    double transfer(int s, double at, int bytes) {
+        double start = at > bus_free ? at : bus_free;
+        double cost = txn_us(t, bytes);
+        if (sensors > 2 && segment_of(s) != current_segment) {
+            current_segment = segment_of(s);
+            cost += txn_us(t, MUX_SELECT_BYTES);
+        }
+        bus_free = start + cost;
+        bus_busy += cost;
+        return bus_free;
+    }
+
+    // The readout that asked for the bus first, if it did by until.
+    bool next_readout(double until) {
+        if (readouts.empty() || readouts.top().first > until) return false;
+        std::pair<double, int> r = readouts.top();
+        readouts.pop();
+        done.push_back(std::make_pair(transfer(r.second, r.first, READOUT_BYTES), r.second));
+        completions++;
+        return true;
+    }
+
+    // xQueueReceive(done_queue, ..., timeout)
+    bool receive(double timeout_us, int &sensor) {
+        double deadline = now + timeout_us;
+        for (;;) {
+            if (!done.empty() && (readouts.empty() || done.front().first <= readouts.top().first)) break;
+            if (!next_readout(deadline)) break;
+        }
+        if (done.empty() || done.front().first > deadline) {
+            now = deadline;
+            return false;
+        }
+        if (done.front().first > now) now = done.front().first;
+        sensor = done.front().second;
+        done.pop_front();
+        return true;
+    }
+};
+
+struct SimSensor {
+    int index;
+    double refuse_until_us = 0;     // starts fail before this, as in an I2C backoff
+    long triggers = 0;
+
+    // BME688::start_measurement(): the trigger runs in the calling task
+    bool start_measurement(Sim *sim) {
+        if (sim->now < refuse_until_us) return false;
+        while (sim->next_readout(sim->now)) {
+        }
+        sim->now = sim->transfer(index, sim->now, TRIGGER_BYTES);
+        sim->readouts.push(std::make_pair(sim->now + sim->t.meas_us + sim->t.heatr_us, index));
+        triggers++;
+        return true;
+    }
+};
+
+struct SchedulerRun {
+    double rate;
+    double bus_busy;
+    double first_sample_us[BME688_SCHEDULER_MAX_SENSORS];
+    size_t in_flight_at_stop;
+    long triggers;
+    long completions;
+    bool drained;
+};
+
+// BME688Scheduler::run() on simulated sensors, stopped after duration_us
+SchedulerRun run_scheduler(const Timing &t, int n, double duration_us, double refuse_us) {
+    Sim sim(t, n);
+    SimSensor sensors[BME688_SCHEDULER_MAX_SENSORS];
+    SimSensor *list[BME688_SCHEDULER_MAX_SENSORS];
+    SchedulerRun r = {};
+    for (int i = 0; i < n; i++) {
+        sensors[i].index = i;
+        list[i] = &sensors[i];
+        r.first_sample_us[i] = -1;
+    }
+    sensors[0].refuse_until_us = refuse_us;
+
+    BME688SchedulerPolicy<SimSensor, Sim *> policy(list, n, &sim);
+    policy.start_all();
+    bool stopping = false;
+    long samples = 0;
+    while (policy.running(stopping)) {
+        int s;
+        if (sim.receive(RECEIVE_TIMEOUT_US, s)) {
+            if (sim.now < duration_us) samples++;
+            if (r.first_sample_us[s] < 0) r.first_sample_us[s] = sim.now;
+            policy.completed(list[s], stopping);
+        }
+        policy.retry_idle(stopping);
+        if (!stopping && sim.now >= duration_us) {
+            // BME688Scheduler::stop()
+            stopping = true;
+            r.in_flight_at_stop = policy.measurements_in_flight();
+            r.bus_busy = sim.bus_busy / sim.now;
+        }
+    }
+
+    r.rate = samples / (duration_us / 1e6);
+    for (int i = 0; i < n; i++) {
+        r.triggers += sensors[i].triggers;
+    }
+    r.completions = sim.completions;
+    r.drained = sim.readouts.empty() && sim.done.empty() && r.completions == r.triggers;
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    double clk_hz = argc > 1 ? atof(argv[1]) : 100000;
+    int max_sensors = argc > 2 ? atoi(argv[2]) : 8;
+    if (clk_hz <= 0 || max_sensors <= 0 || max_sensors > BME688_SCHEDULER_MAX_SENSORS) {
+        fprintf(stderr, "Usage: %s [i2c_clk_hz] [max_sensors]\n", argv[0]);
+        return 1;
+    }
+
+    Timing t;
+    t.byte_us = 9 * 1e6 / clk_hz;
+    t.txn_overhead_us = 60;
+    t.meas_us = 14 * 1963 + 4 * 477 + 5 * 477 + 1000;
+    t.heatr_us = 100000;
+    t.tick_us = 10000;
+    const double duration_us = 60e6;
+
+    printf("I2C %.0f kHz, %.1f ms per measurement, 60 s simulated\n", clk_hz / 1000,
+           (t.meas_us + t.heatr_us) / 1000);
+    printf("sensors  blocking/s  scheduled/s  speedup  bus busy\n");
+    for (int n = 1; n <= max_sensors; n++) {
+        double blocking = blocking_rate(t, n, duration_us);
+        SchedulerRun r = run_scheduler(t, n, duration_us, 0);
+        printf("%7d  %10.2f  %11.2f  %6.2fx  %7.1f%%\n", n, blocking, r.rate, r.rate / blocking, r.bus_busy * 100);
+    }
+
+    // Sensor 0 refuses its starts for a while; the others keep running
+    const double refuse_us = 5e6;
+    const double cycle_us = t.meas_us + t.heatr_us;
+    SchedulerRun r = run_scheduler(t, max_sensors, duration_us, refuse_us);
+    // Within a pass of the loop and a measurement, plus the bus waits behind the others
+    bool retry_ok = r.first_sample_us[0] > refuse_us &&
+                    r.first_sample_us[0] <= refuse_us + RECEIVE_TIMEOUT_US + 2 * cycle_us;
+    for (int i = 1; i < max_sensors; i++) {
+        // The others do not wait for it
+        retry_ok = retry_ok && r.first_sample_us[i] > 0 && r.first_sample_us[i] < refuse_us;
+    }
+    printf("\nsensor 0 refuses starts for %.0f s: ", refuse_us / 1e6);
+    if (r.first_sample_us[0] < 0) {
+        printf("no sample: %s\n", retry_ok ? "PASS" : "FAIL");
+    } else {
+        printf("first sample %.0f ms after start: %s\n", r.first_sample_us[0] / 1000, retry_ok ? "PASS" : "FAIL");
+    }
+    bool drain_ok = r.in_flight_at_stop > 0 && r.drained;
+    printf("stop with %u measurement(s) in flight: %ld triggers, %ld completions: %s\n",
+           (unsigned)r.in_flight_at_stop, r.triggers, r.completions, drain_ok ? "PASS" : "FAIL");
+    return retry_ok && drain_ok ? 0 : 1;
+}
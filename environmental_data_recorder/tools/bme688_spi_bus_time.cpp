@@ -0,0 +1,262 @@
+// Host-side bus-time comparison of the BME688 over I2C and SPI.
+//
+// Runs the register traffic of bme688_lib against a simulated sensor, once
+// through the I2C interface and once through the SPI interface of the Bosch
+// driver, and reports per phase (cold init, warm init, mode change, forced
+// sample) the transactions, bytes and modelled bus time:
+//  - I2C at 100 and 400 kHz: 9 clocks per byte, plus the device address byte
+//    of every write and the two address bytes of every register read;
+//  - SPI at 10 MHz: 8 clocks per byte, no device address;
+//  - a fixed per-transaction cost for the driver call: TXN_OVERHEAD_I2C_US
+//    for i2c_master (as in i2c_arbiter_sim), TXN_OVERHEAD_SPI_US for
+//    spi_device_polling_transmit.
+// The SPI register map is split in two memory pages. The driver now tracks
+// the page register, so a page switch is one write; before, every switch
+// read the register first. The "SPI uncached" column adds that read back.
+// The compensated samples of both interfaces must match.
+//
+// bme688_lib.h pulls in ESP-IDF headers, so the sequences below repeat the
+// driver calls of the BME688 constructor, set_mode() and trigger_forced().
+//
+// Build from this directory:
+//   cc -O2 -c ../components/bme68x/bme68x.c -I../components/bme68x -o bme68x.o
+//   c++ -std=c++17 -O2 -I../components/bme68x bme688_spi_bus_time.cpp bme68x.o -o bme688_spi_bus_time
+//
+// Usage: ./bme688_spi_bus_time [samples]
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "bme68x.h"
+#include "bme688_static_conf.h"
+
+namespace {
+
+const double TXN_OVERHEAD_I2C_US = 60;
+const double TXN_OVERHEAD_SPI_US = 10;
+const double SPI_CLK_HZ = 10e6;
+
+// The sensor's registers by I2C address, and the SPI status register
+// holding the memory page bit.
+uint8_t regs[256];
+uint8_t spi_status;
+
+struct Traffic {
+    unsigned long reads;
+    unsigned long writes;
+    unsigned long bytes;            // register address and data bytes
+    unsigned long page_switches;
+};
+
+Traffic traffic;
+
+// I2C address of an SPI register address in the current memory page.
+uint8_t spi_to_i2c(uint8_t spi_addr) {
+    spi_addr &= 0x7f;
+    return (spi_status & BME68X_MEM_PAGE_MSK) ? spi_addr : (uint8_t)(spi_addr | 0x80);
+}
+
+void reg_write(uint8_t addr, uint8_t value) {
+    if (addr == BME68X_REG_SOFT_RESET && value == BME68X_SOFT_RESET_CMD) {
+        spi_status = 0;
+        return;
+    }
+    regs[addr] = value;
+    if ((regs[BME68X_REG_CTRL_MEAS] & BME68X_MODE_MSK) == BME68X_FORCED_MODE) {
+        // The simulated measurement finishes at once.
+        regs[BME68X_REG_FIELD0] = BME68X_NEW_DATA_MSK;
+        regs[BME68X_REG_FIELD0 + 14] = BME68X_GASM_VALID_MSK | BME68X_HEAT_STAB_MSK;
+        regs[BME68X_REG_CTRL_MEAS] &= (uint8_t)~BME68X_MODE_MSK;
+    }
+}
+
+int8_t i2c_read(uint8_t reg_addr, uint8_t *data, uint32_t len, void *) {
+    memcpy(data, &regs[reg_addr], len);
+    traffic.reads++;
+    traffic.bytes += len + 1;
+    return BME68X_OK;
+}
+
+// bme68x_set_regs sends the first register address, then data/address pairs.
+int8_t i2c_write(uint8_t reg_addr, const uint8_t *data, uint32_t len, void *) {
+    reg_write(reg_addr, data[0]);
+    for (uint32_t i = 1; i + 1 < len; i += 2) {
+        reg_write(data[i], data[i + 1]);
+    }
+    traffic.writes++;
+    traffic.bytes += len + 1;
+    return BME68X_OK;
+}
+
+int8_t spi_read(uint8_t reg_addr, uint8_t *data, uint32_t len, void *) {
+    uint8_t spi_addr = reg_addr & 0x7f;
+    for (uint32_t i = 0; i < len; i++) {
+        uint8_t a = (uint8_t)((spi_addr + i) & 0x7f);
+        data[i] = a == (BME68X_REG_MEM_PAGE & 0x7f) ? spi_status : regs[spi_to_i2c(a)];
+    }
+    traffic.reads++;
+    traffic.bytes += len + 1;
+    return BME68X_OK;
+}
+
+void spi_reg_write(uint8_t spi_addr, uint8_t value) {
+    if (spi_addr == (BME68X_REG_MEM_PAGE & 0x7f)) {
+        spi_status = value;
+        traffic.page_switches++;
+    } else {
+        reg_write(spi_to_i2c(spi_addr), value);
+    }
+}
+
+int8_t spi_write(uint8_t reg_addr, const uint8_t *data, uint32_t len, void *) {
+    spi_reg_write(reg_addr, data[0]);
+    for (uint32_t i = 1; i + 1 < len; i += 2) {
+        spi_reg_write(data[i], data[i + 1]);
+    }
+    traffic.writes++;
+    traffic.bytes += len + 1;
+    return BME68X_OK;
+}
+
+void sim_delay_us(uint32_t, void *) {
+}
+
+void reset_sim() {
+    for (int i = 0; i < 256; i++) {
+        regs[i] = (uint8_t)(i * 7 + 3);
+    }
+    regs[BME68X_REG_CHIP_ID] = BME68X_CHIP_ID;
+    regs[BME68X_REG_VARIANT_ID] = BME68X_VARIANT_GAS_HIGH;
+    regs[BME68X_REG_CTRL_MEAS] = 0;
+    regs[BME68X_REG_CTRL_GAS_1] = 0;
+    spi_status = 0;
+}
+
+void make_dev(struct bme68x_dev &dev, enum bme68x_intf intf) {
+    memset(&dev, 0, sizeof(dev));
+    dev.intf = intf;
+    dev.read = intf == BME68X_SPI_INTF ? spi_read : i2c_read;
+    dev.write = intf == BME68X_SPI_INTF ? spi_write : i2c_write;
+    dev.delay_us = sim_delay_us;
+    dev.amb_temp = 25;
+}
+
+// BME688PrecisionConf of bme688_lib.h, for the mode change.
+typedef BME688StaticConf<BME68X_OS_8X, BME68X_OS_16X, BME68X_OS_4X, BME68X_FILTER_SIZE_15> PrecisionConf;
+
+// Configuration steps of the BME688 constructor and set_mode().
+template <class Conf>
+bool configure(struct bme68x_dev &dev) {
+    struct bme68x_conf conf = Conf::conf();
+    struct bme68x_heatr_conf heatr = Conf::heatr_conf();
+    uint8_t ctrl_gas_1;
+    return bme68x_set_conf(&conf, &dev) == BME68X_OK &&
+           bme68x_set_heatr_conf(BME68X_FORCED_MODE, &heatr, &dev) == BME68X_OK &&
+           bme68x_get_regs(BME68X_REG_CTRL_GAS_1, &ctrl_gas_1, 1, &dev) == BME68X_OK;
+}
+
+struct Phase {
+    const char *name;
+    Traffic t[2];           // I2C, SPI
+    unsigned long runs;
+};
+
+enum { PHASE_COLD, PHASE_WARM, PHASE_MODE, PHASE_SAMPLE, PHASE_COUNT };
+
+Phase phases[PHASE_COUNT] = {
+    { "cold init", {}, 1 }, { "warm init", {}, 1 }, { "mode change", {}, 2 }, { "forced sample", {}, 0 },
+};
+
+Traffic take() {
+    Traffic t = traffic;
+    traffic = {};
+    return t;
+}
+
+// Runs every phase on one interface and returns the compensated samples' checksum.
+double run(enum bme68x_intf intf, long samples) {
+    int idx = intf == BME68X_SPI_INTF ? 1 : 0;
+    struct bme68x_dev dev;
+    reset_sim();
+    traffic = {};
+
+    make_dev(dev, intf);
+    uint8_t coeff[BME68X_LEN_COEFF_ALL];
+    bool ok = bme68x_init(&dev) == BME68X_OK && configure<BME688DefaultConf>(dev) &&
+              bme68x_set_op_mode(BME68X_SLEEP_MODE, &dev) == BME68X_OK;
+    phases[PHASE_COLD].t[idx] = take();
+    ok = ok && bme68x_get_calib_regs(coeff, &dev) == BME68X_OK;
+    take();
+
+    // Deep sleep keeps the sensor powered and its page register as it was.
+    make_dev(dev, intf);
+    ok = ok && bme68x_init_with_calib(coeff, BME68X_VARIANT_GAS_HIGH, &dev) == BME68X_OK &&
+         configure<BME688DefaultConf>(dev) && bme68x_set_op_mode(BME68X_SLEEP_MODE, &dev) == BME68X_OK;
+    phases[PHASE_WARM].t[idx] = take();
+
+    ok = ok && configure<PrecisionConf>(dev) && configure<BME688DefaultConf>(dev);
+    phases[PHASE_MODE].t[idx] = take();
+
+    double checksum = 0;
+    for (long i = 0; ok && i < samples; i++) {
+        struct bme68x_data data;
+        uint8_t n_fields = 0;
+        regs[BME68X_REG_FIELD0 + 2] = (uint8_t)(i * 13);
+        ok = bme688_trigger_forced(BME688DefaultConf::ctrl_meas_forced, &dev) == BME68X_OK &&
+             bme68x_get_data(BME68X_FORCED_MODE, &data, &n_fields, &dev) == BME68X_OK && n_fields == 1;
+        checksum += data.temperature + data.pressure + data.humidity + data.gas_resistance;
+    }
+    phases[PHASE_SAMPLE].t[idx] = take();
+    phases[PHASE_SAMPLE].runs = samples;
+    if (!ok) {
+        fprintf(stderr, "simulated %s sequence failed\n", idx ? "SPI" : "I2C");
+        exit(1);
+    }
+    return checksum;
+}
+
+double i2c_us(const Traffic &t, double clk_hz) {
+    unsigned long wire = t.bytes + t.writes + 2 * t.reads;
+    return (t.reads + t.writes) * TXN_OVERHEAD_I2C_US + wire * 9 * 1e6 / clk_hz;
+}
+
+double spi_us(const Traffic &t) {
+    return (t.reads + t.writes) * TXN_OVERHEAD_SPI_US + t.bytes * 8 * 1e6 / SPI_CLK_HZ;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    long samples = argc > 1 ? atol(argv[1]) : 1000;
+    if (samples <= 0) {
+        fprintf(stderr, "Usage: %s [samples]\n", argv[0]);
+        return 1;
+    }
+
+    double i2c_sum = run(BME68X_I2C_INTF, samples);
+    double spi_sum = run(BME68X_SPI_INTF, samples);
+
+    printf("per-transaction overhead: I2C %.0f us, SPI %.0f us; times in us per run\n", TXN_OVERHEAD_I2C_US,
+           TXN_OVERHEAD_SPI_US);
+    printf("phase          I2C txns  bytes  100 kHz  400 kHz | SPI txns  bytes  pages  10 MHz  uncached\n");
+    bool ok = true;
+    for (const Phase &p : phases) {
+        const Traffic &i2c = p.t[0];
+        const Traffic &spi = p.t[1];
+        double n = (double)p.runs;
+        // Without the page register cache every switch read it first.
+        Traffic uncached = spi;
+        uncached.reads += spi.page_switches;
+        uncached.bytes += 2 * spi.page_switches;
+        printf("%-13s  %8.1f  %5.1f  %7.0f  %7.0f | %8.1f  %5.1f  %5.1f  %6.0f  %8.0f\n", p.name,
+               (i2c.reads + i2c.writes) / n, (i2c.bytes + i2c.writes + 2 * i2c.reads) / n,
+               i2c_us(i2c, 100000) / n, i2c_us(i2c, 400000) / n, (spi.reads + spi.writes) / n, spi.bytes / n,
+               spi.page_switches / n, spi_us(spi) / n, spi_us(uncached) / n);
+        ok = ok && spi_us(spi) <= spi_us(uncached);
+    }
+
+    bool same = std::fabs(i2c_sum - spi_sum) <= 1e-6 * std::fabs(i2c_sum);
+    printf("\ncompensated samples over I2C and SPI %s\n", same ? "match" : "DIFFER");
+    return ok && same ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+// Host-side microbenchmark for bme688_static_conf.h.
+//
+// Runs the forced-mode read path against a simulated sensor register map:
+// the runtime path (bme68x_set_op_mode + bme68x_get_meas_dur) and the
+// compile-time path (BME688StaticConf::trigger_forced + forced_period_us),
+// each followed by the same bme68x_get_data burst. It reports CPU time per
+// read and the bus transactions and bytes each path issues. Before timing,
+// it checks that the compile-time constants match what the driver computes
+// at runtime for a few configurations.
+//
+// Build from this directory:
+//   cc -O2 -c ../components/bme68x/bme68x.c -I../components/bme68x -o bme68x.o
+//   c++ -std=c++17 -O2 -I../components/bme68x bme688_static_conf_bench.cpp bme68x.o -o bme688_static_conf_bench
+//
+// Usage: ./bme688_static_conf_bench [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "bme68x.h"
+#include "bme688_static_conf.h"
+
+namespace {
+
+uint8_t regs[256];
+uint8_t last_ctrl_meas;
+unsigned long transactions;
+unsigned long bytes;
+
+// Register address plus data bytes; the I2C device address is not counted.
+int8_t sim_read(uint8_t reg_addr, uint8_t *data, uint32_t len, void *) {
+    memcpy(data, &regs[reg_addr], len);
+    transactions++;
+    bytes += len + 1;
+    return BME68X_OK;
+}
+
+// bme68x_set_regs sends the first register address, then data/address pairs.
+int8_t sim_write(uint8_t reg_addr, const uint8_t *data, uint32_t len, void *) {
+    regs[reg_addr] = data[0];
+    for (uint32_t i = 1; i + 1 < len; i += 2) {
+        regs[data[i]] = data[i + 1];
+    }
+    transactions++;
+    bytes += len + 1;
+    if (reg_addr == BME68X_REG_CTRL_MEAS) {
+        // The simulated measurement finishes at once and the sensor goes back to sleep.
+        last_ctrl_meas = regs[BME68X_REG_CTRL_MEAS];
+        regs[BME68X_REG_CTRL_MEAS] &= (uint8_t)~BME68X_MODE_MSK;
+    }
+    return BME68X_OK;
+}
+
+void sim_delay_us(uint32_t, void *) {
+}
+
+bool init_sim(struct bme68x_dev &dev) {
+    for (int i = 0; i < 256; i++) {
+        regs[i] = (uint8_t)(i * 7 + 3);
+    }
+    regs[BME68X_REG_CHIP_ID] = BME68X_CHIP_ID;
+    regs[BME68X_REG_VARIANT_ID] = BME68X_VARIANT_GAS_HIGH;
+    regs[BME68X_REG_CTRL_MEAS] = 0;
+    // One finished field with new data, valid gas and a stable heater.
+    regs[BME68X_REG_FIELD0] = BME68X_NEW_DATA_MSK;
+    regs[BME68X_REG_FIELD0 + 14] = BME68X_GASM_VALID_MSK | BME68X_HEAT_STAB_MSK;
+
+    memset(&dev, 0, sizeof(dev));
+    dev.intf = BME68X_I2C_INTF;
+    dev.read = sim_read;
+    dev.write = sim_write;
+    dev.delay_us = sim_delay_us;
+    dev.amb_temp = 25;
+    return bme68x_init(&dev) == BME68X_OK;
+}
+
+template <class Conf>
+bool check_conf(const char *name) {
+    struct bme68x_dev dev;
+    if (!init_sim(dev)) {
+        printf("%s: bme68x_init failed\n", name);
+        return false;
+    }
+    struct bme68x_conf conf = Conf::conf();
+    struct bme68x_heatr_conf heatr = Conf::heatr_conf();
+    bool ok = bme68x_set_conf(&conf, &dev) == BME68X_OK &&
+              bme68x_set_heatr_conf(BME68X_FORCED_MODE, &heatr, &dev) == BME68X_OK &&
+              bme68x_set_op_mode(BME68X_FORCED_MODE, &dev) == BME68X_OK;
+
+    const uint8_t modes[] = { BME68X_FORCED_MODE, BME68X_PARALLEL_MODE, BME68X_SEQUENTIAL_MODE };
+    for (uint8_t mode : modes) {
+        ok = ok && Conf::meas_dur_us(mode) == bme68x_get_meas_dur(mode, &conf, &dev);
+    }
+    ok = ok && Conf::gas_wait_0 == regs[BME68X_REG_GAS_WAIT0];
+    ok = ok && Conf::ctrl_meas_forced == last_ctrl_meas;
+    printf("%-40s meas %6u us  gas_wait 0x%02x  ctrl_meas 0x%02x  %s\n", name, (unsigned)Conf::forced_meas_dur_us,
+           Conf::gas_wait_0, Conf::ctrl_meas_forced, ok ? "matches driver" : "MISMATCH");
+    return ok;
+}
+
+struct PathStats {
+    double ns_per_read;
+    double transactions_per_read;
+    double bytes_per_read;
+};
+
+volatile uint32_t sink;
+
+template <class Read>
+PathStats run_path(long iterations, Read read) {
+    transactions = 0;
+    bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) {
+        sink = read();
+    }
+    auto end = std::chrono::steady_clock::now();
+    PathStats stats;
+    stats.ns_per_read = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    stats.transactions_per_read = (double)transactions / iterations;
+    stats.bytes_per_read = (double)bytes / iterations;
+    return stats;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    long iterations = argc > 1 ? atol(argv[1]) : 1000000;
+    if (iterations <= 0) {
+        fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    bool ok = true;
+    ok &= check_conf<BME688DefaultConf>("T8x P4x H2x, 300 C / 100 ms");
+    ok &= check_conf<BME688StaticConf<BME68X_OS_16X, BME68X_OS_16X, BME68X_OS_16X, BME68X_FILTER_SIZE_127,
+                                      BME68X_ODR_1000_MS, 400, 4031>>("T16x P16x H16x, 400 C / 4031 ms");
+    ok &= check_conf<BME688StaticConf<BME68X_OS_1X, BME68X_OS_NONE, BME68X_OS_NONE, BME68X_FILTER_OFF,
+                                      BME68X_ODR_NONE, 200, 1>>("T1x, 200 C / 1 ms");
+    ok &= check_conf<BME688StaticConf<BME68X_OS_2X, BME68X_OS_1X, BME68X_OS_16X, BME68X_FILTER_SIZE_3,
+                                      BME68X_ODR_NONE, 320, 150>>("T2x P1x H16x, 320 C / 150 ms");
+    if (!ok) return 1;
+
+    typedef BME688DefaultConf Conf;
+    struct bme68x_dev dev;
+    init_sim(dev);
+    struct bme68x_conf conf = Conf::conf();
+    struct bme68x_heatr_conf heatr = Conf::heatr_conf();
+    bme68x_set_conf(&conf, &dev);
+    bme68x_set_heatr_conf(BME68X_FORCED_MODE, &heatr, &dev);
+
+    PathStats runtime = run_path(iterations, [&]() {
+        bme68x_set_op_mode(BME68X_FORCED_MODE, &dev);
+        uint32_t period = bme68x_get_meas_dur(BME68X_FORCED_MODE, &conf, &dev) + heatr.heatr_dur * 1000;
+        struct bme68x_data data;
+        uint8_t n_fields;
+        bme68x_get_data(BME68X_FORCED_MODE, &data, &n_fields, &dev);
+        return period + n_fields;
+    });
+    PathStats compile_time = run_path(iterations, [&]() {
+        Conf::trigger_forced(&dev);
+        uint32_t period = Conf::forced_period_us;
+        struct bme68x_data data;
+        uint8_t n_fields;
+        bme68x_get_data(BME68X_FORCED_MODE, &data, &n_fields, &dev);
+        return period + n_fields;
+    });
+
+    // 9 clocks per byte at 100 kHz, plus the device address byte of every transaction.
+    auto bus_us = [](const PathStats &s) { return (s.bytes_per_read + s.transactions_per_read) * 90.0; };
+    printf("\n%ld reads per path\n", iterations);
+    printf("path           ns/read  transactions  bytes  bus time @100 kHz\n");
+    printf("runtime       %8.1f  %12.1f  %5.1f  %8.0f us\n", runtime.ns_per_read, runtime.transactions_per_read,
+           runtime.bytes_per_read, bus_us(runtime));
+    printf("compile-time  %8.1f  %12.1f  %5.1f  %8.0f us\n", compile_time.ns_per_read,
+           compile_time.transactions_per_read, compile_time.bytes_per_read, bus_us(compile_time));
+    return 0;
+}
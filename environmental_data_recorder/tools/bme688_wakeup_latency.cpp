@@ -0,0 +1,230 @@
+// Host-side latency benchmark for waking up to a finished BME688 forced read.
+//
+// Runs forced reads through the Bosch driver against a simulated sensor with
+// a clock. The sensor's real measurement window is the computed one
+// (forced_period_us) scaled by a random factor within +-TIMING_TOL, so some
+// reads finish after the computed completion time and some before. Every
+// transaction costs its I2C time at 400 kHz plus TXN_OVERHEAD_US, and the
+// driver's delay_us() advances the clock. Three ways of waiting are compared:
+//  - tick, 10 ms polls: vTaskDelay(del_ms / portTICK_PERIOD_MS + 1) on a
+//    10 ms tick, whose phase against the trigger is random, then the driver's
+//    default polling (5 tries, BME68X_PERIOD_POLL = 10 ms apart); this is
+//    what bme688_lib and the examples did before;
+//  - tick, 1 ms polls: the same wait with 50 polls 1 ms apart, as the
+//    read_BME688 and RTOS examples now do;
+//  - esp_timer: a one-shot timer at the computed completion time, woken
+//    WAKE_JITTER_US late, then dev.poll_period_us polls, as bme688_lib does.
+// For each it prints the distribution of the completion latency (from the
+// moment the sensor had the data to the moment the field was read), the
+// time from trigger to data, new-data polls per read and lost reads.
+// With esp_timer most of the remaining latency is from reads the sensor
+// finished early, which still wait for the computed completion time.
+//
+// Build from this directory:
+//   cc -O2 -c ../components/bme68x/bme68x.c -I../components/bme68x -o bme68x.o
+//   c++ -std=c++17 -O2 -I../components/bme68x bme688_wakeup_latency.cpp bme68x.o -o bme688_wakeup_latency
+//
+// Usage: ./bme688_wakeup_latency [reads] [poll_step_us]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "bme68x.h"
+#include "bme688_static_conf.h"
+
+// bme688_lib.h's default and low latency (T/P/H only) modes.
+typedef BME688DefaultConf GasConf;
+typedef BME688StaticConf<BME68X_OS_1X, BME68X_OS_1X, BME68X_OS_1X, BME68X_FILTER_OFF, BME68X_ODR_NONE, 300, 100,
+                         BME68X_DISABLE> TphConf;
+
+namespace {
+
+const double TXN_OVERHEAD_US = 60;
+const double I2C_CLK_HZ = 400000;
+const double TICK_US = 10000;           // CONFIG_FREERTOS_HZ=100
+const double TIMING_TOL = 0.03;         // spread of the sensor's own timing
+const double WAKE_JITTER_US = 30;       // esp_timer callback to task wake-up
+const uint32_t POLL_BUDGET_US = 50000;  // BME688_POLL_BUDGET_US
+
+uint8_t regs[256];
+double now_us;
+double ready_us;        // when the measurement in flight really finishes
+
+void bus(uint32_t wire_bytes) {
+    now_us += TXN_OVERHEAD_US + wire_bytes * 9 * 1e6 / I2C_CLK_HZ;
+}
+
+void advance_sensor() {
+    if ((regs[BME68X_REG_CTRL_MEAS] & BME68X_MODE_MSK) == BME68X_FORCED_MODE && now_us >= ready_us) {
+        regs[BME68X_REG_CTRL_MEAS] &= (uint8_t)~BME68X_MODE_MSK;
+        regs[BME68X_REG_FIELD0] = BME68X_NEW_DATA_MSK;
+        regs[BME68X_REG_FIELD0 + 14] = BME68X_GASM_VALID_MSK | BME68X_HEAT_STAB_MSK;
+    }
+}
+
+int8_t sim_read(uint8_t reg_addr, uint8_t *data, uint32_t len, void *) {
+    bus(len + 3);
+    advance_sensor();
+    memcpy(data, &regs[reg_addr], len);
+    return BME68X_OK;
+}
+
+// A ctrl_meas write with the forced bit starts a measurement; ready_us is set by the caller.
+int8_t sim_write(uint8_t reg_addr, const uint8_t *data, uint32_t len, void *) {
+    bus(len + 2);
+    advance_sensor();
+    regs[reg_addr] = data[0];
+    for (uint32_t i = 1; i + 1 < len; i += 2) {
+        regs[data[i]] = data[i + 1];
+    }
+    if ((regs[BME68X_REG_CTRL_MEAS] & BME68X_MODE_MSK) == BME68X_FORCED_MODE) {
+        regs[BME68X_REG_FIELD0] = 0;
+    }
+    return BME68X_OK;
+}
+
+void sim_delay_us(uint32_t period, void *) {
+    now_us += period;
+    advance_sensor();
+}
+
+enum Wait { TICK_COARSE, TICK_FINE, ESP_TIMER, WAIT_COUNT };
+
+const char *wait_names[WAIT_COUNT] = { "tick, 10 ms polls", "tick, 1 ms polls", "esp_timer" };
+
+// Time at which vTaskDelay(ticks), called at t, returns: on the ticks-th tick interrupt.
+double tick_wake(double t, double tick_phase, long ticks) {
+    double next_tick = tick_phase + std::ceil((t - tick_phase) / TICK_US) * TICK_US;
+    if (next_tick <= t) next_tick += TICK_US;
+    return next_tick + (ticks - 1) * TICK_US;
+}
+
+struct Stats {
+    std::vector<double> late_us;    // data ready to field read
+    std::vector<double> total_us;   // trigger to field read
+    unsigned long polls;
+    unsigned long lost;
+};
+
+double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    size_t i = (size_t)(p * (v.size() - 1) + 0.5);
+    return v[i];
+}
+
+template <class Conf>
+Stats run(Wait wait, long reads, uint32_t poll_step_us) {
+    for (int i = 0; i < 256; i++) {
+        regs[i] = (uint8_t)(i * 7 + 3);
+    }
+    regs[BME68X_REG_CHIP_ID] = BME68X_CHIP_ID;
+    regs[BME68X_REG_VARIANT_ID] = BME68X_VARIANT_GAS_HIGH;
+    regs[BME68X_REG_CTRL_MEAS] = 0;
+    now_us = 0;
+
+    struct bme68x_dev dev;
+    memset(&dev, 0, sizeof(dev));
+    dev.intf = BME68X_I2C_INTF;
+    dev.read = sim_read;
+    dev.write = sim_write;
+    dev.delay_us = sim_delay_us;
+    dev.amb_temp = 25;
+    if (wait == TICK_FINE) {
+        dev.poll_period_us = 1000;
+        dev.poll_tries = 50;
+    } else if (wait == ESP_TIMER) {
+        dev.poll_period_us = poll_step_us;
+        dev.poll_tries = (uint8_t)std::min<uint32_t>(POLL_BUDGET_US / poll_step_us, 255);
+    }
+    struct bme68x_conf conf = Conf::conf();
+    struct bme68x_heatr_conf heatr = Conf::heatr_conf();
+    if (bme68x_init(&dev) != BME68X_OK || bme68x_set_conf(&conf, &dev) != BME68X_OK ||
+        bme68x_set_heatr_conf(BME68X_FORCED_MODE, &heatr, &dev) != BME68X_OK) {
+        fprintf(stderr, "simulated sensor setup failed\n");
+        exit(1);
+    }
+
+    // Same seed for every variant, so they see the same sensor timing and tick phases.
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> spread(1 - TIMING_TOL, 1 + TIMING_TOL);
+    std::uniform_real_distribution<double> phase(0, TICK_US);
+    Stats st = {};
+    for (long i = 0; i < reads; i++) {
+        // Start the next read at a random point of the tick.
+        now_us += phase(rng);
+        double tick_phase = phase(rng);
+        double factor = spread(rng);
+        if (Conf::trigger_forced(&dev) != BME68X_OK) {
+            fprintf(stderr, "trigger failed\n");
+            exit(1);
+        }
+        double trigger_us = now_us;
+        ready_us = trigger_us + Conf::forced_period_us * factor;
+
+        if (wait == ESP_TIMER) {
+            now_us = trigger_us + Conf::forced_period_us + WAKE_JITTER_US;
+        } else {
+            uint32_t del_period = Conf::forced_period_us / 1000;
+            now_us = tick_wake(now_us, tick_phase, (long)(del_period / (TICK_US / 1000)) + 1);
+        }
+        advance_sensor();
+
+        uint32_t polls = dev.intf_stats.data_polls;
+        struct bme68x_data data;
+        uint8_t n_fields = 0;
+        if (bme68x_get_data(BME68X_FORCED_MODE, &data, &n_fields, &dev) != BME68X_OK || n_fields == 0) {
+            st.lost++;
+            // Let the measurement finish before the next trigger.
+            if (now_us < ready_us) now_us = ready_us;
+            advance_sensor();
+        } else {
+            st.late_us.push_back(now_us - ready_us);
+            st.total_us.push_back(now_us - trigger_us);
+        }
+        st.polls += dev.intf_stats.data_polls - polls;
+    }
+    return st;
+}
+
+template <class Conf>
+bool report(const char *name, long reads, uint32_t poll_step_us) {
+    printf("%s: computed window %.1f ms, sensor within +-%.0f %%\n", name, Conf::forced_period_us / 1000.0,
+           TIMING_TOL * 100);
+    printf("  wait             latency us: p50     p90     p99     max | trigger-to-data ms: p50    p99 | "
+           "polls/read  lost\n");
+    double p99[WAIT_COUNT];
+    for (int w = 0; w < WAIT_COUNT; w++) {
+        Stats st = run<Conf>((Wait)w, reads, poll_step_us);
+        p99[w] = percentile(st.late_us, 0.99);
+        printf("  %-18s %16.0f %7.0f %7.0f %7.0f | %22.2f %6.2f | %10.2f  %4lu\n", wait_names[w],
+               percentile(st.late_us, 0.5), percentile(st.late_us, 0.9), p99[w],
+               percentile(st.late_us, 1.0), percentile(st.total_us, 0.5) / 1000,
+               percentile(st.total_us, 0.99) / 1000, (double)st.polls / reads, st.lost);
+        if (st.lost) return false;
+    }
+    return p99[ESP_TIMER] <= p99[TICK_FINE] && p99[TICK_FINE] <= p99[TICK_COARSE];
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    long reads = argc > 1 ? atol(argv[1]) : 10000;
+    long poll_step_us = argc > 2 ? atol(argv[2]) : 500;
+    if (reads <= 0 || poll_step_us <= 0) {
+        fprintf(stderr, "Usage: %s [reads] [poll_step_us]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%ld reads, %.0f ms tick, esp_timer wake-up %.0f us late, %ld us poll step\n\n", reads,
+           TICK_US / 1000, WAKE_JITTER_US, poll_step_us);
+    bool ok = report<GasConf>("T/P/H + gas (default mode)", reads, (uint32_t)poll_step_us);
+    printf("\n");
+    ok = report<TphConf>("T/P/H only (low latency mode)", reads, (uint32_t)poll_step_us) && ok;
+    printf("\nno lost reads and p99 latency drops with each step: %s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
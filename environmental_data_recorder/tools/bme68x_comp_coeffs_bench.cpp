@@ -0,0 +1,226 @@
+// Host-side check and benchmark of the precomputed compensation coefficients
+// (bme68x_precompute_calib) against the driver's previous formulas, kept in
+// bme68x_reference_comp.h.
+//
+// Draws CALIB_SETS calibration sets around the values of production BME688s
+// and, for each, raw samples whose reference results lie in the operating
+// range (-40..85 degC, 300..1100 hPa). It checks that the integer build gives
+// the same results bit for bit and that the floating point build stays within
+// the tolerance documented in bme68x.h, then times bme68x_compensate_batch
+// on T/P/H (no gas) against the same loop on the reference formulas. Times
+// are the best of ROUNDS alternating passes, in ns and, on x86, in TSC cycles per sample.
+//
+// Build from this directory (add -DBME68X_DO_NOT_USE_FPU to both lines for
+// the integer build):
+//   cc -O2 -c ../components/bme68x/bme68x.c -I../components/bme68x -o bme68x.o
+//   c++ -std=c++11 -O2 -I../components/bme68x bme68x_comp_coeffs_bench.cpp bme68x.o -o bme68x_comp_coeffs_bench
+//
+// Usage: ./bme68x_comp_coeffs_bench [samples]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "bme68x.h"
+#include "bme68x_reference_comp.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#ifdef BME68X_USE_FPU
+typedef float temp_t;
+typedef float comp_t;
+const char *BUILD = "floating point";
+// The tolerance documented for bme68x_precompute_calib.
+const double TOL_T = 1e-5;
+const double TOL_P = 0.05;
+const double TOL_H = 5e-5;
+#else
+typedef int16_t temp_t;
+typedef uint32_t comp_t;
+const char *BUILD = "integer";
+const double TOL_T = 0;
+const double TOL_P = 0;
+const double TOL_H = 0;
+#endif
+
+namespace {
+
+const int CALIB_SETS = 64;
+const int ROUNDS = 200;
+
+std::mt19937 rng(688);
+
+int draw(int lo, int hi) {
+    return std::uniform_int_distribution<int>(lo, hi)(rng);
+}
+
+void random_calibration(bme68x_calib_data &calib) {
+    memset(&calib, 0, sizeof(calib));
+    calib.par_t1 = (uint16_t)draw(25500, 26800);
+    calib.par_t2 = (int16_t)draw(25800, 26800);
+    calib.par_t3 = (int8_t)draw(2, 4);
+    calib.par_p1 = (uint16_t)draw(35500, 38500);
+    calib.par_p2 = (int16_t)draw(-10700, -10100);
+    calib.par_p3 = (int8_t)draw(80, 95);
+    calib.par_p4 = (int16_t)draw(5000, 8000);
+    calib.par_p5 = (int16_t)draw(-300, -50);
+    calib.par_p6 = (int8_t)draw(25, 35);
+    calib.par_p7 = (int8_t)draw(20, 60);
+    calib.par_p8 = (int16_t)draw(-450, -250);
+    calib.par_p9 = (int16_t)draw(-3200, -2400);
+    calib.par_p10 = (uint8_t)draw(25, 35);
+    calib.par_h1 = (uint16_t)draw(600, 950);
+    calib.par_h2 = (uint16_t)draw(900, 1150);
+    calib.par_h3 = (int8_t)draw(-2, 2);
+    calib.par_h4 = (int8_t)draw(40, 50);
+    calib.par_h5 = (int8_t)draw(15, 25);
+    calib.par_h6 = (uint8_t)draw(110, 130);
+    calib.par_h7 = (int8_t)draw(-110, -90);
+    bme68x_precompute_calib(&calib);
+}
+
+double as_degc(temp_t t) {
+#ifdef BME68X_USE_FPU
+    return t;
+#else
+    return t / 100.0;
+#endif
+}
+
+double as_pa(comp_t p) {
+    return p;
+}
+
+double as_rh(comp_t h) {
+#ifdef BME68X_USE_FPU
+    return h;
+#else
+    return h / 1000.0;
+#endif
+}
+
+struct Set {
+    bme68x_calib_data calib;
+    std::vector<uint32_t> temp_adc;
+    std::vector<uint32_t> pres_adc;
+    std::vector<uint16_t> hum_adc;
+};
+
+// Samples whose reference results are in the operating range.
+void fill_samples(Set &set, size_t n) {
+    while (set.temp_adc.size() < n) {
+        uint32_t t = (uint32_t)draw(250000, 750000);
+        uint32_t p = (uint32_t)draw(150000, 700000);
+        uint16_t h = (uint16_t)draw(10000, 60000);
+        auto t_fine = ref_calc_t_fine(t, &set.calib);
+        double degc = as_degc(ref_calc_temperature(t_fine));
+        double pa = as_pa(ref_calc_pressure(p, t_fine, &set.calib));
+        if (degc < -40 || degc > 85 || pa < 30000 || pa > 110000) continue;
+        set.temp_adc.push_back(t);
+        set.pres_adc.push_back(p);
+        set.hum_adc.push_back(h);
+    }
+}
+
+typedef void (*batch_fn)(const bme68x_raw_batch *, bme68x_comp_batch *, const bme68x_calib_data *);
+
+void driver_batch(const bme68x_raw_batch *raw, bme68x_comp_batch *comp, const bme68x_calib_data *calib) {
+    bme68x_compensate_batch(raw, comp, calib, BME68X_VARIANT_GAS_HIGH);
+}
+
+struct Timing {
+    double ns;
+    double cycles;
+};
+
+// One pass over all sets, per sample.
+Timing time_batch(batch_fn fn, std::vector<Set> &sets, std::vector<temp_t> &t, std::vector<comp_t> &p,
+                  std::vector<comp_t> &h) {
+    size_t n = sets[0].temp_adc.size();
+    auto start = std::chrono::steady_clock::now();
+#ifdef HAVE_TSC
+    unsigned long long c0 = __rdtsc();
+#endif
+    for (Set &s : sets) {
+        bme68x_raw_batch raw = { (uint32_t)n, s.temp_adc.data(), s.pres_adc.data(), s.hum_adc.data(), NULL, NULL };
+        bme68x_comp_batch comp = { t.data(), p.data(), h.data(), NULL };
+        fn(&raw, &comp, &s.calib);
+    }
+#ifdef HAVE_TSC
+    double cycles = (double)(__rdtsc() - c0);
+#else
+    double cycles = 0;
+#endif
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    double samples = (double)n * sets.size();
+    Timing r = { ns / samples, cycles / samples };
+    return r;
+}
+
+void keep_best(Timing &best, const Timing &t) {
+    if (t.ns < best.ns) best.ns = t.ns;
+    if (t.cycles < best.cycles) best.cycles = t.cycles;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    long samples = argc > 1 ? atol(argv[1]) : 1024;
+    if (samples <= 0) {
+        fprintf(stderr, "Usage: %s [samples]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Set> sets(CALIB_SETS);
+    for (Set &s : sets) {
+        random_calibration(s.calib);
+        fill_samples(s, (size_t)samples);
+    }
+
+    // Equivalence, sample by sample through the driver's batch entry point.
+    std::vector<temp_t> t_ref(samples), t_new(samples);
+    std::vector<comp_t> p_ref(samples), p_new(samples), h_ref(samples), h_new(samples);
+    double max_t = 0;
+    double max_p = 0;
+    double max_h = 0;
+    for (Set &s : sets) {
+        bme68x_raw_batch raw = { (uint32_t)samples, s.temp_adc.data(), s.pres_adc.data(), s.hum_adc.data(), NULL,
+                                 NULL };
+        bme68x_comp_batch ref = { t_ref.data(), p_ref.data(), h_ref.data(), NULL };
+        bme68x_comp_batch out = { t_new.data(), p_new.data(), h_new.data(), NULL };
+        ref_compensate_batch(&raw, &ref, &s.calib);
+        bme68x_compensate_batch(&raw, &out, &s.calib, BME68X_VARIANT_GAS_HIGH);
+        for (long i = 0; i < samples; i++) {
+            max_t = std::fmax(max_t, std::fabs(as_degc(t_new[i]) - as_degc(t_ref[i])));
+            max_p = std::fmax(max_p, std::fabs(as_pa(p_new[i]) - as_pa(p_ref[i])));
+            max_h = std::fmax(max_h, std::fabs(as_rh(h_new[i]) - as_rh(h_ref[i])));
+        }
+    }
+
+    // Alternate the two, so that both see the same machine load.
+    Timing ref = { 1e30, 1e30 };
+    Timing now = { 1e30, 1e30 };
+    for (int r = 0; r < ROUNDS; r++) {
+        keep_best(ref, time_batch(ref_compensate_batch, sets, t_ref, p_ref, h_ref));
+        keep_best(now, time_batch(driver_batch, sets, t_new, p_new, h_new));
+    }
+
+    printf("%s build, %d calibration sets x %ld samples, T/P/H only\n", BUILD, CALIB_SETS, samples);
+    printf("max difference: %.3g degC, %.3g Pa, %.3g %%rH (tolerance %.3g, %.3g, %.3g)\n", max_t, max_p, max_h,
+           TOL_T, TOL_P, TOL_H);
+#ifdef HAVE_TSC
+    printf("reference formulas:      %6.1f ns  %6.1f TSC cycles per sample\n", ref.ns, ref.cycles);
+    printf("precomputed coefficients: %5.1f ns  %6.1f TSC cycles per sample\n", now.ns, now.cycles);
+#else
+    printf("reference formulas:      %6.1f ns per sample\n", ref.ns);
+    printf("precomputed coefficients: %5.1f ns per sample\n", now.ns);
+#endif
+    bool ok = max_t <= TOL_T && max_p <= TOL_P && max_h <= TOL_H;
+    printf("\nresults within the documented tolerance: %s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+// The temperature, pressure and humidity compensation of the Bosch BME68x
+// driver as it was before bme68x_precompute_calib, for the benchmarks that
+// compare the precomputed coefficients against it. Integer or floating point
+// like the driver, following BME68X_USE_FPU.
+
+#pragma once
+
+#include "bme68x_defs.h"
+
+#ifndef BME68X_USE_FPU
+
+static inline int32_t ref_calc_t_fine(uint32_t temp_adc, const struct bme68x_calib_data *calib) {
+    int64_t var1;
+    int64_t var2;
+    int64_t var3;
+
+    var1 = ((int32_t)temp_adc >> 3) - ((int32_t)calib->par_t1 << 1);
+    var2 = (var1 * (int32_t)calib->par_t2) >> 11;
+    var3 = ((var1 >> 1) * (var1 >> 1)) >> 12;
+    var3 = ((var3) * ((int32_t)calib->par_t3 << 4)) >> 14;
+    return (int32_t)(var2 + var3);
+}
+
+static inline int16_t ref_calc_temperature(int32_t t_fine) {
+    return (int16_t)(((t_fine * 5) + 128) >> 8);
+}
+
+static inline uint32_t ref_calc_pressure(uint32_t pres_adc, int32_t t_fine, const struct bme68x_calib_data *calib) {
+    int32_t var1;
+    int32_t var2;
+    int32_t var3;
+    int32_t pressure_comp;
+    const int32_t pres_ovf_check = INT32_C(0x40000000);
+
+    var1 = ((t_fine) >> 1) - 64000;
+    var2 = ((((var1 >> 2) * (var1 >> 2)) >> 11) * (int32_t)calib->par_p6) >> 2;
+    var2 = var2 + ((var1 * (int32_t)calib->par_p5) << 1);
+    var2 = (var2 >> 2) + ((int32_t)calib->par_p4 << 16);
+    var1 = (((((var1 >> 2) * (var1 >> 2)) >> 13) * ((int32_t)calib->par_p3 << 5)) >> 3) +
+           (((int32_t)calib->par_p2 * var1) >> 1);
+    var1 = var1 >> 18;
+    var1 = ((32768 + var1) * (int32_t)calib->par_p1) >> 15;
+    pressure_comp = 1048576 - pres_adc;
+    pressure_comp = (int32_t)((pressure_comp - (var2 >> 12)) * ((uint32_t)3125));
+    if (pressure_comp >= pres_ovf_check) {
+        pressure_comp = ((pressure_comp / var1) << 1);
+    } else {
+        pressure_comp = ((pressure_comp << 1) / var1);
+    }
+
+    var1 = ((int32_t)calib->par_p9 * (int32_t)(((pressure_comp >> 3) * (pressure_comp >> 3)) >> 13)) >> 12;
+    var2 = ((int32_t)(pressure_comp >> 2) * (int32_t)calib->par_p8) >> 13;
+    var3 = ((int32_t)(pressure_comp >> 8) * (int32_t)(pressure_comp >> 8) * (int32_t)(pressure_comp >> 8) *
+            (int32_t)calib->par_p10) >> 17;
+    pressure_comp = (int32_t)(pressure_comp) + ((var1 + var2 + var3 + ((int32_t)calib->par_p7 << 7)) >> 4);
+    return (uint32_t)pressure_comp;
+}
+
+static inline uint32_t ref_calc_humidity(uint16_t hum_adc, int32_t t_fine, const struct bme68x_calib_data *calib) {
+    int32_t var1;
+    int32_t var2;
+    int32_t var3;
+    int32_t var4;
+    int32_t var5;
+    int32_t var6;
+    int32_t temp_scaled;
+    int32_t calc_hum;
+
+    temp_scaled = ((t_fine * 5) + 128) >> 8;
+    var1 = (int32_t)(hum_adc - ((int32_t)((int32_t)calib->par_h1 * 16))) -
+           (((temp_scaled * (int32_t)calib->par_h3) / ((int32_t)100)) >> 1);
+    var2 = ((int32_t)calib->par_h2 *
+            (((temp_scaled * (int32_t)calib->par_h4) / ((int32_t)100)) +
+             (((temp_scaled * ((temp_scaled * (int32_t)calib->par_h5) / ((int32_t)100))) >> 6) / ((int32_t)100)) +
+             (int32_t)(1 << 14))) >> 10;
+    var3 = var1 * var2;
+    var4 = (int32_t)calib->par_h6 << 7;
+    var4 = ((var4) + ((temp_scaled * (int32_t)calib->par_h7) / ((int32_t)100))) >> 4;
+    var5 = ((var3 >> 14) * (var3 >> 14)) >> 10;
+    var6 = (var4 * var5) >> 1;
+    calc_hum = (((var3 + var6) >> 10) * ((int32_t)1000)) >> 12;
+    if (calc_hum > 100000) {
+        calc_hum = 100000;
+    } else if (calc_hum < 0) {
+        calc_hum = 0;
+    }
+    return (uint32_t)calc_hum;
+}
+
+#else
+
+static inline float ref_calc_t_fine(uint32_t temp_adc, const struct bme68x_calib_data *calib) {
+    float var1;
+    float var2;
+
+    var1 = ((((float)temp_adc / 16384.0f) - ((float)calib->par_t1 / 1024.0f)) * ((float)calib->par_t2));
+    var2 = (((((float)temp_adc / 131072.0f) - ((float)calib->par_t1 / 8192.0f)) *
+             (((float)temp_adc / 131072.0f) - ((float)calib->par_t1 / 8192.0f))) *
+            ((float)calib->par_t3 * 16.0f));
+    return var1 + var2;
+}
+
+static inline float ref_calc_temperature(float t_fine) {
+    return ((t_fine) / 5120.0f);
+}
+
+static inline float ref_calc_pressure(uint32_t pres_adc, float t_fine, const struct bme68x_calib_data *calib) {
+    float var1;
+    float var2;
+    float var3;
+    float calc_pres;
+
+    var1 = (((float)t_fine / 2.0f) - 64000.0f);
+    var2 = var1 * var1 * (((float)calib->par_p6) / (131072.0f));
+    var2 = var2 + (var1 * ((float)calib->par_p5) * 2.0f);
+    var2 = (var2 / 4.0f) + (((float)calib->par_p4) * 65536.0f);
+    var1 = (((((float)calib->par_p3 * var1 * var1) / 16384.0f) + ((float)calib->par_p2 * var1)) / 524288.0f);
+    var1 = ((1.0f + (var1 / 32768.0f)) * ((float)calib->par_p1));
+    calc_pres = (1048576.0f - ((float)pres_adc));
+    if ((int)var1 != 0) {
+        calc_pres = (((calc_pres - (var2 / 4096.0f)) * 6250.0f) / var1);
+        var1 = (((float)calib->par_p9) * calc_pres * calc_pres) / 2147483648.0f;
+        var2 = calc_pres * (((float)calib->par_p8) / 32768.0f);
+        var3 = ((calc_pres / 256.0f) * (calc_pres / 256.0f) * (calc_pres / 256.0f) * (calib->par_p10 / 131072.0f));
+        calc_pres = (calc_pres + (var1 + var2 + var3 + ((float)calib->par_p7 * 128.0f)) / 16.0f);
+    } else {
+        calc_pres = 0;
+    }
+    return calc_pres;
+}
+
+static inline float ref_calc_humidity(uint16_t hum_adc, float t_fine, const struct bme68x_calib_data *calib) {
+    float calc_hum;
+    float var1;
+    float var2;
+    float var3;
+    float var4;
+    float temp_comp;
+
+    temp_comp = ((t_fine) / 5120.0f);
+    var1 = (float)((float)hum_adc) - (((float)calib->par_h1 * 16.0f) + (((float)calib->par_h3 / 2.0f) * temp_comp));
+    var2 = var1 * ((float)(((float)calib->par_h2 / 262144.0f) *
+                           (1.0f + (((float)calib->par_h4 / 16384.0f) * temp_comp) +
+                            (((float)calib->par_h5 / 1048576.0f) * temp_comp * temp_comp))));
+    var3 = (float)calib->par_h6 / 16384.0f;
+    var4 = (float)calib->par_h7 / 2097152.0f;
+    calc_hum = var2 + ((var3 + (var4 * temp_comp)) * var2 * var2);
+    if (calc_hum > 100.0f) {
+        calc_hum = 100.0f;
+    } else if (calc_hum < 0.0f) {
+        calc_hum = 0.0f;
+    }
+    return calc_hum;
+}
+
+#endif
+
+// Same shape as bme68x_compensate_batch without gas: one quantity at a time
+// over chunks of BME68X_BATCH_CHUNK samples.
+__attribute__((noinline)) static void ref_compensate_batch(const struct bme68x_raw_batch *raw, struct bme68x_comp_batch *comp,
+                                 const struct bme68x_calib_data *calib) {
+#ifndef BME68X_USE_FPU
+    int32_t t_fine[BME68X_BATCH_CHUNK];
+#else
+    float t_fine[BME68X_BATCH_CHUNK];
+#endif
+    uint32_t n;
+    for (uint32_t base = 0; base < raw->len; base += n) {
+        n = raw->len - base;
+        if (n > BME68X_BATCH_CHUNK) n = BME68X_BATCH_CHUNK;
+        for (uint32_t i = 0; i < n; i++) t_fine[i] = ref_calc_t_fine(raw->temp_adc[base + i], calib);
+        for (uint32_t i = 0; i < n; i++) comp->temperature[base + i] = ref_calc_temperature(t_fine[i]);
+        for (uint32_t i = 0; i < n; i++) {
+            comp->pressure[base + i] = ref_calc_pressure(raw->pres_adc[base + i], t_fine[i], calib);
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            comp->humidity[base + i] = ref_calc_humidity(raw->hum_adc[base + i], t_fine[i], calib);
+        }
+    }
+}
@@ -0,0 +1,193 @@
+// Host-side test of the i2c_bus_lib arbiter policy with fake devices.
+// The transaction order comes from I2CArbiterQueue (i2c_bus_policy.h), the
+// queue the arbiter task runs; the bus timing around it is modelled.
+//
+// Three simulated devices share one I2C bus, each driven by its own task
+// that issues one synchronous transaction at a time, as the firmware does:
+//  - BME688 at 400 kHz: a forced-mode trigger, then the field burst once the
+//    measurement window is over, then the next trigger (BME688Scheduler);
+//  - MLX90614 at 100 kHz: ambient and object reads every 100 ms;
+//  - QwiicRF at 100 kHz: the LoRa receiver's listen loop, which polls the
+//    payload size back to back (vTaskDelay(pdMS_TO_TICKS(1)) is 0 ticks at
+//    100 Hz) and reads a 32-byte payload after every 50th poll on average.
+// Two policies are compared:
+//  - direct: no arbiter; the tasks contend for the driver's bus lock and
+//    get it in arrival order, modelled as one level of the queue;
+//  - arbiter: one owner task picks the highest-priority queued transaction
+//    (BME688 HIGH, MLX90614 NORMAL, QwiicRF LOW), first come first served
+//    within a level, and never interrupts a transaction on the wire.
+// For each device it reports the transaction count and the mean and
+// worst-case queue wait, and checks the arbiter's bound: a HIGH transaction
+// never waits longer than the longest other transaction plus one
+// arbiter hand-off.
+//
+// Build from this directory:
+//   c++ -std=c++11 -O2 -I../components/i2c_bus_lib/include i2c_arbiter_sim.cpp -o i2c_arbiter_sim
+//
+// Usage: ./i2c_arbiter_sim [seconds]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "i2c_bus_policy.h"
+
+namespace {
+
+const double TXN_OVERHEAD_US = 60;      // driver, ISR and wake-up per transaction
+const double ARBITER_OVERHEAD_US = 15;  // queue hand-off and extra task switch
+
+const I2CPriority HIGH = I2C_PRIO_HIGH;
+const I2CPriority NORMAL = I2C_PRIO_NORMAL;
+const I2CPriority LOW = I2C_PRIO_LOW;
+
+struct Device {
+    const char *name;
+    I2CPriority prio;
+    double clk_hz;
+    // State of the device's task
+    double ready_us;        // when its next transaction is submitted
+    bool queued;
+    int phase;
+    long polls;
+    // Statistics
+    long txns;
+    double wait_sum_us;
+    double max_wait_us;
+    double max_txn_us;
+};
+
+// Bytes on the wire including address bytes, and what the task does after a transaction.
+struct Step {
+    int bytes;
+    double gap_after_us;
+};
+
+double txn_us(const Device &d, int bytes) {
+    return TXN_OVERHEAD_US + bytes * 9 * 1e6 / d.clk_hz;
+}
+
+std::mt19937 rng(614);
+
+Step next_step(Device &d) {
+    if (d.prio == HIGH) {
+        // trigger: addr + reg + ctrl_meas; readout: addr + reg + addr + 17
+        // after 33 ms of TPH conversion and 100 ms of heating
+        if (d.phase++ % 2 == 0) return { 3, 132775 };
+        return { 20, 0 };
+    }
+    if (d.prio == NORMAL) {
+        // SMBus read word with PEC: addr + cmd + addr + 3, ambient then object
+        if (d.phase++ % 2 == 0) return { 6, 0 };
+        return { 6, 100000 };
+    }
+    // packetAvailable: addr + cmd + addr + 1; payload: addr + cmd + addr + 32
+    if (d.phase == 1) {
+        d.phase = 0;
+        return { 35, 0 };
+    }
+    d.polls++;
+    if (std::uniform_int_distribution<int>(0, 49)(rng) == 0) d.phase = 1;
+    return { 4, 0 };
+}
+
+std::vector<Device> make_devices() {
+    std::vector<Device> devs = {
+        { "BME688", HIGH, 400000, 0, false, 0, 0, 0, 0, 0, 0 },
+        { "MLX90614", NORMAL, 100000, 0, false, 0, 0, 0, 0, 0, 0 },
+        { "QwiicRF", LOW, 100000, 0, false, 0, 0, 0, 0, 0, 0 },
+    };
+    // Start the periodic devices at random phases.
+    devs[0].ready_us = std::uniform_real_distribution<double>(0, 133000)(rng);
+    devs[1].ready_us = std::uniform_real_distribution<double>(0, 100000)(rng);
+    return devs;
+}
+
+// Runs the bus for duration_us and returns the devices with their statistics.
+std::vector<Device> simulate(bool arbiter, double duration_us) {
+    rng.seed(614);
+    std::vector<Device> devs = make_devices();
+    std::vector<Step> pending(devs.size());
+    for (size_t i = 0; i < devs.size(); i++) {
+        pending[i] = next_step(devs[i]);
+    }
+
+    I2CArbiterQueue<int, 8> queue;
+    double bus_free = 0;
+    while (bus_free < duration_us) {
+        // Queue the transactions submitted by the time the bus is free, in
+        // the order they were submitted, and run the one the queue picks.
+        std::vector<int> submitted;
+        for (size_t i = 0; i < devs.size(); i++) {
+            if (!devs[i].queued && devs[i].ready_us <= bus_free) submitted.push_back((int)i);
+        }
+        std::sort(submitted.begin(), submitted.end(),
+                  [&](int a, int b) { return devs[a].ready_us < devs[b].ready_us; });
+        for (int i : submitted) {
+            queue.push(arbiter ? devs[i].prio : NORMAL, i);
+            devs[i].queued = true;
+        }
+        int pick = -1;
+        if (!queue.pop(pick)) {
+            // Idle bus: jump to the next submission.
+            double next = devs[0].ready_us;
+            for (const Device &d : devs) next = d.ready_us < next ? d.ready_us : next;
+            bus_free = next;
+            continue;
+        }
+
+        Device &d = devs[pick];
+        d.queued = false;
+        double start = bus_free + (arbiter ? ARBITER_OVERHEAD_US : 0);
+        double dur = txn_us(d, pending[pick].bytes);
+        double wait = start - d.ready_us;
+        d.txns++;
+        d.wait_sum_us += wait;
+        d.max_wait_us = wait > d.max_wait_us ? wait : d.max_wait_us;
+        d.max_txn_us = dur > d.max_txn_us ? dur : d.max_txn_us;
+        bus_free = start + dur;
+        d.ready_us = bus_free + pending[pick].gap_after_us;
+        pending[pick] = next_step(d);
+    }
+    return devs;
+}
+
+void print(const char *policy, const std::vector<Device> &devs, double seconds) {
+    for (const Device &d : devs) {
+        printf("%-8s %-9s %4s  %7.0f/s  %9.1f  %9.1f\n", policy, d.name,
+               d.prio == HIGH ? "high" : d.prio == NORMAL ? "norm" : "low", d.txns / seconds,
+               d.txns ? d.wait_sum_us / d.txns : 0, d.max_wait_us);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    double seconds = argc > 1 ? atof(argv[1]) : 60;
+    if (seconds <= 0) {
+        fprintf(stderr, "Usage: %s [seconds]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Device> direct = simulate(false, seconds * 1e6);
+    std::vector<Device> arbitrated = simulate(true, seconds * 1e6);
+
+    printf("%.0f s simulated, %.0f us overhead per transaction, %.0f us per arbiter hand-off\n", seconds,
+           TXN_OVERHEAD_US, ARBITER_OVERHEAD_US);
+    printf("policy   device    prio     txns    wait/us  worst/us\n");
+    print("direct", direct, seconds);
+    print("arbiter", arbitrated, seconds);
+
+    // Bound for HIGH under the arbiter: the longest lower-priority transaction
+    // in flight, plus the hand-offs before it and before the HIGH one.
+    double longest_other = 0;
+    for (const Device &d : arbitrated) {
+        if (d.prio != HIGH && d.max_txn_us > longest_other) longest_other = d.max_txn_us;
+    }
+    double bound = longest_other + 2 * ARBITER_OVERHEAD_US;
+    bool ok = arbitrated[0].max_wait_us <= bound + 1e-6;
+    printf("\nBME688 worst-case wait: %.1f us direct, %.1f us arbiter (bound %.1f us): %s\n", direct[0].max_wait_us,
+           arbitrated[0].max_wait_us, bound, ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+// Host-side test of the i2c_bus_lib scheduling policy (i2c_bus_policy.h).
+//
+// Checks the arbiter queue the firmware runs: a HIGH item always comes out
+// before NORMAL and LOW ones, items of one level come out in the order they
+// went in, a full level refuses an item without touching the others, and the
+// ring wraps around. Checks the per-device backoff: two deadlines after a
+// timeout, doubling per further timeout in a row up to I2C_BUS_BACKOFF_MAX_MS,
+// and back to two deadlines after a transaction that completes.
+//
+// Build from this directory:
+//   c++ -std=c++11 -Wall -I../components/i2c_bus_lib/include i2c_bus_policy_test.cpp -o i2c_bus_policy_test
+//
+// Usage: ./i2c_bus_policy_test
+
+#include <cstdio>
+#include "i2c_bus_policy.h"
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char *what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+void test_queue_order() {
+    I2CArbiterQueue<int, 4> q;
+    check(q.empty(), "a new queue is empty");
+    q.push(I2C_PRIO_LOW, 30);
+    q.push(I2C_PRIO_NORMAL, 20);
+    q.push(I2C_PRIO_LOW, 31);
+    q.push(I2C_PRIO_HIGH, 10);
+    q.push(I2C_PRIO_NORMAL, 21);
+    q.push(I2C_PRIO_HIGH, 11);
+
+    const int expect[] = { 10, 11, 20, 21, 30, 31 };
+    const I2CPriority expect_prio[] = { I2C_PRIO_HIGH, I2C_PRIO_HIGH, I2C_PRIO_NORMAL,
+                                        I2C_PRIO_NORMAL, I2C_PRIO_LOW, I2C_PRIO_LOW };
+    for (int i = 0; i < 6; i++) {
+        int item = -1;
+        I2CPriority prio = I2C_PRIO_COUNT;
+        check(q.pop(item, &prio), "pop returns a queued item");
+        check(item == expect[i], "priority order, first in first out within a level");
+        check(prio == expect_prio[i], "pop reports the item's level");
+    }
+    int item;
+    check(!q.pop(item), "pop on an empty queue fails");
+}
+
+void test_queue_full() {
+    I2CArbiterQueue<int, 2> q;
+    check(q.push(I2C_PRIO_LOW, 1) && q.push(I2C_PRIO_LOW, 2), "a level takes N items");
+    check(!q.push(I2C_PRIO_LOW, 3), "a full level refuses an item");
+    check(q.size(I2C_PRIO_LOW) == 2, "a refused item is not queued");
+    check(q.push(I2C_PRIO_HIGH, 4), "a full level does not block the others");
+
+    // Wrap each level's ring several times.
+    int item = 0;
+    for (int i = 0; i < 10; i++) {
+        q.pop(item);
+        q.push(I2C_PRIO_HIGH, 100 + i);
+    }
+    check(item == 108, "the ring keeps its order when it wraps");
+    check(q.size(I2C_PRIO_HIGH) == 1 && q.size(I2C_PRIO_LOW) == 2, "wrapping leaves the other levels alone");
+}
+
+void test_backoff() {
+    I2CBackoff b;
+    check(!b.active(0), "no backoff before a timeout");
+
+    // 10 ms deadline: 20, 40, 80 ... ms, capped at I2C_BUS_BACKOFF_MAX_MS
+    int64_t t = 1000000;
+    int64_t expect_ms = 20;
+    for (int i = 0; i < 10; i++) {
+        b.timed_out(t, 10);
+        int64_t want = (expect_ms < I2C_BUS_BACKOFF_MAX_MS ? expect_ms : I2C_BUS_BACKOFF_MAX_MS) * 1000;
+        check(b.until_us == t + want, "backoff doubles per timeout in a row, up to the limit");
+        check(b.active(t + want - 1) && !b.active(t + want), "calls are refused until the backoff ends");
+        t = b.until_us + 5000;
+        expect_ms *= 2;
+    }
+
+    b.succeeded();
+    b.timed_out(t, 10);
+    check(b.until_us == t + 20000, "a completed transaction resets the doubling");
+
+    I2CBackoff slow;
+    slow.timed_out(0, 800);
+    check(slow.until_us == I2C_BUS_BACKOFF_MAX_MS * 1000LL, "the first backoff is capped too");
+}
+
+} // namespace
+
+int main() {
+    test_queue_order();
+    test_queue_full();
+    test_backoff();
+    printf("i2c_bus_policy: %s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
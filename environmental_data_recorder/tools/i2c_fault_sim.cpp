@@ -0,0 +1,237 @@
+// Host-side fault-injection test of the i2c_bus_lib deadlines, bus recovery
+// and per-device backoff. The backoff (I2CBackoff) and the arbiter's pick
+// (I2CArbiterQueue) come from i2c_bus_policy.h, the code the library runs;
+// the bus, the faults and the deadlines themselves are modelled.
+//
+// The devices and tasks of i2c_arbiter_sim share one bus behind the arbiter:
+//  - BME688 at 400 kHz (HIGH): trigger, field burst after the 132.8 ms
+//    window, next trigger; a failed transaction restarts at the trigger, as
+//    BME688Scheduler re-triggers after a failed completion;
+//  - MLX90614 at 100 kHz (NORMAL): ambient and object reads every 100 ms;
+//  - QwiicRF at 100 kHz (LOW): polls the payload size back to back, with the
+//    library's default wait, and reads a payload after every 50th poll.
+// Two faults are injected:
+//  - from HANG_START_S to HANG_END_S the QwiicRF firmware hangs and stretches
+//    SCL on every transaction addressed to it until the master gives up;
+//  - at STUCK_S a glitch interrupts an MLX90614 read and the sensor keeps
+//    SDA low until it sees clock pulses. Every transaction then times out
+//    until the bus is cleared.
+// Two configurations are compared:
+//  - before: 1000 ms timeouts, portMAX_DELAY (forever) for the QwiicRF, no
+//    bus clear after a timeout;
+//  - after: per-device deadlines (BME688 and MLX90614 10 ms, QwiicRF 50 ms),
+//    i2c_master_bus_reset() after a timeout (RECOVERY_US), and a backoff
+//    that doubles from two deadlines up to I2C_BUS_BACKOFF_MAX_MS after
+//    consecutive timeouts, during which the device's calls fail without
+//    touching the bus. A failed call costs its task LOG_US for the warning.
+// It prints the successful samples per second of each device in four
+// windows: before the faults, during the hang, between the faults and after
+// the stuck bus. It checks that with deadlines the BME688 and MLX90614 keep
+// at least 90 % of their fault-free rate in every window.
+//
+// Build from this directory:
+//   c++ -std=c++11 -O2 -I../components/i2c_bus_lib/include i2c_fault_sim.cpp -o i2c_fault_sim
+//
+// Usage: ./i2c_fault_sim
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "i2c_bus_policy.h"
+
+namespace {
+
+const double TXN_OVERHEAD_US = 60;
+const double ARBITER_OVERHEAD_US = 15;
+const double RECOVERY_US = 150;         // 9 SCL pulses at 100 kHz, STOP, controller reset
+const double LOG_US = 4000;             // one ESP_LOGW line at 115200 baud
+const double FOREVER = 1e18;
+
+const double HANG_START_S = 10;
+const double HANG_END_S = 20;
+const double STUCK_S = 30;
+const double END_S = 40;
+
+const I2CPriority HIGH = I2C_PRIO_HIGH;
+const I2CPriority NORMAL = I2C_PRIO_NORMAL;
+const I2CPriority LOW = I2C_PRIO_LOW;
+
+struct Device {
+    const char *name;
+    I2CPriority prio;
+    double clk_hz;
+    double timeout_us;
+    // State of the device's task
+    double ready_us;
+    bool queued;
+    int phase;
+    I2CBackoff backoff;
+    // Successful samples per window
+    long samples[4];
+};
+
+struct Config {
+    const char *name;
+    double timeout_us[3];   // BME688, MLX90614, QwiicRF
+    bool recover;
+    bool backoff;
+};
+
+struct Step {
+    int bytes;
+    double gap_after_us;
+};
+
+std::mt19937 rng(614);
+
+int window(double t_us) {
+    double t = t_us / 1e6;
+    return t < HANG_START_S ? 0 : t < HANG_END_S ? 1 : t < STUCK_S ? 2 : 3;
+}
+
+Step next_step(Device &d) {
+    if (d.prio == HIGH) {
+        if (d.phase % 2 == 0) return { 3, 132775 };
+        return { 20, 0 };
+    }
+    if (d.prio == NORMAL) {
+        if (d.phase % 2 == 0) return { 6, 0 };
+        return { 6, 100000 };
+    }
+    if (d.phase == 1) return { 35, 0 };
+    return { 4, 0 };
+}
+
+// Moves the device's task on after a transaction (or a refused call) ended at t.
+void advance(Device &d, const Step &s, bool ok, double t) {
+    if (d.prio == HIGH) {
+        // A sample is a field burst read after its trigger.
+        if (ok && d.phase % 2 == 1) d.samples[window(t)]++;
+        d.phase = ok ? d.phase + 1 : 0;
+        d.ready_us = t + (ok ? s.gap_after_us : LOG_US);
+        return;
+    }
+    if (d.prio == NORMAL) {
+        // Ambient then object; the task keeps its 100 ms period either way.
+        if (ok && d.phase % 2 == 1) d.samples[window(t)]++;
+        d.phase++;
+        d.ready_us = t + (d.phase % 2 == 0 ? 100000 : 0) + (ok ? 0 : LOG_US);
+        return;
+    }
+    if (ok) d.samples[window(t)]++;
+    d.phase = (ok && d.phase == 0 && std::uniform_int_distribution<int>(0, 49)(rng) == 0) ? 1 : 0;
+    d.ready_us = t + (ok ? 0 : LOG_US);
+}
+
+std::vector<Device> simulate(const Config &cfg) {
+    rng.seed(614);
+    std::vector<Device> devs = {
+        { "BME688", HIGH, 400000, cfg.timeout_us[0], 0, false, 0, I2CBackoff(), {} },
+        { "MLX90614", NORMAL, 100000, cfg.timeout_us[1], 0, false, 0, I2CBackoff(), {} },
+        { "QwiicRF", LOW, 100000, cfg.timeout_us[2], 0, false, 0, I2CBackoff(), {} },
+    };
+    devs[0].ready_us = std::uniform_real_distribution<double>(0, 133000)(rng);
+    devs[1].ready_us = std::uniform_real_distribution<double>(0, 100000)(rng);
+
+    I2CArbiterQueue<int, 8> queue;
+    bool stuck = false;
+    bool stuck_fired = false;
+    double bus_free = 0;
+    while (bus_free < END_S * 1e6) {
+        // Calls refused by a backoff never reach the queue.
+        for (Device &d : devs) {
+            while (cfg.backoff && !d.queued && d.backoff.active((int64_t)d.ready_us) && d.ready_us < END_S * 1e6) {
+                advance(d, next_step(d), false, d.ready_us);
+            }
+        }
+        // Queue what was submitted by the time the bus is free, in order.
+        std::vector<int> submitted;
+        for (size_t i = 0; i < devs.size(); i++) {
+            if (!devs[i].queued && devs[i].ready_us <= bus_free) submitted.push_back((int)i);
+        }
+        std::sort(submitted.begin(), submitted.end(),
+                  [&](int a, int b) { return devs[a].ready_us < devs[b].ready_us; });
+        for (int i : submitted) {
+            queue.push(devs[i].prio, i);
+            devs[i].queued = true;
+        }
+        int pick = -1;
+        if (!queue.pop(pick)) {
+            double next = FOREVER;
+            for (const Device &d : devs) next = d.ready_us < next ? d.ready_us : next;
+            bus_free = next;
+            continue;
+        }
+
+        Device &d = devs[pick];
+        d.queued = false;
+        Step s = next_step(d);
+        double start = bus_free + ARBITER_OVERHEAD_US;
+        double wire_us = TXN_OVERHEAD_US + s.bytes * 9 * 1e6 / d.clk_hz;
+        double dur = wire_us;
+        bool ok = true;
+        bool hung = d.prio == LOW && start >= HANG_START_S * 1e6 && start < HANG_END_S * 1e6;
+        if (!stuck_fired && d.prio == NORMAL && start >= STUCK_S * 1e6) {
+            stuck = true;
+            stuck_fired = true;
+        }
+        if (stuck) {
+            dur = d.timeout_us;
+            ok = false;
+        } else if (hung) {
+            // The slave lets go when its firmware comes back, or when the master gives up.
+            double released = HANG_END_S * 1e6 - start + wire_us;
+            ok = released <= d.timeout_us;
+            dur = ok ? released : d.timeout_us;
+        }
+        if (dur >= FOREVER) break;
+        bool timed_out = !ok;
+        if (timed_out && cfg.recover) {
+            dur += RECOVERY_US;
+            stuck = false;
+        }
+        bus_free = start + dur;
+        if (timed_out && cfg.backoff) {
+            d.backoff.timed_out((int64_t)bus_free, (int)(d.timeout_us / 1000));
+        } else if (ok) {
+            d.backoff.succeeded();
+        }
+        advance(d, s, ok, bus_free);
+    }
+    return devs;
+}
+
+} // namespace
+
+int main(int argc, char **) {
+    if (argc > 1) {
+        fprintf(stderr, "Usage: ./i2c_fault_sim\n");
+        return 1;
+    }
+    const Config configs[2] = {
+        { "before", { 1000000, 1000000, FOREVER }, false, false },
+        { "after", { 10000, 10000, 50000 }, true, true },
+    };
+    const double lengths[4] = { HANG_START_S, HANG_END_S - HANG_START_S, STUCK_S - HANG_END_S, END_S - STUCK_S };
+
+    printf("QwiicRF hangs %.0f-%.0f s, MLX90614 holds SDA low from %.0f s; samples/s per window\n", HANG_START_S,
+           HANG_END_S, STUCK_S);
+    printf("config  device     no fault   QwiicRF hung   between   after stuck SDA\n");
+    bool ok = true;
+    for (const Config &cfg : configs) {
+        std::vector<Device> devs = simulate(cfg);
+        for (const Device &d : devs) {
+            double rate[4];
+            for (int w = 0; w < 4; w++) rate[w] = d.samples[w] / lengths[w];
+            printf("%-7s %-9s %9.1f %14.1f %9.1f %17.1f\n", cfg.name, d.name, rate[0], rate[1], rate[2], rate[3]);
+            if (cfg.recover && d.prio != LOW) {
+                for (int w = 1; w < 4; w++) ok = ok && rate[w] >= 0.9 * rate[0];
+            }
+        }
+    }
+    printf("\nwith deadlines BME688 and MLX90614 keep >= 90 %% of their rate through both faults: %s\n",
+           ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+#ifndef I2C_BUS_LIB_H
+#define I2C_BUS_LIB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "driver/i2c_master.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "i2c_bus_policy.h"
+
+// Default bus wiring of the boards in this repository
+#define I2C_BUS_DEFAULT_PORT I2C_NUM_0
+#define I2C_BUS_DEFAULT_SDA_IO 21
+#define I2C_BUS_DEFAULT_SCL_IO 22
+
+// Deadline of one transaction on the wire for devices that do not set their
+// own (I2CDevice::set_deadline_ms()). A transaction that runs past it fails
+// with ESP_ERR_TIMEOUT and the bus is recovered before the next one.
+#define I2C_BUS_DEADLINE_MS 20
+
+// timeout_ms argument that selects the device's deadline; -1 waits forever
+#define I2C_BUS_DEVICE_DEADLINE 0
+
+// Transactions each arbiter priority level can hold before submitters block
+#define I2C_ARBITER_QUEUE_LEN 8
+
+// Per-device transaction counters. Wait is the time from submission until
+// the transaction got the bus; bus time is how long it then took, including
+// a bus recovery after a timeout.
+struct I2CDeviceStats {
+    uint32_t transactions;
+    uint32_t errors;
+    uint32_t timeouts;      // errors that were deadline overruns
+    uint32_t recoveries;    // bus recoveries after this device's timeouts
+    uint32_t skipped;       // calls refused during a backoff, not in transactions
+    uint64_t wait_us;
+    uint32_t max_wait_us;
+    uint64_t bus_us;
+    uint32_t max_bus_us;
+};
+
+/**
+ * @struct I2CBusConfig
+ * @brief Pins of an I2C port. The first device opened on a port creates the
+ * bus with these pins; later devices on the same port share it.
+ */
+struct I2CBusConfig {
+    i2c_port_t port = I2C_BUS_DEFAULT_PORT;
+    int sda_io = I2C_BUS_DEFAULT_SDA_IO;
+    int scl_io = I2C_BUS_DEFAULT_SCL_IO;
+    bool internal_pullup = true;
+};
+
+/**
+ * @class I2CBus
+ * @brief Per-port registry of i2c_master buses.
+ * A bus is created by the first acquire() on its port and deleted by the
+ * last release(). Call these from one task at a time (normally at init).
+ */
+class I2CBus {
+public:
+    static esp_err_t acquire(const I2CBusConfig &config, i2c_master_bus_handle_t *out_handle);
+    static void release(i2c_port_t port);
+
+    /**
+     * @brief Starts an arbiter task that owns the bus of a port.
+     * From then on every I2CDevice transaction on the port is queued by the
+     * device's priority and executed by that one task, in priority order and
+     * first come, first served within a level (I2CArbiterQueue in
+     * i2c_bus_policy.h). Without an arbiter devices
+     * call the driver directly and contend for its bus lock.
+     * The port needs an open device. Start and stop it while the devices are idle.
+     * @param task_priority FreeRTOS priority of the arbiter task; keep it
+     *        above the tasks that submit transactions.
+     */
+    static esp_err_t start_arbiter(i2c_port_t port, UBaseType_t task_priority = 10);
+    // Runs the queued transactions, then stops the arbiter task.
+    static void stop_arbiter(i2c_port_t port);
+
+    /**
+     * @brief Frees a bus that a slave holds, and resets the controller.
+     * i2c_master_bus_reset() clocks SCL until the slave lets go of SDA, sends
+     * a STOP and resets the controller's state machine. Transactions that
+     * overrun their deadline do this automatically.
+     * Without an arbiter, a transaction another task has on the bus at that
+     * moment fails too.
+     */
+    static esp_err_t recover(i2c_port_t port);
+    // Recoveries run on the port since the bus was created.
+    static uint32_t recoveries(i2c_port_t port);
+};
+
+// Queued transaction, defined in i2c_bus_lib.cpp
+struct I2CTransaction;
+
+/**
+ * @class I2CDevice
+ * @brief One device on a shared I2C bus, with its own SCL clock.
+ * The i2c_master driver switches the clock per transaction and serialises
+ * transactions on a bus, so devices of different speeds can share the pins.
+ * Transactions are synchronous and allocate nothing, with or without an
+ * arbiter on the bus. Each one is bounded by the device's deadline; with an
+ * arbiter it may first wait for the transactions queued ahead of it, which
+ * are bounded by theirs.
+ */
+class I2CDevice {
+public:
+    I2CDevice() {}
+    ~I2CDevice();
+    I2CDevice(const I2CDevice &) = delete;
+    I2CDevice &operator=(const I2CDevice &) = delete;
+
+    /**
+     * @brief Joins (or creates) the bus and adds the device to it.
+     * @param bus Port and pins of the bus.
+     * @param addr 7-bit device address.
+     * @param scl_hz SCL clock used for this device's transactions.
+     */
+    esp_err_t open(const I2CBusConfig &bus, uint8_t addr, uint32_t scl_hz);
+    // Removes the device and releases the bus; safe to call when not open.
+    void close();
+    bool is_open() const { return handle != nullptr; }
+
+    // START, address+W, data, STOP.
+    esp_err_t write(const uint8_t *data, size_t len, int timeout_ms = I2C_BUS_DEVICE_DEADLINE);
+    // Register byte followed by data in one write transaction, without copying them together.
+    esp_err_t write_reg(uint8_t reg, const uint8_t *data, size_t len, int timeout_ms = I2C_BUS_DEVICE_DEADLINE);
+    // START, address+R, data, STOP.
+    esp_err_t read(uint8_t *data, size_t len, int timeout_ms = I2C_BUS_DEVICE_DEADLINE);
+    // Write, repeated START, read.
+    esp_err_t write_read(const uint8_t *out, size_t out_len, uint8_t *in, size_t in_len,
+                         int timeout_ms = I2C_BUS_DEVICE_DEADLINE);
+    esp_err_t read_reg(uint8_t reg, uint8_t *data, size_t len, int timeout_ms = I2C_BUS_DEVICE_DEADLINE) {
+        return write_read(&reg, 1, data, len, timeout_ms);
+    }
+
+    i2c_port_t port() const { return bus_port; }
+    uint8_t address() const { return dev_addr; }
+    uint32_t clk_hz() const { return scl_hz; }
+
+    // Longest a transaction of this device may hold the bus, in ms (> 0).
+    void set_deadline_ms(int ms) { deadline_ms = ms > 0 ? ms : I2C_BUS_DEADLINE_MS; }
+    int get_deadline_ms() const { return deadline_ms; }
+
+    // Arbiter queue of this device's transactions; I2C_PRIO_NORMAL by default.
+    void set_priority(I2CPriority prio) { priority = prio < I2C_PRIO_COUNT ? prio : I2C_PRIO_LOW; }
+    I2CPriority get_priority() const { return priority; }
+
+    I2CDeviceStats stats() const;
+    void reset_stats();
+
+private:
+    esp_err_t execute(I2CTransaction &t);
+
+    i2c_master_dev_handle_t handle = nullptr;
+    I2CPriority priority = I2C_PRIO_NORMAL;
+    I2CDeviceStats counters = {};
+    i2c_port_t bus_port = I2C_BUS_DEFAULT_PORT;
+    uint8_t dev_addr = 0;
+    uint32_t scl_hz = 0;
+    int deadline_ms = I2C_BUS_DEADLINE_MS;
+    I2CBackoff backoff;
+};
+
+#endif // I2C_BUS_LIB_H
@@ -1,7 +1,7 @@
 #ifndef QWIICRF_H
 #define QWIICRF_H
 
-#include "driver/i2c.h"
+#include "i2c_bus_lib.h"
 #include "esp_err.h"
 #include "freertos/FreeRTOS.h" // for TickType_t
 #include <cstdint>
@@ -11,30 +11,44 @@ public:
     // Default I2C address
     static constexpr uint8_t DEFAULT_ADDR = 0x35;
 
-    // Constructor: you supply I2C port, SDA/SCL pins, maybe clock speed
-    QwiicRF(i2c_port_t i2c_port, gpio_num_t sda_pin, gpio_num_t scl_pin, uint32_t clk_speed_hz = 100000);
+    // The ATtiny84 on the board is a software (USI) I2C slave; it is only
+    // specified for standard mode, so 100 kHz is the default.
+    static constexpr uint32_t DEFAULT_CLK_HZ = 100000;
 
-    esp_err_t init();  // initialise I2C & module
+    // Default deadline of one transaction. The ATtiny stretches the clock
+    // while it services the radio; a 32-byte payload read is about 3.3 ms at
+    // 100 kHz. A hung module then costs 50 ms per call instead of blocking forever.
+    static constexpr uint32_t DEFAULT_DEADLINE_MS = 50;
+    static constexpr TickType_t DEFAULT_WAIT = pdMS_TO_TICKS(DEFAULT_DEADLINE_MS);
+
+    // Constructor: you supply I2C port, SDA/SCL pins, maybe clock speed.
+    // The clock applies to this device only; the bus is shared.
+    QwiicRF(i2c_port_t i2c_port, gpio_num_t sda_pin, gpio_num_t scl_pin, uint32_t clk_speed_hz = DEFAULT_CLK_HZ);
+
+    esp_err_t init();  // join the I2C bus & initialise module
 
     // Send a packet
     // data: buffer of bytes to send
     // Uses the module's paired address (set via setPairedAddress)
-    esp_err_t sendPacket(const uint8_t *data, size_t len, TickType_t ticks_to_wait = portMAX_DELAY);
+    esp_err_t sendPacket(const uint8_t *data, size_t len, TickType_t ticks_to_wait = DEFAULT_WAIT);
 
     // Send to a specific RF address
-    esp_err_t sendPacketTo(uint8_t rf_addr, const uint8_t *data, size_t len, TickType_t ticks_to_wait = portMAX_DELAY);
+    esp_err_t sendPacketTo(uint8_t rf_addr, const uint8_t *data, size_t len, TickType_t ticks_to_wait = DEFAULT_WAIT);
 
     // Check if a packet is available
     // Returns number of bytes available, or 0 if none, or error <0
-    esp_err_t packetAvailable(size_t *out_len, TickType_t ticks_to_wait = portMAX_DELAY);
+    esp_err_t packetAvailable(size_t *out_len, TickType_t ticks_to_wait = DEFAULT_WAIT);
 
     // Read a packet
     // Reads up to buffer_len bytes into buffer; out_len gets the actual number of bytes
-    esp_err_t readPacket(uint8_t *buffer, size_t buffer_len, size_t *out_len, TickType_t ticks_to_wait = portMAX_DELAY);
+    esp_err_t readPacket(uint8_t *buffer, size_t buffer_len, size_t *out_len, TickType_t ticks_to_wait = DEFAULT_WAIT);
 
     // Settings
-    esp_err_t setRFAddress(uint8_t addr, TickType_t ticks_to_wait = portMAX_DELAY);
-    esp_err_t setPairedAddress(uint8_t addr, TickType_t ticks_to_wait = portMAX_DELAY);
+    esp_err_t setRFAddress(uint8_t addr, TickType_t ticks_to_wait = DEFAULT_WAIT);
+    esp_err_t setPairedAddress(uint8_t addr, TickType_t ticks_to_wait = DEFAULT_WAIT);
+
+    // Queue wait, bus time and errors of the module's I2C transactions
+    I2CDeviceStats busStats() const { return _i2c.stats(); }
 
 private:
     i2c_port_t _i2c_port;
@@ -42,6 +56,10 @@ private:
     gpio_num_t _scl_pin;
     uint32_t _clk_speed_hz;
     uint8_t _device_address;
+    I2CDevice _i2c;
+
+    // i2c_master takes a timeout in ms; portMAX_DELAY passed explicitly still means forever (-1)
+    static int timeoutMs(TickType_t ticks_to_wait);
 
     // Internal helper: write command + data
     esp_err_t i2cWrite(const uint8_t *data, size_t len, TickType_t ticks_to_wait);
@@ -39,25 +39,19 @@ QwiicRF::QwiicRF(i2c_port_t i2c_port, gpio_num_t sda_pin, gpio_num_t scl_pin, ui
 }
 
 esp_err_t QwiicRF::init() {
-    // configure the I2C master
-    i2c_config_t conf = {};
-    conf.mode = I2C_MODE_MASTER;
-    conf.sda_io_num = _sda_pin;
-    conf.scl_io_num = _scl_pin;
-    conf.sda_pullup_en = GPIO_PULLUP_ENABLE;
-    conf.scl_pullup_en = GPIO_PULLUP_ENABLE;
-    conf.master.clk_speed = _clk_speed_hz;
-    esp_err_t err = i2c_param_config(_i2c_port, &conf);
+    // join (or create) the shared bus, at this device's own clock
+    I2CBusConfig bus;
+    bus.port = _i2c_port;
+    bus.sda_io = _sda_pin;
+    bus.scl_io = _scl_pin;
+    esp_err_t err = _i2c.open(bus, _device_address, _clk_speed_hz);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "i2c_param_config failed: %d", err);
-        return err;
-    }
-
-    err = i2c_driver_install(_i2c_port, I2C_MODE_MASTER, 0, 0, 0);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "i2c_driver_install failed: %d", err);
+        ESP_LOGE(TAG, "I2C device open failed: %d", err);
         return err;
     }
+    // Packet polling is frequent and long; with a bus arbiter, sensor reads go first
+    _i2c.set_priority(I2C_PRIO_LOW);
+    _i2c.set_deadline_ms(DEFAULT_DEADLINE_MS);
 
     // Optionally: check device responsiveness (non-fatal)
     size_t avail = 0;
@@ -67,17 +61,12 @@ esp_err_t QwiicRF::init() {
     return ESP_OK;
 }
 
+int QwiicRF::timeoutMs(TickType_t ticks_to_wait) {
+    return ticks_to_wait == portMAX_DELAY ? -1 : (int)pdTICKS_TO_MS(ticks_to_wait);
+}
+
 esp_err_t QwiicRF::i2cWrite(const uint8_t *data, size_t len, TickType_t ticks_to_wait) {
-    // Use I2C master write
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    // device address + write bit
-    i2c_master_write_byte(cmd, (_device_address << 1) | I2C_MASTER_WRITE, true);
-    // ESP-IDF v4.2 API expects non-const pointer; data is not modified by driver
-    i2c_master_write(cmd, const_cast<uint8_t*>(data), len, true);
-    i2c_master_stop(cmd);
-    esp_err_t err = i2c_master_cmd_begin(_i2c_port, cmd, ticks_to_wait);
-    i2c_cmd_link_delete(cmd);
+    esp_err_t err = _i2c.write(data, len, timeoutMs(ticks_to_wait));
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "i2cWrite error: %d", err);
     }
@@ -85,17 +74,7 @@ esp_err_t QwiicRF::i2cWrite(const uint8_t *data, size_t len, TickType_t ticks_to
 }
 
 esp_err_t QwiicRF::i2cRead(uint8_t *data, size_t len, TickType_t ticks_to_wait) {
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (_device_address << 1) | I2C_MASTER_READ, true);
-    if (len > 1) {
-        i2c_master_read(cmd, data, len - 1, I2C_MASTER_ACK);
-    }
-    // last byte
-    i2c_master_read_byte(cmd, data + len - 1, I2C_MASTER_NACK);
-    i2c_master_stop(cmd);
-    esp_err_t err = i2c_master_cmd_begin(_i2c_port, cmd, ticks_to_wait);
-    i2c_cmd_link_delete(cmd);
+    esp_err_t err = _i2c.read(data, len, timeoutMs(ticks_to_wait));
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "i2cRead error: %d", err);
     }
@@ -133,16 +112,7 @@ esp_err_t QwiicRF::packetAvailable(size_t *out_len, TickType_t ticks_to_wait) {
     }
     // Ask for payload size, read back one byte with repeated-start
     uint8_t len = 0;
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (_device_address << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd, CMD_GET_PAYLOAD_SIZE, true);
-    i2c_master_start(cmd); // repeated start
-    i2c_master_write_byte(cmd, (_device_address << 1) | I2C_MASTER_READ, true);
-    i2c_master_read_byte(cmd, &len, I2C_MASTER_NACK);
-    i2c_master_stop(cmd);
-    esp_err_t err = i2c_master_cmd_begin(_i2c_port, cmd, ticks_to_wait);
-    i2c_cmd_link_delete(cmd);
+    esp_err_t err = _i2c.read_reg(CMD_GET_PAYLOAD_SIZE, &len, 1, timeoutMs(ticks_to_wait));
     if (err != ESP_OK) {
         ESP_LOGW(TAG, "packetAvailable: cmd_begin failed: %d", err);
         *out_len = 0;
@@ -172,19 +142,7 @@ esp_err_t QwiicRF::readPacket(uint8_t *buffer, size_t buffer_len, size_t *out_le
     }
 
     // Read using write (command) then repeated-start read
-    i2c_cmd_handle_t cmd2 = i2c_cmd_link_create();
-    i2c_master_start(cmd2);
-    i2c_master_write_byte(cmd2, (_device_address << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd2, CMD_GET_PAYLOAD, true);
-    i2c_master_start(cmd2); // repeated start
-    i2c_master_write_byte(cmd2, (_device_address << 1) | I2C_MASTER_READ, true);
-    if (avail > 1) {
-        i2c_master_read(cmd2, buffer, avail - 1, I2C_MASTER_ACK);
-    }
-    i2c_master_read_byte(cmd2, buffer + avail - 1, I2C_MASTER_NACK);
-    i2c_master_stop(cmd2);
-    err = i2c_master_cmd_begin(_i2c_port, cmd2, ticks_to_wait);
-    i2c_cmd_link_delete(cmd2);
+    err = _i2c.read_reg(CMD_GET_PAYLOAD, buffer, avail, timeoutMs(ticks_to_wait));
     if (err != ESP_OK) {
         ESP_LOGW(TAG, "readPacket: cmd_begin failed: %d", err);
         return err;
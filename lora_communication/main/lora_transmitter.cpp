@@ -2,7 +2,6 @@
 #include "freertos/task.h"
 #include "esp_log.h"
 #include "driver/gpio.h"
-#include "driver/i2c.h"
 #include <vector>
 #include <cstring>
 #include "qwiicrf.h"
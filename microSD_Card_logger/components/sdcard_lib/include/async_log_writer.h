@@ -0,0 +1,151 @@
+#ifndef ASYNC_LOG_WRITER_H
+#define ASYNC_LOG_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sdcard_lib.h"
+
+// Number of ping-pong buffers
+#define ASYNC_LOG_BUFFERS 2
+
+// Size of each buffer, a whole number of sectors
+#define ASYNC_LOG_BUFFER_SIZE (8 * 1024)
+
+// FAT sector size; full buffers end on a sector boundary of the file
+#define ASYNC_LOG_SECTOR_SIZE 512
+
+// Writes the header of a new segment to out, at most size bytes, and returns
+// its length. Called from the producer task, in write().
+typedef size_t (*AsyncLogHeaderFn)(uint8_t *out, size_t size, void *arg);
+
+struct AsyncLogWriterConfig {
+    size_t bufferSize = ASYNC_LOG_BUFFER_SIZE;
+    uint32_t flushAgeMs = 2000;         // poll() hands over a partial buffer this old, 0 = only flush() does
+    uint32_t fsyncIntervalMs = 10000;   // fsync at most this often after a write, 0 = only on stop()
+    uint32_t overflowWaitMs = 0;        // How long write() may wait for a free buffer, 0 = drop at once
+    uint32_t segmentBytes = 0;          // Preallocated segment size, a whole number of sectors; 0 = grow one file
+    AsyncLogHeaderFn segmentHeader = nullptr;   // Writes up to ASYNC_LOG_SECTOR_SIZE bytes at the start of each segment
+    void *segmentHeaderArg = nullptr;
+    UBaseType_t priority = 4;           // Priority of the writer task
+    BaseType_t core = tskNO_AFFINITY;   // Core of the writer task, e.g. 1 to keep it off the sampling core
+    uint32_t stackSize = 3072;
+};
+
+struct AsyncLogWriterStats {
+    uint32_t records;           // write() calls whose data was queued
+    uint32_t bytes;             // Bytes queued
+    uint32_t droppedRecords;    // write() calls dropped because no buffer was free in time
+    uint32_t droppedBytes;
+    uint32_t overflows;         // write() calls that found no free buffer
+    uint32_t buffersWritten;    // Buffers the writer task wrote out
+    uint32_t writeErrors;       // Failed or short write() and fsync() calls
+    uint32_t syncs;             // fsync() calls
+    uint32_t segments;          // Segments opened
+    uint32_t maxQueued;         // High-water mark of buffers waiting for the writer task
+    uint32_t maxWriteUs;        // Longest write() of one buffer
+    uint32_t maxWaitUs;         // Longest wait of write() for a free buffer
+};
+
+// Appends records to one file on the SD card from a dedicated writer task.
+// write() only copies the record into the active buffer. When the buffer is
+// full it goes to the writer task, which writes it in one write() call, and
+// the producer carries on in the other buffer. Full buffers end on a sector
+// boundary of the file, so FatFs writes them straight from the buffer.
+//
+// With segmentBytes set, the log goes to segments of that size, each one
+// allocated up front as one contiguous run of clusters. The writer then
+// never allocates a cluster, and each write is a plain sector write. A
+// session starts a new segment at the first unused name: log.txt,
+// log.1.txt, log.2.txt and so on. A record never spans two segments: one
+// that does not fit in what is left of a segment starts the next one. The
+// rest of the full segment is trimmed when it is closed, and stop() trims
+// the last one. After a power cut the last segment keeps its preallocated
+// size, and the data past the last record is whatever the clusters held
+// before.
+//
+// segmentHeader, if set, writes a header at the start of the session's
+// first segment and of every segment after it, so each segment can be read
+// on its own. It also heads the session in a file that grows.
+//
+// Overflow policy: when both buffers are still waiting to be written,
+// write() waits up to overflowWaitMs for one to come back and otherwise
+// drops the record, counting it in droppedRecords. A record is queued whole
+// or not at all. With overflowWaitMs = 0, write() never blocks.
+//
+// write(), poll() and flush() are for one producer task; guard them with a
+// mutex if several tasks log to the same file.
+class AsyncLogWriter {
+public:
+    // The card must be mounted before start() and outlive the writer
+    AsyncLogWriter(SDCard &card, const char *path, const AsyncLogWriterConfig &config = AsyncLogWriterConfig());
+
+    // Stops the writer task, writing out what is buffered
+    ~AsyncLogWriter();
+
+    // Open the file for appending and start the writer task
+    esp_err_t start();
+
+    // Hand over the partial buffer, wait for the writer task to write
+    // everything, fsync, close the file and end the task
+    void stop();
+
+    bool isRunning() const { return task != nullptr; }
+
+    // Queue a record of up to bufferSize - ASYNC_LOG_SECTOR_SIZE bytes
+    bool write(const void *data, size_t len);
+
+    // Queue a line of text
+    bool write(const char *line);
+
+    // Hand over the partial buffer once its oldest record is flushAgeMs old.
+    // Call it from the producer loop, so a slow log still reaches the card.
+    void poll();
+
+    // Hand over the partial buffer now
+    void flush();
+
+    // Snapshot of the counters, safe from any task
+    AsyncLogWriterStats getStats() const;
+
+private:
+    static void taskEntry(void *arg);
+    void run();
+    bool acquire(int &index);
+    void beginBuffer(int index);
+    void submit();
+    void drop(size_t len);
+    bool openSegment(int first_index);
+    bool nextSegment();
+
+    SDCard &card;
+    char full_path[128];
+    char rel_path[96];                      // Path given to the constructor, relative to the mount point
+    AsyncLogWriterConfig config;
+    int fd = -1;
+    int segment_index = -1;                 // Segment the writer task fills, by name suffix
+    uint32_t segment_pos = 0;               // Bytes written to that segment
+    uint8_t *buffers[ASYNC_LOG_BUFFERS] = {};
+    size_t used[ASYNC_LOG_BUFFERS] = {};
+    bool starts_segment[ASYNC_LOG_BUFFERS] = {};    // The buffer goes to a new segment
+    QueueHandle_t free_queue = nullptr;     // Buffer indices the producer may fill
+    QueueHandle_t full_queue = nullptr;     // Buffer indices for the writer task, -1 to stop
+    SemaphoreHandle_t stopped = nullptr;
+    TaskHandle_t task = nullptr;
+
+    // Producer state
+    int current = -1;                       // Buffer being filled, -1 if none
+    size_t fill = 0;
+    size_t capacity = 0;                    // Bytes that take the buffer to a sector boundary
+    uint64_t offset = 0;                    // Offset of the start of the current buffer in the file or segment
+    bool header_due = false;                // The next buffer starts with the segment header
+    int64_t oldest_us = 0;
+
+    AsyncLogWriterStats stats = {};     // Updated by the producer and the writer task, under stats_lock
+};
+
+#endif // ASYNC_LOG_WRITER_H
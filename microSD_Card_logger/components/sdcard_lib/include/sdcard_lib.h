@@ -0,0 +1,138 @@
+#ifndef SDCARD_LIB_H
+#define SDCARD_LIB_H
+
+#include "esp_err.h"
+#include "driver/sdmmc_host.h"
+#include <stdio.h> // Included for FILE type
+#include <string.h>
+#include <sys/unistd.h>
+#include <sys/stat.h>
+#include "esp_vfs_fat.h"
+#include "driver/sdspi_host.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "sdmmc_cmd.h"
+#include "esp_log.h"
+
+// SD clock init() aims for unless the constructor is given another, in kHz.
+// SDMMC_FREQ_26M and SDMMC_FREQ_HIGHSPEED (40 MHz) need short, clean wiring.
+#define SDCARD_FREQ_KHZ_DEFAULT SDMMC_FREQ_DEFAULT
+
+// Retries of a sector transfer that failed with a CRC or response error.
+// The first retry runs one clock step lower, the others at that clock.
+#define SDCARD_TRANSFER_RETRIES 2
+
+// Cluster size FatFs uses when it formats the card. Larger clusters mean
+// fewer FAT lookups and allocations per MB of log; 16 KB matches what
+// microSD_Card_logger formats with.
+#define SDCARD_ALLOCATION_UNIT_SIZE (16 * 1024)
+
+// Bus between the chip and the card, chosen at construction
+enum SDCardBus {
+    SDCARD_BUS_SPI,             // SDSPI on SPI2_HOST
+    SDCARD_BUS_SDMMC_1BIT,      // Native SDMMC host, CLK, CMD and D0
+    SDCARD_BUS_SDMMC_4BIT,      // Native SDMMC host, CLK, CMD and D0..D3
+};
+
+// Pins of an SD socket, by SD bus name. The defaults are SDMMC slot 1 of
+// the ESP32, the only pins it can use for SDMMC; chips with SDMMC on the
+// GPIO matrix (ESP32-S3, ESP32-P4) take any pins. D1..D3 need external
+// pull-ups in 4-bit mode, and on the ESP32 D2 is GPIO12, a strapping pin.
+struct SDCardSdmmcPins {
+    int clk = 14;
+    int cmd = 15;
+    int d0 = 2;
+    int d1 = 4;
+    int d2 = 12;
+    int d3 = 13;
+};
+
+// This is the public C++ header for the SDCard class.
+// It declares the class and its public member functions.
+class SDCard {
+private:
+    const char* mount_point;
+    sdmmc_card_t* card;
+    SDCardBus bus;
+    SDCardSdmmcPins sdmmc_pins; // Used by the SDMMC buses
+    spi_host_device_t host_id;
+    bool bus_owner;     // init() initialized the SPI bus, so unmount() frees it
+    int pin_mosi, pin_miso, pin_sclk, pin_cs;
+    uint32_t target_khz;        // Clock init() tries first
+    uint32_t freq_khz;          // Clock the card runs at now
+    uint32_t clock_step_downs;  // Step-downs since init() after CRC or response errors
+    int pdrv;                   // FatFs drive of the mounted card, -1 if none
+
+    esp_err_t initSpiBus();
+    esp_err_t mountAt(uint32_t khz, const esp_vfs_fat_sdmmc_mount_config_t &mount_config);
+    bool stepDownClock(esp_err_t cause);
+    friend struct SDCardDisk;
+
+public:
+    // Constructor to set up the pins, mount point and target SD clock
+    SDCard(const char* mountPoint, int mosi, int miso, int sclk, int cs,
+           uint32_t freqKhz = SDCARD_FREQ_KHZ_DEFAULT);
+
+    // Constructor for a socket wired by SD bus names. With SDCARD_BUS_SPI
+    // the same socket runs in SPI mode: CMD as MOSI, D0 as MISO, CLK as
+    // SCLK and D3 as CS.
+    SDCard(const char* mountPoint, SDCardBus bus, const SDCardSdmmcPins &pins = SDCardSdmmcPins(),
+           uint32_t freqKhz = SDCARD_FREQ_KHZ_DEFAULT);
+
+    // Destructor to ensure resources are freed
+    ~SDCard();
+
+    // Initialize the SPI bus or the SDMMC host and mount the SD card at the
+    // target clock, stepping down while the mount fails with CRC or response errors
+    esp_err_t init();
+
+    // Unmount the SD card and free resources
+    void unmount();
+
+    // Whether init() mounted the card
+    bool isMounted() const { return card != nullptr; }
+
+    // Mount point given to the constructor
+    const char* getMountPoint() const { return mount_point; }
+
+    // Bus chosen at construction
+    SDCardBus getBus() const { return bus; }
+
+    // Clock the card runs at now, in kHz; below the target after step-downs
+    uint32_t getClockKhz() const { return freq_khz; }
+
+    // Times the clock was stepped down since init()
+    uint32_t getClockStepDowns() const { return clock_step_downs; }
+    
+    // Function to write a simple file; appends to it unless append is false
+    void writeFile(const char *path, const char *data, bool append = true);
+
+    // Append raw bytes to a file, for binary capture logs
+    bool writeBinary(const char *path, const void *data, size_t len);
+
+    // Function to read a file
+    void readFile(const char *path);
+    
+    // Function to create a new directory
+    void createDirectory(const char *path);
+
+    // Function to delete a file
+    void deleteFile(const char *path);
+
+    // Function to delete a directory
+    void deleteDirectory(const char *path);
+
+    // Check if a directory exists
+    bool directoryExists(const char *path);
+
+    // Create an empty file and allocate size bytes to it as one contiguous
+    // run of clusters (FatFs f_expand). The file then reads as size bytes of
+    // whatever the clusters held; write it from the start and ftruncate() it
+    // to the length written.
+    esp_err_t createContiguousFile(const char *path, uint64_t size);
+
+    // Format the mounted card with the given cluster size. Erases everything.
+    esp_err_t format(size_t allocationUnitSize = SDCARD_ALLOCATION_UNIT_SIZE);
+};
+
+#endif // SDCARD_LIB_H
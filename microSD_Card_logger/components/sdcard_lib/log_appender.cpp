@@ -0,0 +1,247 @@
+#include "log_appender.h"
+#include <cerrno>
+#include <string.h>
+#include <sys/unistd.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "LOG_APPENDER";
+
+// Open appenders with flushOnShutdown, for the shutdown handler
+static LogAppender *open_appenders[LOG_APPENDER_MAX_OPEN];
+static portMUX_TYPE open_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool handler_registered = false;
+// Appender the shutdown handler is syncing; close() waits for it to finish
+static LogAppender *flushing = nullptr;
+
+LogAppender::LogAppender(SDCard &card, const char *path, const LogAppenderConfig &config)
+    : card(card), config(config) {
+    snprintf(full_path, sizeof(full_path), "%s/%s", card.getMountPoint(), path);
+    // Round the buffer up to whole sectors, so a full buffer is whole sectors too
+    this->config.bufferSize = (config.bufferSize + 511) & ~(size_t)511;
+    if (this->config.bufferSize == 0) {
+        this->config.bufferSize = LOG_APPENDER_BUFFER_SIZE;
+    }
+    if (this->config.flushBytes == 0 || this->config.flushBytes > this->config.bufferSize) {
+        this->config.flushBytes = this->config.bufferSize;
+    }
+}
+
+LogAppender::~LogAppender() {
+    close();
+}
+
+// Open the file for appending, creating it if needed
+esp_err_t LogAppender::open() {
+    if (file != nullptr) {
+        return ESP_OK;
+    }
+    if (!card.isMounted()) {
+        ESP_LOGE(TAG, "SD card is not mounted. Cannot open %s.", full_path);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    buffer = (char *)heap_caps_aligned_alloc(LOG_APPENDER_BUFFER_ALIGN, config.bufferSize,
+                                             MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+    if (buffer == nullptr) {
+        ESP_LOGE(TAG, "No memory for a %u byte buffer", (unsigned)config.bufferSize);
+        return ESP_ERR_NO_MEM;
+    }
+    file = fopen(full_path, "a");
+    if (file == nullptr) {
+        ESP_LOGE(TAG, "Failed to open %s for appending (errno=%d: %s)", full_path, errno, strerror(errno));
+        heap_caps_free(buffer);
+        buffer = nullptr;
+        return ESP_FAIL;
+    }
+    // Full buffering: stdio only writes when the buffer fills or on fflush()
+    setvbuf(file, buffer, _IOFBF, config.bufferSize);
+
+    pending = 0;
+    dirty = false;
+    last_sync_us = esp_timer_get_time();
+
+    if (config.flushOnShutdown) {
+        bool listed = false;
+        taskENTER_CRITICAL(&open_lock);
+        for (int i = 0; i < LOG_APPENDER_MAX_OPEN && !listed; i++) {
+            if (open_appenders[i] == nullptr) {
+                open_appenders[i] = this;
+                listed = true;
+            }
+        }
+        bool need_handler = listed && !handler_registered;
+        handler_registered = handler_registered || need_handler;
+        taskEXIT_CRITICAL(&open_lock);
+        if (need_handler && esp_register_shutdown_handler(shutdownHandler) != ESP_OK) {
+            ESP_LOGW(TAG, "Could not register the shutdown handler");
+        }
+        if (!listed) {
+            ESP_LOGW(TAG, "More than %d appenders open, %s is not flushed on restart", LOG_APPENDER_MAX_OPEN,
+                     full_path);
+        }
+    }
+    ESP_LOGI(TAG, "Appending to %s (%u byte buffer)", full_path, (unsigned)config.bufferSize);
+    return ESP_OK;
+}
+
+// Flush, fsync and close the file
+void LogAppender::close() {
+    if (file == nullptr) {
+        return;
+    }
+    taskENTER_CRITICAL(&open_lock);
+    for (int i = 0; i < LOG_APPENDER_MAX_OPEN; i++) {
+        if (open_appenders[i] == this) {
+            open_appenders[i] = nullptr;
+        }
+    }
+    taskEXIT_CRITICAL(&open_lock);
+    // The shutdown handler may have taken this appender from the list already
+    while (true) {
+        taskENTER_CRITICAL(&open_lock);
+        bool busy = flushing == this;
+        taskEXIT_CRITICAL(&open_lock);
+        if (!busy) {
+            break;
+        }
+        vTaskDelay(1);
+    }
+
+    sync();
+    if (fclose(file) != 0) {
+        stats.errors++;
+        ESP_LOGE(TAG, "Failed to close %s (errno=%d: %s)", full_path, errno, strerror(errno));
+    }
+    file = nullptr;
+    heap_caps_free(buffer);
+    buffer = nullptr;
+}
+
+// Append a line (or any text) and apply the flush and fsync policy
+bool LogAppender::append(const char *line) {
+    return append(line, strlen(line));
+}
+
+// Append raw bytes and apply the flush and fsync policy
+bool LogAppender::append(const void *data, size_t len) {
+    if (file == nullptr) {
+        ESP_LOGE(TAG, "%s is not open", full_path);
+        return false;
+    }
+    // Flush before the buffer overflows, so stdio never writes on its own
+    // and pending stays exact
+    if (pending + len > config.bufferSize && !flush()) {
+        return false;
+    }
+    int64_t now_us = esp_timer_get_time();
+    if (len > config.bufferSize) {
+        // Larger than the buffer: write it straight through, after what was buffered
+        if (::write(fileno(file), data, len) != (ssize_t)len) {
+            stats.errors++;
+            ESP_LOGE(TAG, "Failed to append to %s (errno=%d: %s)", full_path, errno, strerror(errno));
+            return false;
+        }
+        dirty = true;
+        stats.flushes++;
+        stats.lines++;
+        stats.bytes += len;
+        return applyPolicy(now_us);
+    }
+    if (pending == 0) {
+        oldest_us = now_us;
+    }
+    if (fwrite(data, 1, len, file) != len) {
+        stats.errors++;
+        ESP_LOGE(TAG, "Failed to append to %s (errno=%d: %s)", full_path, errno, strerror(errno));
+        return false;
+    }
+    pending += len;
+    stats.lines++;
+    stats.bytes += len;
+    return applyPolicy(now_us);
+}
+
+// Apply the age-based flush and the fsync cadence without appending
+bool LogAppender::poll() {
+    if (file == nullptr) {
+        return false;
+    }
+    return applyPolicy(esp_timer_get_time());
+}
+
+bool LogAppender::applyPolicy(int64_t now_us) {
+    bool ok = true;
+    if (pending > 0) {
+        bool by_bytes = pending >= config.flushBytes;
+        bool by_age = config.flushAgeMs > 0 && now_us - oldest_us >= (int64_t)config.flushAgeMs * 1000;
+        if (by_bytes || by_age) {
+            ok = flush();
+        }
+    }
+    if (dirty && config.fsyncIntervalMs > 0 && now_us - last_sync_us >= (int64_t)config.fsyncIntervalMs * 1000) {
+        ok = sync() && ok;
+    }
+    return ok;
+}
+
+// Write the buffered lines to the card now
+bool LogAppender::flush() {
+    if (file == nullptr) {
+        return false;
+    }
+    if (pending == 0) {
+        return true;
+    }
+    if (fflush(file) != 0) {
+        stats.errors++;
+        ESP_LOGE(TAG, "Failed to flush %s (errno=%d: %s)", full_path, errno, strerror(errno));
+        return false;
+    }
+    pending = 0;
+    dirty = true;
+    stats.flushes++;
+    return true;
+}
+
+// Flush, then fsync so the FAT and the directory entry are current
+bool LogAppender::sync() {
+    if (!flush()) {
+        return false;
+    }
+    if (!dirty) {
+        return true;
+    }
+    if (fsync(fileno(file)) != 0) {
+        stats.errors++;
+        ESP_LOGE(TAG, "Failed to sync %s (errno=%d: %s)", full_path, errno, strerror(errno));
+        return false;
+    }
+    dirty = false;
+    last_sync_us = esp_timer_get_time();
+    stats.syncs++;
+    return true;
+}
+
+// Runs in esp_restart(). stdio locks the FILE, so a line that another task
+// appends at the same moment is either in this flush or lost with the reset.
+// Each appender is marked while it is synced, so a close() in another task
+// waits instead of freeing it underneath.
+void LogAppender::shutdownHandler() {
+    for (int i = 0; i < LOG_APPENDER_MAX_OPEN; i++) {
+        taskENTER_CRITICAL(&open_lock);
+        LogAppender *appender = open_appenders[i];
+        flushing = appender;
+        taskEXIT_CRITICAL(&open_lock);
+        if (appender != nullptr) {
+            appender->sync();
+        }
+        taskENTER_CRITICAL(&open_lock);
+        flushing = nullptr;
+        taskEXIT_CRITICAL(&open_lock);
+    }
+}
@@ -0,0 +1,503 @@
+#include "sdcard_lib.h"
+#include <cerrno>
+#include <stdio.h>
+#include <string.h>
+#include <sys/unistd.h>
+#include <sys/stat.h>
+#include "esp_vfs_fat.h"
+#include "driver/sdmmc_host.h"
+#include "driver/sdspi_host.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "sdmmc_cmd.h"
+#include "soc/soc_caps.h"
+#include "diskio_impl.h"
+#include "diskio_sdmmc.h"
+#include "esp_log.h"
+
+static const char *TAG = "SD_CARD_LIB";
+
+// Clocks to step down through, in kHz, from the first one below the target
+static const uint32_t clock_ladder_khz[] = {
+    SDMMC_FREQ_HIGHSPEED, SDMMC_FREQ_26M, SDMMC_FREQ_DEFAULT, 10000, 5000, SDMMC_FREQ_PROBING,
+};
+
+// Mounted cards by FatFs drive, for the disk layer below
+static SDCard *disk_cards[FF_VOLUMES];
+
+static uint32_t next_lower_clock(uint32_t khz) {
+    for (uint32_t ladder_khz : clock_ladder_khz) {
+        if (ladder_khz < khz) {
+            return ladder_khz;
+        }
+    }
+    return 0;
+}
+
+// How a marginal link shows up: a bad CRC on data or a response, or (in
+// SPI mode) a response with garbled bits. A timeout is a busy card or no
+// card at all, which a lower clock does not fix.
+static bool is_link_error(esp_err_t err) {
+    return err == ESP_ERR_INVALID_CRC || err == ESP_ERR_INVALID_RESPONSE;
+}
+
+// FatFs disk layer of a mounted card. It replaces the sdmmc one that
+// esp_vfs_fat registers and does the same transfers, but when one fails
+// with a link error it steps the clock down and retries. FatFs holds the
+// volume lock around each call, so nothing else uses the card meanwhile.
+struct SDCardDisk {
+    // One transfer steps the clock down at most once and is tried at most
+    // 1 + SDCARD_TRANSFER_RETRIES times, so a bad card cannot walk the
+    // clock to the bottom of the ladder in a single call.
+    static DRESULT transfer(unsigned char pdrv, bool write, unsigned char *buff, uint32_t sector, unsigned count) {
+        SDCard *sd = disk_cards[pdrv];
+        bool stepped = false;
+        esp_err_t err = ESP_OK;
+        for (int attempt = 0; attempt <= SDCARD_TRANSFER_RETRIES; attempt++) {
+            err = write ? sdmmc_write_sectors(sd->card, buff, sector, count)
+                        : sdmmc_read_sectors(sd->card, buff, sector, count);
+            if (err == ESP_OK) {
+                return RES_OK;
+            }
+            if (!is_link_error(err)) {
+                break;
+            }
+            if (!stepped) {
+                stepped = true;
+                sd->stepDownClock(err);
+            }
+        }
+        ESP_LOGE(TAG, "Failed to %s %u sectors at %lu (%s)", write ? "write" : "read", count,
+                 (unsigned long)sector, esp_err_to_name(err));
+        return RES_ERROR;
+    }
+
+    static DSTATUS init(unsigned char pdrv) {
+        return 0;
+    }
+
+    static DSTATUS status(unsigned char pdrv) {
+        return 0;
+    }
+
+    static DRESULT read(unsigned char pdrv, unsigned char *buff, uint32_t sector, unsigned count) {
+        return transfer(pdrv, false, buff, sector, count);
+    }
+
+    static DRESULT write(unsigned char pdrv, const unsigned char *buff, uint32_t sector, unsigned count) {
+        return transfer(pdrv, true, const_cast<unsigned char *>(buff), sector, count);
+    }
+
+    static DRESULT ioctl(unsigned char pdrv, unsigned char cmd, void *buff) {
+        sdmmc_card_t *card = disk_cards[pdrv]->card;
+        switch (cmd) {
+        case CTRL_SYNC:
+            return RES_OK;
+        case GET_SECTOR_COUNT:
+            *(DWORD *)buff = card->csd.capacity;
+            return RES_OK;
+        case GET_SECTOR_SIZE:
+            *(WORD *)buff = card->csd.sector_size;
+            return RES_OK;
+#if FF_USE_TRIM
+        case CTRL_TRIM: {
+            if (sdmmc_can_trim(card) != ESP_OK) {
+                return RES_PARERR;
+            }
+            DWORD *range = (DWORD *)buff;
+            esp_err_t err = sdmmc_erase_sectors(card, range[0], range[1] - range[0] + 1, SDMMC_ERASE_ARG);
+            return err == ESP_OK ? RES_OK : RES_ERROR;
+        }
+#endif
+        default:
+            return RES_ERROR;
+        }
+    }
+};
+
+static const ff_diskio_impl_t clocked_disk = {
+    .init = &SDCardDisk::init,
+    .status = &SDCardDisk::status,
+    .read = &SDCardDisk::read,
+    .write = &SDCardDisk::write,
+    .ioctl = &SDCardDisk::ioctl,
+};
+
+// Implementation of the SDCard class member functions.
+
+// Constructor
+SDCard::SDCard(const char* mountPoint, int mosi, int miso, int sclk, int cs, uint32_t freqKhz) {
+    mount_point = mountPoint;
+    pin_mosi = mosi;
+    pin_miso = miso;
+    pin_sclk = sclk;
+    pin_cs = cs;
+    card = nullptr;
+    bus = SDCARD_BUS_SPI;
+    host_id = SPI2_HOST; // Using SPI2_HOST by default
+    bus_owner = false;
+    target_khz = freqKhz;
+    freq_khz = 0;
+    clock_step_downs = 0;
+    pdrv = -1;
+}
+
+// Constructor for a socket wired by SD bus names
+SDCard::SDCard(const char* mountPoint, SDCardBus bus, const SDCardSdmmcPins &pins, uint32_t freqKhz)
+    : SDCard(mountPoint, pins.cmd, pins.d0, pins.clk, pins.d3, freqKhz) {
+    this->bus = bus;
+    sdmmc_pins = pins;
+}
+
+// Destructor
+SDCard::~SDCard() {
+    unmount();
+}
+
+// Initialize the SPI bus, or join it if another device set it up
+esp_err_t SDCard::initSpiBus() {
+    gpio_set_pull_mode(static_cast<gpio_num_t>(pin_mosi), GPIO_PULLUP_ONLY);
+    gpio_set_pull_mode(static_cast<gpio_num_t>(pin_miso), GPIO_PULLUP_ONLY);
+    gpio_set_pull_mode(static_cast<gpio_num_t>(pin_sclk), GPIO_PULLUP_ONLY);
+    gpio_set_pull_mode(static_cast<gpio_num_t>(pin_cs), GPIO_PULLUP_ONLY);
+
+    spi_bus_config_t bus_cfg = {};
+    bus_cfg.mosi_io_num = pin_mosi;
+    bus_cfg.miso_io_num = pin_miso;
+    bus_cfg.sclk_io_num = pin_sclk;
+    bus_cfg.quadwp_io_num = -1;
+    bus_cfg.quadhd_io_num = -1;
+    bus_cfg.max_transfer_sz = 4000;
+
+    // Another device on the host (e.g. a BME688 over SPI) may have set the
+    // bus up already; the card then joins it as one more device.
+    esp_err_t ret = spi_bus_initialize(host_id, &bus_cfg, SPI_DMA_CH_AUTO);
+    if (ret == ESP_ERR_INVALID_STATE) {
+        ESP_LOGI(TAG, "SPI bus already initialized, sharing it.");
+    } else if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize SPI bus (%s).", esp_err_to_name(ret));
+        return ret;
+    } else {
+        bus_owner = true;
+    }
+    return ESP_OK;
+}
+
+// Mount the card over the chosen bus with the given clock
+esp_err_t SDCard::mountAt(uint32_t khz, const esp_vfs_fat_sdmmc_mount_config_t &mount_config) {
+    if (bus == SDCARD_BUS_SPI) {
+        sdmmc_host_t host = SDSPI_HOST_DEFAULT();
+        host.slot = host_id;
+        host.max_freq_khz = khz;
+
+        sdspi_device_config_t slot_config = SDSPI_DEVICE_CONFIG_DEFAULT();
+        slot_config.gpio_cs = static_cast<gpio_num_t>(pin_cs);
+        slot_config.host_id = (spi_host_device_t)host.slot;
+        return esp_vfs_fat_sdspi_mount(mount_point, &host, &slot_config, &mount_config, &card);
+    }
+#if SOC_SDMMC_HOST_SUPPORTED
+    sdmmc_host_t host = SDMMC_HOST_DEFAULT();
+    host.slot = SDMMC_HOST_SLOT_1;
+    host.max_freq_khz = khz;
+
+    sdmmc_slot_config_t slot_config = SDMMC_SLOT_CONFIG_DEFAULT();
+    slot_config.width = (bus == SDCARD_BUS_SDMMC_4BIT) ? 4 : 1;
+#if SOC_SDMMC_USE_GPIO_MATRIX
+    slot_config.clk = static_cast<gpio_num_t>(sdmmc_pins.clk);
+    slot_config.cmd = static_cast<gpio_num_t>(sdmmc_pins.cmd);
+    slot_config.d0 = static_cast<gpio_num_t>(sdmmc_pins.d0);
+    if (slot_config.width == 4) {
+        slot_config.d1 = static_cast<gpio_num_t>(sdmmc_pins.d1);
+        slot_config.d2 = static_cast<gpio_num_t>(sdmmc_pins.d2);
+        slot_config.d3 = static_cast<gpio_num_t>(sdmmc_pins.d3);
+    }
+#endif
+    // Only enough for short wires; the lines still want 10k pull-ups
+    slot_config.flags |= SDMMC_SLOT_FLAG_INTERNAL_PULLUP;
+    return esp_vfs_fat_sdmmc_mount(mount_point, &host, &slot_config, &mount_config, &card);
+#else
+    ESP_LOGE(TAG, "This chip has no SDMMC host, use SDCARD_BUS_SPI.");
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+// Initialize the SPI bus or the SDMMC host and mount the SD card
+esp_err_t SDCard::init() {
+    esp_err_t ret;
+    if (bus == SDCARD_BUS_SPI) {
+        ESP_LOGI(TAG, "Initializing SPI bus and SD card...");
+        ret = initSpiBus();
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    } else {
+        ESP_LOGI(TAG, "Initializing SDMMC host (%d-bit) and SD card...", bus == SDCARD_BUS_SDMMC_4BIT ? 4 : 1);
+    }
+
+    esp_vfs_fat_sdmmc_mount_config_t mount_config = {};
+    mount_config.format_if_mount_failed = false;
+    mount_config.max_files = 5;
+    mount_config.allocation_unit_size = SDCARD_ALLOCATION_UNIT_SIZE;
+
+    // The card is identified at the 400 kHz probing clock and then switched
+    // to max_freq_khz. If the link does not hold at that clock, the mount
+    // fails with a link error; try again one step lower. Anything else (no
+    // card, a timeout, ESP_FAIL for a card without a FAT volume) fails at once.
+    freq_khz = target_khz;
+    clock_step_downs = 0;
+    while (true) {
+        ret = mountAt(freq_khz, mount_config);
+        uint32_t lower = next_lower_clock(freq_khz);
+        if (ret == ESP_OK || lower == 0 || !is_link_error(ret)) {
+            break;
+        }
+        ESP_LOGW(TAG, "Mount at %lu kHz failed (%s), retrying at %lu kHz", (unsigned long)freq_khz,
+                 esp_err_to_name(ret), (unsigned long)lower);
+        card = nullptr;
+        freq_khz = lower;
+        clock_step_downs++;
+    }
+
+    if (ret != ESP_OK) {
+        if (ret == ESP_FAIL) {
+            ESP_LOGE(TAG, "Failed to mount filesystem. "
+                           "If you want to format the card, set format_if_mount_failed = true.");
+        } else {
+            ESP_LOGE(TAG, "Failed to initialize the card (%s). "
+                           "Make sure there is an SD card in the slot and try again.", esp_err_to_name(ret));
+        }
+        card = nullptr;
+        if (bus_owner) {
+            spi_bus_free(host_id);
+            bus_owner = false;
+        }
+        return ret;
+    }
+
+    // A card without high-speed mode is left at 20 MHz by the driver
+    freq_khz = card->max_freq_khz;
+
+    // Route FatFs through the disk layer that steps the clock down
+    BYTE drive = ff_diskio_get_pdrv_card(card);
+    if (drive < FF_VOLUMES) {
+        pdrv = drive;
+        disk_cards[pdrv] = this;
+        ff_diskio_register(pdrv, &clocked_disk);
+    } else {
+        ESP_LOGW(TAG, "FatFs drive of the card not found, no clock step-down after mount");
+    }
+
+    ESP_LOGI(TAG, "SD card mounted successfully at %s (%lu kHz)", mount_point, (unsigned long)freq_khz);
+    sdmmc_card_print_info(stdout, card);
+    return ESP_OK;
+}
+
+// Unmount the SD card and free resources
+void SDCard::unmount() {
+    if (card != nullptr) {
+        esp_vfs_fat_sdcard_unmount(mount_point, card);
+        ESP_LOGI(TAG, "Card unmounted");
+        card = nullptr;
+    }
+    if (pdrv >= 0) {
+        disk_cards[pdrv] = nullptr;
+        pdrv = -1;
+    }
+    if (bus_owner) {
+        spi_bus_free(host_id);
+        bus_owner = false;
+    }
+}
+
+// Switch the card to the next lower clock after a link error
+bool SDCard::stepDownClock(esp_err_t cause) {
+    uint32_t lower = next_lower_clock(freq_khz);
+    if (lower == 0) {
+        return false;
+    }
+    esp_err_t err = card->host.set_card_clk(card->host.slot, lower);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set the SD clock to %lu kHz (%s)", (unsigned long)lower, esp_err_to_name(err));
+        return false;
+    }
+    ESP_LOGW(TAG, "%s at %lu kHz, SD clock stepped down to %lu kHz", esp_err_to_name(cause),
+             (unsigned long)freq_khz, (unsigned long)lower);
+    freq_khz = lower;
+    card->max_freq_khz = lower;
+    if (card->host.get_real_freq != nullptr) {
+        card->host.get_real_freq(card->host.slot, &card->real_freq_khz);
+    }
+    clock_step_downs++;
+    return true;
+}
+
+// Function to write a simple file
+void SDCard::writeFile(const char *path, const char *data, bool append) {
+    if (!card) {
+        ESP_LOGE(TAG, "SD card is not mounted. Cannot write file.");
+        return;
+    }
+    char full_path[128];
+    snprintf(full_path, sizeof(full_path), "%s/%s", mount_point, path);
+
+    ESP_LOGI(TAG, "Writing file: %s", full_path);
+    FILE *f = fopen(full_path, append ? "a" : "w");
+    if (f == NULL && append) {
+        ESP_LOGW(TAG, "Append mode failed, trying write mode (errno=%d: %s)", errno, strerror(errno));
+        f = fopen(full_path, "w");
+    }
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Failed to open file for writing (errno=%d: %s)", errno, strerror(errno));
+        return;
+    }
+    fprintf(f, "%s", data);
+    fflush(f);
+    fclose(f);
+    ESP_LOGI(TAG, "File written successfully");
+}
+
+// Append raw bytes to a file, for binary capture logs
+bool SDCard::writeBinary(const char *path, const void *data, size_t len) {
+    if (!card) {
+        ESP_LOGE(TAG, "SD card is not mounted. Cannot write file.");
+        return false;
+    }
+    char full_path[128];
+    snprintf(full_path, sizeof(full_path), "%s/%s", mount_point, path);
+
+    FILE *f = fopen(full_path, "ab");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Failed to open %s for appending (errno=%d: %s)", full_path, errno, strerror(errno));
+        return false;
+    }
+    size_t written = fwrite(data, 1, len, f);
+    fclose(f);
+    if (written != len) {
+        ESP_LOGE(TAG, "Short write to %s: %u of %u bytes", full_path, (unsigned)written, (unsigned)len);
+        return false;
+    }
+    ESP_LOGD(TAG, "Appended %u bytes to %s", (unsigned)len, full_path);
+    return true;
+}
+
+// Function to read a file
+void SDCard::readFile(const char *path) {
+    if (!card) {
+        ESP_LOGE(TAG, "SD card is not mounted. Cannot read file.");
+        return;
+    }
+    char full_path[128];
+    snprintf(full_path, sizeof(full_path), "%s/%s", mount_point, path);
+
+    ESP_LOGI(TAG, "Reading file: %s", full_path);
+    FILE *f = fopen(full_path, "r");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Failed to open file for reading");
+        return;
+    }
+    char line[128];
+    while (fgets(line, sizeof(line), f) != NULL) {
+        ESP_LOGI(TAG, "Read: %s", line);
+    }
+    fclose(f);
+}
+
+// Function to create a new directory
+void SDCard::createDirectory(const char *path) {
+    if (!card) {
+        ESP_LOGE(TAG, "SD card is not mounted. Cannot create directory.");
+        return;
+    }
+    char full_path[128];
+    snprintf(full_path, sizeof(full_path), "%s/%s", mount_point, path);
+
+    ESP_LOGI(TAG, "Creating directory: %s", full_path);
+    int res = mkdir(full_path, 0777);
+    if (res != 0) {
+        ESP_LOGE(TAG, "Failed to create directory %s (errno=%d: %s)", full_path, errno, strerror(errno));
+    } else {
+        ESP_LOGI(TAG, "Directory created successfully: %s", full_path);
+    }
+}
+
+// Check if a directory exists
+bool SDCard::directoryExists(const char *path) {
+    char full_path[128];
+    snprintf(full_path, sizeof(full_path), "%s/%s", mount_point, path);
+    struct stat st;
+    if (stat(full_path, &st) == 0 && S_ISDIR(st.st_mode)) {
+        return true;
+    }
+    return false;
+}
+
+// Function to delete a file
+void SDCard::deleteFile(const char *path) {
+    if (!card) {
+        ESP_LOGE(TAG, "SD card is not mounted. Cannot delete file.");
+        return;
+    }
+    char full_path[128];
+    snprintf(full_path, sizeof(full_path), "%s/%s", mount_point, path);
+
+    ESP_LOGI(TAG, "Deleting file: %s", full_path);
+    if (unlink(full_path) != 0) {
+        ESP_LOGE(TAG, "Failed to delete file");
+    } else {
+        ESP_LOGI(TAG, "File deleted successfully");
+    }
+}
+
+// Function to delete a directory
+void SDCard::deleteDirectory(const char *path) {
+    if (!card) {
+        ESP_LOGE(TAG, "SD card is not mounted. Cannot delete directory.");
+        return;
+    }
+    char full_path[128];
+    snprintf(full_path, sizeof(full_path), "%s/%s", mount_point, path);
+
+    ESP_LOGI(TAG, "Deleting directory: %s", full_path);
+    if (rmdir(full_path) != 0) {
+        ESP_LOGE(TAG, "Failed to delete directory");
+    } else {
+        ESP_LOGI(TAG, "Directory deleted successfully");
+    }
+}
+
+// Create an empty file and allocate size bytes to it as one contiguous run of clusters
+esp_err_t SDCard::createContiguousFile(const char *path, uint64_t size) {
+    if (!card) {
+        ESP_LOGE(TAG, "SD card is not mounted. Cannot create file.");
+        return ESP_ERR_INVALID_STATE;
+    }
+    char full_path[128];
+    snprintf(full_path, sizeof(full_path), "%s/%s", mount_point, path);
+
+    esp_err_t ret = esp_vfs_fat_create_contiguous_file(mount_point, full_path, size, true);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to allocate %llu contiguous bytes to %s (%s)", (unsigned long long)size, full_path,
+                 esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGD(TAG, "Allocated %llu contiguous bytes to %s", (unsigned long long)size, full_path);
+    return ESP_OK;
+}
+
+// Format the mounted card with the given cluster size
+esp_err_t SDCard::format(size_t allocationUnitSize) {
+    if (!card) {
+        ESP_LOGE(TAG, "SD card is not mounted. Cannot format.");
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_vfs_fat_sdmmc_mount_config_t format_config = {};
+    format_config.max_files = 5;
+    format_config.allocation_unit_size = allocationUnitSize;
+
+    ESP_LOGI(TAG, "Formatting the card with %u byte clusters", (unsigned)allocationUnitSize);
+    esp_err_t ret = esp_vfs_fat_sdcard_format_cfg(mount_point, card, &format_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to format the card (%s)", esp_err_to_name(ret));
+    }
+    return ret;
+}
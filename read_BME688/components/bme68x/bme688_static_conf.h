@@ -0,0 +1,112 @@
+// Compile-time BME688 configuration for the Bosch BME68x driver.
+//
+// A BME688StaticConf<...> type fixes oversampling, filter, ODR and the
+// forced-mode heater step (or no gas measurement at all) at compile time.
+// Invalid settings fail the build, and everything the read path needs
+// (measurement duration, ctrl_meas value, gas_wait encoding) is a constant,
+// so a forced read is one register write, a fixed delay and the field burst.
+//
+// The heater resistance (res_heat_0) depends on the sensor's calibration and
+// ambient temperature, so bme68x_set_heatr_conf() still computes it once at
+// init from heatr_conf().
+
+#ifndef BME688_STATIC_CONF_H
+#define BME688_STATIC_CONF_H
+
+#include "bme68x.h"
+
+#ifdef __cplusplus
+
+// Starts a forced measurement by writing a precomputed ctrl_meas value. Only
+// valid while the sensor is asleep; bme68x_set_op_mode() is the general path.
+inline int8_t bme688_trigger_forced(uint8_t ctrl_meas, struct bme68x_dev *dev) {
+    const uint8_t reg = BME68X_REG_CTRL_MEAS;
+    return bme68x_set_regs(&reg, &ctrl_meas, 1, dev);
+}
+
+// Same as bme688_trigger_forced(), but rewrites ctrl_gas_1 in the same bus
+// transaction, which turns the gas measurement on or off for this read
+// without an extra register round trip.
+inline int8_t bme688_trigger_forced_gas(uint8_t ctrl_meas, uint8_t ctrl_gas_1, struct bme68x_dev *dev) {
+    const uint8_t reg[2] = { BME68X_REG_CTRL_GAS_1, BME68X_REG_CTRL_MEAS };
+    const uint8_t val[2] = { ctrl_gas_1, ctrl_meas };
+    return bme68x_set_regs(reg, val, 2, dev);
+}
+
+template <uint8_t OsTemp, uint8_t OsPres, uint8_t OsHum, uint8_t Filter = BME68X_FILTER_OFF,
+          uint8_t Odr = BME68X_ODR_NONE, uint16_t HeatrTempC = 300, uint16_t HeatrDurMs = 100,
+          uint8_t GasEnable = BME68X_ENABLE>
+struct BME688StaticConf {
+    static_assert(OsTemp <= BME68X_OS_16X, "temperature oversampling out of range");
+    static_assert(OsPres <= BME68X_OS_16X, "pressure oversampling out of range");
+    static_assert(OsHum <= BME68X_OS_16X, "humidity oversampling out of range");
+    static_assert(OsTemp != BME68X_OS_NONE, "temperature is needed to compensate every other value");
+    static_assert(Filter <= BME68X_FILTER_SIZE_127, "IIR filter size out of range");
+    static_assert(Odr <= BME68X_ODR_NONE, "ODR out of range");
+    static_assert(HeatrTempC <= 400, "heater temperature above 400 degC");
+    static_assert(HeatrDurMs > 0 && HeatrDurMs < 0xFC0, "heater duration must be 1..4031 ms");
+    static_assert(GasEnable == BME68X_ENABLE || GasEnable == BME68X_DISABLE, "GasEnable out of range");
+
+    static constexpr uint8_t os_temp = OsTemp;
+    static constexpr uint8_t os_pres = OsPres;
+    static constexpr uint8_t os_hum = OsHum;
+    static constexpr uint8_t filter = Filter;
+    static constexpr uint8_t odr = Odr;
+    static constexpr uint16_t heatr_temp = HeatrTempC;
+    static constexpr uint16_t heatr_dur_ms = HeatrDurMs;
+    static constexpr bool gas_enabled = GasEnable == BME68X_ENABLE;
+
+    // Same arithmetic as bme68x_get_meas_dur().
+    static constexpr uint32_t meas_cycles(uint8_t os) {
+        return os == BME68X_OS_NONE ? 0 : (uint32_t)1 << (os - 1);
+    }
+    static constexpr uint32_t meas_dur_us(uint8_t op_mode) {
+        return (meas_cycles(OsTemp) + meas_cycles(OsPres) + meas_cycles(OsHum)) * UINT32_C(1963) +
+               UINT32_C(477 * 4) + UINT32_C(477 * 5) + (op_mode != BME68X_PARALLEL_MODE ? UINT32_C(1000) : 0);
+    }
+
+    // TPH conversion of a forced measurement, and the whole window including the heater.
+    static constexpr uint32_t forced_meas_dur_us = meas_dur_us(BME68X_FORCED_MODE);
+    static constexpr uint32_t forced_period_us = forced_meas_dur_us + (gas_enabled ? (uint32_t)HeatrDurMs * 1000 : 0);
+
+    // Same encoding as calc_gas_wait(): 6-bit value with a x1/x4/x16/x64 factor.
+    static constexpr uint8_t gas_wait_reg(uint16_t dur, uint8_t factor = 0) {
+        return dur > 0x3F ? gas_wait_reg(dur / 4, factor + 1) : (uint8_t)(dur + factor * 64);
+    }
+    static constexpr uint8_t gas_wait_0 = gas_wait_reg(HeatrDurMs);
+
+    // ctrl_meas value that starts a forced measurement from sleep.
+    static constexpr uint8_t ctrl_meas_forced = (uint8_t)((OsTemp << 5) | (OsPres << 2) | BME68X_FORCED_MODE);
+
+    // Settings for the one-time bme68x_set_conf() / bme68x_set_heatr_conf() calls at init.
+    static constexpr struct bme68x_conf conf() {
+        struct bme68x_conf c = {};
+        c.os_hum = OsHum;
+        c.os_pres = OsPres;
+        c.os_temp = OsTemp;
+        c.filter = Filter;
+        c.odr = Odr;
+        return c;
+    }
+    static constexpr struct bme68x_heatr_conf heatr_conf() {
+        struct bme68x_heatr_conf h = {};
+        h.enable = GasEnable;
+        h.heatr_temp = HeatrTempC;
+        h.heatr_dur = HeatrDurMs;
+        return h;
+    }
+
+    // Starts a forced measurement with a single register write, once the
+    // previous one has run for forced_period_us.
+    static int8_t trigger_forced(struct bme68x_dev *dev) {
+        return bme688_trigger_forced(ctrl_meas_forced, dev);
+    }
+};
+
+// Oversampling and heater step used by the examples in this repository:
+// T x8, P x4, H x2, no filter, 300 degC for 100 ms.
+typedef BME688StaticConf<BME68X_OS_8X, BME68X_OS_4X, BME68X_OS_2X> BME688DefaultConf;
+
+#endif // __cplusplus
+
+#endif // BME688_STATIC_CONF_H
@@ -76,6 +76,27 @@ extern "C" {
  */
 int8_t bme68x_init(struct bme68x_dev *dev);
 
+/*!
+ * \ingroup bme68xApiInit
+ * \page bme68x_api_bme68x_init_with_calib bme68x_init_with_calib
+ * \code
+ * int8_t bme68x_init_with_calib(const uint8_t *coeff, uint32_t variant_id, struct bme68x_dev *dev);
+ * \endcode
+ * @details This API is an alternative entry point to bme68x_init for a sensor
+ * that stayed powered since its calibration registers were saved with
+ * bme68x_get_calib_regs, e.g. across deep sleep. It verifies the chip-id but
+ * skips the soft reset and the calibration register reads.
+ *
+ * @param[in] coeff      : Buffer of BME68X_LEN_COEFF_ALL saved calibration registers.
+ * @param[in] variant_id : Saved variant ID of the sensor.
+ * @param[in,out] dev    : Structure instance of bme68x_dev
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme68x_init_with_calib(const uint8_t *coeff, uint32_t variant_id, struct bme68x_dev *dev);
+
 /**
  * \ingroup bme68x
  * \defgroup bme68xApiRegister Registers
@@ -155,7 +176,12 @@ int8_t bme68x_soft_reset(struct bme68x_dev *dev);
  * \code
  * int8_t bme68x_set_op_mode(const uint8_t op_mode, struct bme68x_dev *dev);
  * \endcode
- * @details This API is used to set the operation mode of the sensor
+ * @details This API is used to set the operation mode of the sensor.
+ * With dev->shadow.enable set before bme68x_init, the driver keeps a copy of
+ * the control registers 0x70 to 0x75. A sensor it knows to be asleep (after a
+ * sleep write, or a forced field read with new data) is then not read back or
+ * polled, and bme68x_set_conf / bme68x_set_heatr_conf write only the
+ * registers that change.
  * @param[in] op_mode : Desired operation mode.
  * @param[in] dev     : Structure instance of bme68x_dev
  *
@@ -213,6 +239,10 @@ uint32_t bme68x_get_meas_dur(const uint8_t op_mode, struct bme68x_conf *conf, st
  * @details This API reads the pressure, temperature and humidity and gas data
  * from the sensor, compensates the data and store it in the bme68x_data
  * structure instance passed by the user.
+ * In forced mode a field without new data is read again up to
+ * dev->poll_tries times, dev->poll_period_us apart (BME68X_POLL_TRIES and
+ * BME68X_PERIOD_POLL when zero); intf_stats.data_polls counts the misses.
+ * There is no wait after the last try, so poll_tries = 1 reads the field once.
  *
  * @param[in]  op_mode : Expected operation mode.
  * @param[out] data    : Structure instance to hold the data.
@@ -225,6 +255,142 @@ uint32_t bme68x_get_meas_dur(const uint8_t op_mode, struct bme68x_conf *conf, st
  */
 int8_t bme68x_get_data(uint8_t op_mode, struct bme68x_data *data, uint8_t *n_data, struct bme68x_dev *dev);
 
+/*!
+ * \ingroup bme68xApiData
+ * \page bme68x_api_bme68x_compensate_batch bme68x_compensate_batch
+ * \code
+ * int8_t bme68x_compensate_batch(const struct bme68x_raw_batch *raw,
+ *                                struct bme68x_comp_batch *comp,
+ *                                const struct bme68x_calib_data *calib,
+ *                                uint32_t variant_id);
+ * \endcode
+ * @details This API compensates a batch of raw ADC samples that share one set
+ * of calibration coefficients. It runs the same compensation routines as
+ * bme68x_get_data, one quantity at a time over chunks of BME68X_BATCH_CHUNK
+ * samples, so the results are identical to the per-sample path as long as
+ * both are built with the same floating point contraction settings.
+ * No sensor access is made, so this can run on a host against captured data.
+ *
+ * @param[in] raw        : Raw ADC samples, one array per quantity.
+ * @param[out] comp      : Output arrays, each holding at least raw->len entries.
+ * @param[in] calib      : Calibration coefficients of the sensor that produced the samples.
+ * @param[in] variant_id : BME68X_VARIANT_GAS_LOW or BME68X_VARIANT_GAS_HIGH.
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme68x_compensate_batch(const struct bme68x_raw_batch *raw,
+                               struct bme68x_comp_batch *comp,
+                               const struct bme68x_calib_data *calib,
+                               uint32_t variant_id);
+
+/*!
+ * \ingroup bme68xApiData
+ * \page bme68x_api_bme68x_precompute_calib bme68x_precompute_calib
+ * \code
+ * int8_t bme68x_precompute_calib(struct bme68x_calib_data *calib);
+ * \endcode
+ * @details This API derives the coefficients of the temperature, pressure and
+ * humidity compensation (calib->comp) from the par_* calibration values, so
+ * that each compensation is a short chain of multiply-adds on ready-made
+ * coefficients. bme68x_init and bme68x_init_with_calib call it; call it
+ * again after filling or changing the par_* values of a bme68x_calib_data
+ * by hand, before passing it to bme68x_compensate_batch.
+ *
+ * The integer build gives the same results as the reference formulas of the
+ * datasheet. In the floating point build the formulas are regrouped, which
+ * moves the results by a few units in the last place: at most 1e-5 degC,
+ * 0.05 Pa and 5e-5 %rH over the sensor's operating range.
+ *
+ * @param[in,out] calib : Calibration coefficients to complete.
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme68x_precompute_calib(struct bme68x_calib_data *calib);
+
+/*!
+ * \ingroup bme68xApiData
+ * \page bme68x_api_bme68x_get_raw_data bme68x_get_raw_data
+ * \code
+ * int8_t bme68x_get_raw_data(uint8_t op_mode, struct bme68x_raw_data *data, uint8_t *n_data, struct bme68x_dev *dev);
+ * \endcode
+ * @details This API reads the pressure, temperature, humidity and gas ADC
+ * values from the sensor without compensating them. Fields are returned in
+ * the same order and with the same status as bme68x_get_data.
+ *
+ * @param[in]  op_mode : Expected operation mode.
+ * @param[out] data    : Structure instance to hold the data, 3 entries in parallel and sequential mode.
+ * @param[out] n_data  : Number of data instances available.
+ * @param[in,out] dev  : Structure instance of bme68x_dev
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme68x_get_raw_data(uint8_t op_mode, struct bme68x_raw_data *data, uint8_t *n_data, struct bme68x_dev *dev);
+
+/*!
+ * \ingroup bme68xApiData
+ * \page bme68x_api_bme68x_compensate_raw_data bme68x_compensate_raw_data
+ * \code
+ * int8_t bme68x_compensate_raw_data(const struct bme68x_raw_data *raw, struct bme68x_data *data, struct bme68x_dev *dev);
+ * \endcode
+ * @details This API compensates one field read by bme68x_get_raw_data. The
+ * result is identical to what bme68x_get_data returns for the same field.
+ * No sensor access is made, so dev only needs calibration data, which can be
+ * loaded with bme68x_set_calib_regs. The heater settings idac, res_heat and
+ * gas_wait are only filled in while dev holds a copy of the heater registers.
+ *
+ * @param[in] raw     : Uncompensated field.
+ * @param[out] data   : Structure instance to hold the compensated data.
+ * @param[in,out] dev : Structure instance of bme68x_dev
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme68x_compensate_raw_data(const struct bme68x_raw_data *raw, struct bme68x_data *data, struct bme68x_dev *dev);
+
+/*!
+ * \ingroup bme68xApiSystem
+ * \page bme68x_api_bme68x_get_calib_regs bme68x_get_calib_regs
+ * \code
+ * int8_t bme68x_get_calib_regs(uint8_t *coeff, struct bme68x_dev *dev);
+ * \endcode
+ * @details This API reads the BME68X_LEN_COEFF_ALL calibration coefficient
+ * registers of the sensor, in the order expected by bme68x_set_calib_regs.
+ *
+ * @param[out] coeff  : Buffer of BME68X_LEN_COEFF_ALL bytes.
+ * @param[in,out] dev : Structure instance of bme68x_dev
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme68x_get_calib_regs(uint8_t *coeff, struct bme68x_dev *dev);
+
+/*!
+ * \ingroup bme68xApiSystem
+ * \page bme68x_api_bme68x_set_calib_regs bme68x_set_calib_regs
+ * \code
+ * int8_t bme68x_set_calib_regs(const uint8_t *coeff, uint32_t variant_id, struct bme68x_dev *dev);
+ * \endcode
+ * @details This API loads calibration coefficient registers saved with
+ * bme68x_get_calib_regs into dev, without accessing the sensor.
+ *
+ * @param[in] coeff      : Buffer of BME68X_LEN_COEFF_ALL bytes.
+ * @param[in] variant_id : Variant ID of the sensor the registers were read from.
+ * @param[in,out] dev    : Structure instance of bme68x_dev
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme68x_set_calib_regs(const uint8_t *coeff, uint32_t variant_id, struct bme68x_dev *dev);
+
 /**
  * \ingroup bme68x
  * \defgroup bme68xApiConfig Configuration
@@ -2,8 +2,10 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 #include "bme68x.h"
 #include "bme68x_defs.h"
+#include "bme688_static_conf.h"
 #include "esp_log.h"
 #include "driver/i2c.h"
 #include "esp_rom_sys.h"
@@ -15,9 +17,14 @@
 #define I2C_MASTER_FREQ_HZ 100000
 #define BME68X_ADDR 0x77
 
+// Compile-time sensor settings; pick another BME688StaticConf<> to change them.
+typedef BME688DefaultConf SensorConf;
+
 class BME688 {
 public:
     static constexpr const char* TAG = "BME688";
+    // Steps in the gas fingerprint heater profile
+    static const uint8_t PROFILE_LEN = 10;
     BME688() {
         i2c_config_t i2c_conf;
         i2c_conf.mode = I2C_MODE_MASTER;
@@ -45,11 +52,7 @@ public:
             return;
         }
 
-        conf.os_hum = BME68X_OS_2X;
-        conf.os_pres = BME68X_OS_4X;
-        conf.os_temp = BME68X_OS_8X;
-        conf.filter = BME68X_FILTER_OFF;
-        conf.odr = BME68X_ODR_NONE;
+        conf = SensorConf::conf();
         rslt = bme68x_set_conf(&conf, &dev);
         if (rslt != BME68X_OK) {
             ESP_LOGE(TAG, "bme68x_set_conf failed: %d", rslt);
@@ -57,31 +60,70 @@ public:
             return;
         }
 
-        heatr_conf.enable = BME68X_ENABLE;
-        heatr_conf.heatr_temp = 300;
-        heatr_conf.heatr_dur = 100;
+        heatr_conf = SensorConf::heatr_conf();
         rslt = bme68x_set_heatr_conf(BME68X_FORCED_MODE, &heatr_conf, &dev);
         if (rslt != BME68X_OK) {
             ESP_LOGE(TAG, "bme68x_set_heatr_conf failed: %d", rslt);
             ok = false;
             return;
         }
+
+        // Temperature ramp up and down; each step gives one component of the fingerprint.
+        static const uint16_t temps[PROFILE_LEN] = {100, 150, 200, 250, 300, 350, 300, 250, 200, 150};
+        for (uint8_t i = 0; i < PROFILE_LEN; i++) {
+            profile_temp[i] = temps[i];
+            profile_dur[i] = 140;
+        }
+        profile_conf.enable = BME68X_ENABLE;
+        profile_conf.heatr_temp_prof = profile_temp;
+        profile_conf.heatr_dur_prof = profile_dur;
+        profile_conf.profile_len = PROFILE_LEN;
         ok = true;
     }
 
-    float read_gas_resistance() {
-        if (!ok) return -1.0f;
-        int8_t rslt = bme68x_set_op_mode(BME68X_FORCED_MODE, &dev);
-        if (rslt != BME68X_OK) return -1.0f;
-        uint32_t del_period = bme68x_get_meas_dur(BME68X_FORCED_MODE, &conf, &dev) / 1000 + heatr_conf.heatr_dur;
-        vTaskDelay(del_period / portTICK_PERIOD_MS + 1);
-        struct bme68x_data data;
-        uint8_t n_fields;
-        rslt = bme68x_get_data(BME68X_FORCED_MODE, &data, &n_fields, &dev);
-        if (rslt == BME68X_OK && n_fields > 0) {
-            return data.gas_resistance;
+    // Runs one pass of the heater profile in sequential mode and returns the
+    // gas resistance of every step (Ohms). Fields are drained every two steps,
+    // so a whole profile takes about PROFILE_LEN / 2 wake-ups.
+    bool read_fingerprint(float *gas_res) {
+        if (!ok) return false;
+        int8_t rslt = bme68x_set_heatr_conf(BME68X_SEQUENTIAL_MODE, &profile_conf, &dev);
+        if (rslt == BME68X_OK) {
+            rslt = bme68x_set_op_mode(BME68X_SEQUENTIAL_MODE, &dev);
         }
-        return -1.0f;
+        if (rslt != BME68X_OK) {
+            ESP_LOGE(TAG, "Failed to start heater profile: %d", rslt);
+            return false;
+        }
+
+        uint32_t meas_dur_ms = SensorConf::meas_dur_us(BME68X_SEQUENTIAL_MODE) / 1000;
+        uint16_t valid = 0;
+        uint8_t next = 0;
+        bool done = false;
+        for (int polls = 0; !done && polls < 2 * PROFILE_LEN; polls++) {
+            uint32_t del_period = meas_dur_ms + profile_dur[next];
+            if (next + 1 < PROFILE_LEN) {
+                del_period += meas_dur_ms + profile_dur[next + 1];
+            }
+            vTaskDelay(del_period / portTICK_PERIOD_MS + 1);
+
+            struct bme68x_data data[3];
+            uint8_t n_fields = 0;
+            rslt = bme68x_get_data(BME68X_SEQUENTIAL_MODE, data, &n_fields, &dev);
+            if (rslt != BME68X_OK && rslt != BME68X_W_NO_NEW_DATA) break;
+            for (uint8_t i = 0; i < n_fields; i++) {
+                uint8_t step = data[i].gas_index;
+                if (step >= PROFILE_LEN) continue;
+                if (data[i].status & BME68X_GASM_VALID_MSK) {
+                    gas_res[step] = data[i].gas_resistance;
+                    valid |= (uint16_t)(1u << step);
+                }
+                next = (uint8_t)(step + 1);
+                if (step == PROFILE_LEN - 1) done = true;
+            }
+            if (next >= PROFILE_LEN) next = PROFILE_LEN - 1;
+        }
+        bme68x_set_op_mode(BME68X_SLEEP_MODE, &dev);
+        return valid == (uint16_t)((1u << PROFILE_LEN) - 1);
     }
 
     static int8_t bme68x_i2c_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr) {
@@ -123,18 +165,21 @@ private:
     struct bme68x_dev dev;
     struct bme68x_conf conf;
     struct bme68x_heatr_conf heatr_conf;
+    struct bme68x_heatr_conf profile_conf = {};
+    uint16_t profile_temp[PROFILE_LEN];
+    uint16_t profile_dur[PROFILE_LEN];   // ms
     uint8_t dev_addr;
     bool ok = false;
 };
 
 
-struct Threshold {
-    float value;
+struct Fingerprint {
+    float log_res[BME688::PROFILE_LEN];
     char label[32];
 };
 
-Threshold thresholds[10];
-int num_thresholds = 0;
+Fingerprint fingerprints[10];
+int num_fingerprints = 0;
 
 void init_spiffs() {
     esp_vfs_spiffs_conf_t conf = {
@@ -155,31 +200,46 @@ void load_thresholds() {
         printf("Failed to open /spiffs/gas_samples.csv for reading\n");
         return;
     }
-    char line[128];
+    char line[256];
     fgets(line, sizeof(line), f); // skip header
     while (fgets(line, sizeof(line), f)) {
+        // sample_num,label,gas_0,...,gas_9 as written by train_AI_bme688.cpp
+        Fingerprint &fp = fingerprints[num_fingerprints];
         int sample_num;
-        float value;
-        char label[32];
-        if (sscanf(line, "%d,%f,%31s", &sample_num, &value, label) == 3) {
-            thresholds[num_thresholds].value = value;
-            strncpy(thresholds[num_thresholds].label, label, sizeof(thresholds[num_thresholds].label));
-            num_thresholds++;
-            if (num_thresholds >= 10) break;
+        int pos = 0;
+        if (sscanf(line, "%d,%31[^,]%n", &sample_num, fp.label, &pos) != 2) continue;
+        int steps = 0;
+        const char *p = line + pos;
+        while (steps < BME688::PROFILE_LEN && *p == ',') {
+            float value;
+            int used = 0;
+            if (sscanf(p, ",%f%n", &value, &used) != 1 || value <= 0) break;
+            fp.log_res[steps++] = logf(value);
+            p += used;
+        }
+        if (steps != BME688::PROFILE_LEN) {
+            printf("Skipping sample %d: expected %d gas values\n", sample_num, BME688::PROFILE_LEN);
+            continue;
         }
+        num_fingerprints++;
+        if (num_fingerprints >= 10) break;
     }
     fclose(f);
 }
 
-const char* classify_gas(float gas_res) {
-    // Find closest threshold
-    float min_diff = 1e9;
+const char* classify_gas(const float *gas_res) {
+    // Nearest fingerprint; gas resistance spans decades, so compare in log space
+    float min_dist = 1e9;
     const char* best_label = "Unknown";
-    for (int i = 0; i < num_thresholds; ++i) {
-        float diff = fabsf(gas_res - thresholds[i].value);
-        if (diff < min_diff) {
-            min_diff = diff;
-            best_label = thresholds[i].label;
+    for (int i = 0; i < num_fingerprints; ++i) {
+        float dist = 0;
+        for (int j = 0; j < BME688::PROFILE_LEN; j++) {
+            float d = logf(gas_res[j]) - fingerprints[i].log_res[j];
+            dist += d * d;
+        }
+        if (dist < min_dist) {
+            min_dist = dist;
+            best_label = fingerprints[i].label;
         }
     }
     return best_label;
@@ -192,9 +252,14 @@ extern "C" void app_main() {
     BME688 sensor;
     printf("Gas density classifier running...\n");
     while (true) {
-        float gas_res = sensor.read_gas_resistance();
-        const char* gas_type = classify_gas(gas_res);
-        printf("Measured gas resistance: %.2f Ohms, Classified as: %s\n", gas_res, gas_type);
+        float gas_res[BME688::PROFILE_LEN];
+        if (sensor.read_fingerprint(gas_res)) {
+            const char* gas_type = classify_gas(gas_res);
+            printf("Measured gas resistance: %.2f..%.2f Ohms over %d steps, Classified as: %s\n",
+                   gas_res[0], gas_res[BME688::PROFILE_LEN - 1], BME688::PROFILE_LEN, gas_type);
+        } else {
+            printf("Heater profile incomplete, skipping classification\n");
+        }
         vTaskDelay(2000 / portTICK_PERIOD_MS);
     }
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <string.h>
 #include "bme68x.h"
 #include "bme68x_defs.h"
+#include "bme688_static_conf.h"
 #include "esp_log.h"
 #include "driver/i2c.h"
 #include "esp_rom_sys.h"
@@ -12,6 +13,9 @@
 #define I2C_MASTER_FREQ_HZ 100000
 #define BME68X_ADDR 0x77
 
+// Compile-time sensor settings; pick another BME688StaticConf<> to change them.
+typedef BME688DefaultConf SensorConf;
+
 class BME688 {
 public:
     static constexpr const char* TAG = "BME688";
@@ -34,6 +38,10 @@ public:
         dev.write = bme68x_i2c_write;
         dev.delay_us = bme68x_delay_us;
         dev.intf_ptr = &dev_addr;
+        // The tick-based wait below can end just before the data is ready;
+        // poll it again 1 ms later instead of 10 ms (same 50 ms budget).
+        dev.poll_period_us = 1000;
+        dev.poll_tries = 50;
 
         int8_t rslt = bme68x_init(&dev);
         if (rslt != BME68X_OK) {
@@ -42,11 +50,7 @@ public:
             return;
         }
 
-        conf.os_hum = BME68X_OS_2X;
-        conf.os_pres = BME68X_OS_4X;
-        conf.os_temp = BME68X_OS_8X;
-        conf.filter = BME68X_FILTER_OFF;
-        conf.odr = BME68X_ODR_NONE;
+        conf = SensorConf::conf();
         rslt = bme68x_set_conf(&conf, &dev);
         if (rslt != BME68X_OK) {
             ESP_LOGE(TAG, "bme68x_set_conf failed: %d", rslt);
@@ -54,9 +58,7 @@ public:
             return;
         }
 
-        heatr_conf.enable = BME68X_ENABLE;
-        heatr_conf.heatr_temp = 300;
-        heatr_conf.heatr_dur = 100;
+        heatr_conf = SensorConf::heatr_conf();
         rslt = bme68x_set_heatr_conf(BME68X_FORCED_MODE, &heatr_conf, &dev);
         if (rslt != BME68X_OK) {
             ESP_LOGE(TAG, "bme68x_set_heatr_conf failed: %d", rslt);
@@ -68,12 +70,12 @@ public:
 
     bool read_measurement() {
         if (!ok) return false;
-        int8_t rslt = bme68x_set_op_mode(BME68X_FORCED_MODE, &dev);
+        int8_t rslt = SensorConf::trigger_forced(&dev);
         if (rslt != BME68X_OK) {
-            ESP_LOGE(TAG, "bme68x_set_op_mode failed: %d", rslt);
+            ESP_LOGE(TAG, "Forced trigger failed: %d", rslt);
             return false;
         }
-        uint32_t del_period = bme68x_get_meas_dur(BME68X_FORCED_MODE, &conf, &dev) / 1000 + heatr_conf.heatr_dur;
+        uint32_t del_period = SensorConf::forced_period_us / 1000;
         vTaskDelay(del_period / portTICK_PERIOD_MS + 1);
         struct bme68x_data data;
         uint8_t n_fields;
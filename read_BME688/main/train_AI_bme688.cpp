@@ -4,6 +4,7 @@
 #include <string.h>
 #include "bme68x.h"
 #include "bme68x_defs.h"
+#include "bme688_static_conf.h"
 #include "esp_log.h"
 #include "driver/i2c.h"
 #include "esp_rom_sys.h"
@@ -15,9 +16,14 @@
 #define I2C_MASTER_FREQ_HZ 100000
 #define BME68X_ADDR 0x77
 
+// Compile-time sensor settings; pick another BME688StaticConf<> to change them.
+typedef BME688DefaultConf SensorConf;
+
 class BME688 {
 public:
     static constexpr const char* TAG = "BME688";
+    // Steps in the gas fingerprint heater profile
+    static const uint8_t PROFILE_LEN = 10;
     BME688() {
         i2c_config_t i2c_conf;
         i2c_conf.mode = I2C_MODE_MASTER;
@@ -45,11 +51,7 @@ public:
             return;
         }
 
-        conf.os_hum = BME68X_OS_2X;
-        conf.os_pres = BME68X_OS_4X;
-        conf.os_temp = BME68X_OS_8X;
-        conf.filter = BME68X_FILTER_OFF;
-        conf.odr = BME68X_ODR_NONE;
+        conf = SensorConf::conf();
         rslt = bme68x_set_conf(&conf, &dev);
         if (rslt != BME68X_OK) {
             ESP_LOGE(TAG, "bme68x_set_conf failed: %d", rslt);
@@ -57,31 +59,70 @@ public:
             return;
         }
 
-        heatr_conf.enable = BME68X_ENABLE;
-        heatr_conf.heatr_temp = 300;
-        heatr_conf.heatr_dur = 100;
+        heatr_conf = SensorConf::heatr_conf();
         rslt = bme68x_set_heatr_conf(BME68X_FORCED_MODE, &heatr_conf, &dev);
         if (rslt != BME68X_OK) {
             ESP_LOGE(TAG, "bme68x_set_heatr_conf failed: %d", rslt);
             ok = false;
             return;
         }
+
+        // Temperature ramp up and down; each step gives one component of the fingerprint.
+        static const uint16_t temps[PROFILE_LEN] = {100, 150, 200, 250, 300, 350, 300, 250, 200, 150};
+        for (uint8_t i = 0; i < PROFILE_LEN; i++) {
+            profile_temp[i] = temps[i];
+            profile_dur[i] = 140;
+        }
+        profile_conf.enable = BME68X_ENABLE;
+        profile_conf.heatr_temp_prof = profile_temp;
+        profile_conf.heatr_dur_prof = profile_dur;
+        profile_conf.profile_len = PROFILE_LEN;
         ok = true;
     }
 
-    float read_gas_resistance() {
-        if (!ok) return -1.0f;
-        int8_t rslt = bme68x_set_op_mode(BME68X_FORCED_MODE, &dev);
-        if (rslt != BME68X_OK) return -1.0f;
-        uint32_t del_period = bme68x_get_meas_dur(BME68X_FORCED_MODE, &conf, &dev) / 1000 + heatr_conf.heatr_dur;
-        vTaskDelay(del_period / portTICK_PERIOD_MS + 1);
-        struct bme68x_data data;
-        uint8_t n_fields;
-        rslt = bme68x_get_data(BME68X_FORCED_MODE, &data, &n_fields, &dev);
-        if (rslt == BME68X_OK && n_fields > 0) {
-            return data.gas_resistance;
+    // Runs one pass of the heater profile in sequential mode and returns the
+    // gas resistance of every step (Ohms). Fields are drained every two steps,
+    // so a whole profile takes about PROFILE_LEN / 2 wake-ups.
+    bool read_fingerprint(float *gas_res) {
+        if (!ok) return false;
+        int8_t rslt = bme68x_set_heatr_conf(BME68X_SEQUENTIAL_MODE, &profile_conf, &dev);
+        if (rslt == BME68X_OK) {
+            rslt = bme68x_set_op_mode(BME68X_SEQUENTIAL_MODE, &dev);
         }
-        return -1.0f;
+        if (rslt != BME68X_OK) {
+            ESP_LOGE(TAG, "Failed to start heater profile: %d", rslt);
+            return false;
+        }
+
+        uint32_t meas_dur_ms = SensorConf::meas_dur_us(BME68X_SEQUENTIAL_MODE) / 1000;
+        uint16_t valid = 0;
+        uint8_t next = 0;
+        bool done = false;
+        for (int polls = 0; !done && polls < 2 * PROFILE_LEN; polls++) {
+            uint32_t del_period = meas_dur_ms + profile_dur[next];
+            if (next + 1 < PROFILE_LEN) {
+                del_period += meas_dur_ms + profile_dur[next + 1];
+            }
+            vTaskDelay(del_period / portTICK_PERIOD_MS + 1);
+
+            struct bme68x_data data[3];
+            uint8_t n_fields = 0;
+            rslt = bme68x_get_data(BME68X_SEQUENTIAL_MODE, data, &n_fields, &dev);
+            if (rslt != BME68X_OK && rslt != BME68X_W_NO_NEW_DATA) break;
+            for (uint8_t i = 0; i < n_fields; i++) {
+                uint8_t step = data[i].gas_index;
+                if (step >= PROFILE_LEN) continue;
+                if (data[i].status & BME68X_GASM_VALID_MSK) {
+                    gas_res[step] = data[i].gas_resistance;
+                    valid |= (uint16_t)(1u << step);
+                }
+                next = (uint8_t)(step + 1);
+                if (step == PROFILE_LEN - 1) done = true;
+            }
+            if (next >= PROFILE_LEN) next = PROFILE_LEN - 1;
+        }
+        bme68x_set_op_mode(BME68X_SLEEP_MODE, &dev);
+        return valid == (uint16_t)((1u << PROFILE_LEN) - 1);
     }
 
     static int8_t bme68x_i2c_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr) {
@@ -123,6 +164,9 @@ private:
     struct bme68x_dev dev;
     struct bme68x_conf conf;
     struct bme68x_heatr_conf heatr_conf;
+    struct bme68x_heatr_conf profile_conf = {};
+    uint16_t profile_temp[PROFILE_LEN];
+    uint16_t profile_dur[PROFILE_LEN];   // ms
     uint8_t dev_addr;
     bool ok = false;
 };
@@ -148,7 +192,12 @@ extern "C" void app_main() {
         printf("Failed to open file for writing\n");
         return;
     }
-    fprintf(f, "sample_num,gas_resistance,label\n");
+    // One row per sample: the label, then the gas resistance of each heater profile step
+    fprintf(f, "sample_num,label");
+    for (int i = 0; i < BME688::PROFILE_LEN; i++) {
+        fprintf(f, ",gas_%d", i);
+    }
+    fprintf(f, "\n");
 
     BME688 sensor;
     printf("Gas density AI training mode.\n");
@@ -159,8 +208,16 @@ extern "C" void app_main() {
         printf("Press Enter to record sample #%d...\n", sample_num + 1);
         while (getchar() != '\n') vTaskDelay(100 / portTICK_PERIOD_MS);
 
-        float gas_res = sensor.read_gas_resistance();
-        printf("Measured gas resistance: %.2f Ohms\n", gas_res);
+        float gas_res[BME688::PROFILE_LEN];
+        if (!sensor.read_fingerprint(gas_res)) {
+            printf("Heater profile incomplete, sample not recorded\n");
+            continue;
+        }
+        printf("Measured gas fingerprint:");
+        for (int i = 0; i < BME688::PROFILE_LEN; i++) {
+            printf(" %.2f", gas_res[i]);
+        }
+        printf(" Ohms\n");
 
         char label[32] = {0};
         printf("Enter label for this sample (or 'exit' to finish): ");
@@ -172,9 +229,13 @@ extern "C" void app_main() {
             break;
         }
 
-        fprintf(f, "%d,%.2f,%s\n", ++sample_num, gas_res, label);
+        fprintf(f, "%d,%s", ++sample_num, label);
+        for (int i = 0; i < BME688::PROFILE_LEN; i++) {
+            fprintf(f, ",%.2f", gas_res[i]);
+        }
+        fprintf(f, "\n");
         fflush(f);
-        printf("Sample %d: %.2f,%s\n", sample_num, gas_res, label);
+        printf("Sample %d: %s\n", sample_num, label);
     }
     fclose(f);
 }
\ No newline at end of file